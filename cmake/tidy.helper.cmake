@@ -1,7 +1,6 @@
-include(ClangTidy)
-
 function(configure_tidy TARGET_NAME)
     if (VORTISIM_CLANG_TIDY)
+        include(ClangTidy)
         clang_tidy_check(${TARGET_NAME})
     endif()
 endfunction()
\ No newline at end of file
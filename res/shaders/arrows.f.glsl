@@ -1,15 +1,9 @@
 #version 150
 
-#define MAX_LINES 128
+uniform vec4 viewport;
 
-uniform mat4  inverse_mvp;
-uniform vec4  viewport;
-uniform vec4  lines[MAX_LINES];
-uniform float strengths[MAX_LINES];
-uniform vec2  vinf;
-uniform int   n_lines;
-
-in mat4 frag_mvp;
+// Velocity per pixel, see field.f.glsl
+uniform sampler2D field_cache;
 
 in vec4  gl_FragCoord;
 out vec4 frag_color;
@@ -32,9 +26,6 @@ const float ARROW_HEAD_ANGLE = 45.0 * PI / 180.0;
 const float ARROW_HEAD_LENGTH = ARROW_TILE_SIZE / 5.0;
 const float ARROW_SHAFT_THICKNESS = 3.0;
 
-const float TAU = 2.0 * PI;
-const int   INTEGRATOR_STEPS = 30;
-
 // Computes the center pixel of the tile containing pixel pos
 vec4
 arrowTileCenterCoord(vec4 pos)
@@ -113,50 +104,11 @@ arrow(vec2 p, vec2 v)
 
 /////////////////////////////////////////////////////////////////////
 
-vec2
-integrate(vec2 here, vec2 p1, vec2 p2)
-{
-    vec2 diff = p2 - p1;
-    vec2 delta = diff / INTEGRATOR_STEPS;
-
-    vec2 ans = vec2(0.0, 0.0);
-    for (int i = 0; i < INTEGRATOR_STEPS; ++i) {
-        vec2 current_pos = p1 + i * delta;
-
-        vec2  r = here - current_pos;
-        float denom = dot(r, r);
-
-        vec2 grad = vec2(current_pos.y - here.y, here.x - current_pos.x);
-        grad /= denom;
-
-        ans += grad;
-    }
-
-    return ans / INTEGRATOR_STEPS;
-}
-
-// The vector field; use your own function or texture
+// The vector field, interpolated from the cache rendered after each solve
 vec2
 field(vec4 pos)
 {
-    vec4 ndcPos;
-    ndcPos.xy = (2.0 * pos.xy - 2.0 * viewport.xy) / viewport.zw - 1;
-    ndcPos.z = (2.0 * pos.z - gl_DepthRange.near - gl_DepthRange.far) /
-               (gl_DepthRange.far - gl_DepthRange.near);
-    ndcPos.w = 1.0;
-
-    vec4 clipPos = ndcPos / pos.w;
-    vec4 worldPos = inverse_mvp * clipPos;
-
-    vec2 total_flow = vec2(0.0, 0.0);
-
-    for (int i = 0; i < n_lines; ++i) {
-        vec4 p1 = frag_mvp * vec4(lines[i].xy, 0.0, 1.0);
-        vec4 p2 = frag_mvp * vec4(lines[i].zw, 0.0, 1.0);
-        total_flow += strengths[i] * integrate(worldPos.xy, p1.xy, p2.xy);
-    }
-
-    return total_flow / TAU + vinf;
+    return texture(field_cache, (pos.xy - viewport.xy) / viewport.zw).xy;
 }
 
 void
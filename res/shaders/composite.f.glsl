@@ -0,0 +1,16 @@
+#version 150
+
+uniform vec4 viewport;
+
+// Arrows rendered by arrows.f.glsl, one texel per pixel
+uniform sampler2D field_image;
+
+in vec4  gl_FragCoord;
+out vec4 frag_color;
+
+void
+main()
+{
+    frag_color =
+        texelFetch(field_image, ivec2(gl_FragCoord.xy - viewport.xy), 0);
+}
@@ -1,9 +1,11 @@
 #version 150
 
+uniform vec4 color;
+
 out vec4 frag_color;
 
 void
 main()
 {
-    frag_color = vec4(1.0, 1.0, 1.0, 1.0);
+    frag_color = color;
 }
@@ -0,0 +1,178 @@
+#version 150
+
+uniform mat4 inverse_mvp;
+uniform vec4 viewport;
+
+// Panel endpoints (x1, y1, x2, y2) and the strengths at both ends, one
+// texel per panel
+uniform samplerBuffer lines;
+uniform samplerBuffer strengths;
+
+// Two texels per run of CLUSTER_SIZE consecutive panels: center, radius and
+// total circulation, then the dipole moment about the center
+uniform samplerBuffer clusters;
+
+uniform vec2 vinf;
+uniform int  n_lines;
+uniform int  quadrature;
+uniform int  formulation;
+
+in vec4  gl_FragCoord;
+out vec4 frag_velocity;
+
+const float PI = 3.14159265358979;
+const float TAU = 2.0 * PI;
+const int   INTEGRATOR_STEPS = 30;
+
+// Matches vortisim::Quadrature
+const int QUADRATURE_ANALYTIC = 0;
+const int QUADRATURE_RIEMANN = 1;
+
+// Matches vortisim::Formulation
+const int FORMULATION_CONSTANT = 0;
+const int FORMULATION_LINEAR = 1;
+
+// Matches FIELD_CLUSTER_SIZE of fieldclusters.h
+const int CLUSTER_SIZE = 16;
+
+// Clusters farther than this many radii away are summed as a point vortex
+// and a dipole; the error falls with the square of radius over distance
+const float FAR_RATIO = 4.0;
+
+// Strength interpolated from strength.x at p1 to strength.y at p2
+vec2
+integrate(vec2 here, vec2 p1, vec2 p2, vec2 strength)
+{
+    vec2 diff = p2 - p1;
+    vec2 delta = diff / INTEGRATOR_STEPS;
+
+    vec2 ans = vec2(0.0, 0.0);
+    for (int i = 0; i < INTEGRATOR_STEPS; ++i) {
+        vec2 current_pos = p1 + i * delta;
+
+        vec2  r = here - current_pos;
+        float denom = dot(r, r);
+
+        vec2 grad = vec2(current_pos.y - here.y, here.x - current_pos.x);
+        grad /= denom;
+
+        ans += mix(strength.x, strength.y, float(i) / INTEGRATOR_STEPS) * grad;
+    }
+
+    return ans * length(delta);
+}
+
+// Exact velocity of a unit strength vortex panel, up to the factor 1 / TAU,
+// from log/atan terms in panel-local coordinates
+vec2
+panelVelocity(vec2 here, vec2 p1, vec2 p2)
+{
+    vec2  diff = p2 - p1;
+    float len = length(diff);
+    vec2  t = diff / len;
+    vec2  n = vec2(-t.y, t.x);
+
+    vec2  d = here - p1;
+    float x = dot(d, t);
+    float y = dot(d, n);
+
+    float r1_sq = x * x + y * y;
+    float r2_sq = (x - len) * (x - len) + y * y;
+
+    // Angle subtended by the panel
+    float dtheta = atan(y * len, x * (x - len) + y * y);
+
+    return -dtheta * t + 0.5 * log(r1_sq / r2_sq) * n;
+}
+
+// Same for a strength running linearly from strength.x at p1 to strength.y
+// at p2, split as in vortisim::linear_panel_velocity
+vec2
+linearPanelVelocity(vec2 here, vec2 p1, vec2 p2, vec2 strength)
+{
+    vec2  diff = p2 - p1;
+    float len = length(diff);
+    vec2  t = diff / len;
+    vec2  n = vec2(-t.y, t.x);
+
+    vec2  d = here - p1;
+    float x = dot(d, t);
+    float y = dot(d, n);
+
+    float r1_sq = x * x + y * y;
+    float r2_sq = (x - len) * (x - len) + y * y;
+
+    float dtheta = atan(y * len, x * (x - len) + y * y);
+    float log_ratio = 0.5 * log(r1_sq / r2_sq);
+
+    vec2 at_end = vec2(-(x * dtheta - y * log_ratio),
+                       x * log_ratio - len + y * dtheta) /
+                  len;
+    vec2 at_start = vec2(-dtheta, log_ratio) - at_end;
+    vec2 uv = strength.x * at_start + strength.y * at_end;
+
+    return uv.x * t + uv.y * n;
+}
+
+// Total velocity at a window position of the cache target
+vec2
+field(vec4 pos)
+{
+    vec4 ndcPos;
+    ndcPos.xy = (2.0 * pos.xy - 2.0 * viewport.xy) / viewport.zw - 1;
+    ndcPos.z = (2.0 * pos.z - gl_DepthRange.near - gl_DepthRange.far) /
+               (gl_DepthRange.far - gl_DepthRange.near);
+    ndcPos.w = 1.0;
+
+    vec4 clipPos = ndcPos / pos.w;
+    vec4 worldPos = inverse_mvp * clipPos;
+
+    vec2 total_flow = vec2(0.0, 0.0);
+
+    for (int begin = 0; begin < n_lines; begin += CLUSTER_SIZE) {
+        int  k = begin / CLUSTER_SIZE;
+        vec4 cluster = texelFetch(clusters, 2 * k);
+        vec2 z = worldPos.xy - cluster.xy;
+
+        if (dot(z, z) > FAR_RATIO * FAR_RATIO * cluster.z * cluster.z) {
+            // u - i v = -i (G / z + D / z^2) in complex numbers
+            vec2 dipole = texelFetch(clusters, 2 * k + 1).xy;
+            vec2 inv_z = vec2(z.x, -z.y) / dot(z, z);
+            vec2 inv_z2 = vec2(inv_z.x * inv_z.x - inv_z.y * inv_z.y,
+                               2.0 * inv_z.x * inv_z.y);
+            vec2 w = cluster.w * inv_z +
+                     vec2(dipole.x * inv_z2.x - dipole.y * inv_z2.y,
+                          dipole.x * inv_z2.y + dipole.y * inv_z2.x);
+
+            total_flow += vec2(w.y, w.x);
+            continue;
+        }
+
+        int end = min(n_lines, begin + CLUSTER_SIZE);
+        for (int i = begin; i < end; ++i) {
+            vec4 line = texelFetch(lines, i);
+            vec2 strength = texelFetch(strengths, i).xy;
+
+            if (quadrature == QUADRATURE_RIEMANN) {
+                total_flow +=
+                    integrate(worldPos.xy, line.xy, line.zw, strength);
+            } else if (formulation == FORMULATION_LINEAR) {
+                total_flow += linearPanelVelocity(
+                    worldPos.xy, line.xy, line.zw, strength);
+            } else {
+                total_flow += strength.x *
+                              panelVelocity(worldPos.xy, line.xy, line.zw);
+            }
+        }
+    }
+
+    return total_flow / TAU + vinf;
+}
+
+// Evaluates the flow once per texel of the field cache, the arrow pass only
+// samples the result
+void
+main()
+{
+    frag_velocity = vec4(field(gl_FragCoord), 0.0, 1.0);
+}
@@ -0,0 +1,877 @@
+#include "core/airfoil.h"
+#include "core/assembly.h"
+#include "core/fieldexport.h"
+#include "core/geometryio.h"
+#include "core/loads.h"
+#include "core/profiler.h"
+#include "core/repanel.h"
+#include "core/results.h"
+#include "core/solver.h"
+#include "core/tracer.h"
+#include "core/unsteady.h"
+#include "core/validate.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace {
+
+namespace fs = std::filesystem;
+
+// Particles released on a vertical line and traced through the solution
+struct Trace {
+    std::vector<vortisim::Vec2> seeds{};
+    double                      dt{};
+    std::size_t                 n_samples{};
+};
+
+// Impulsive start run after the steady solve
+struct Unsteady {
+    double      dt{};
+    std::size_t steps{};
+};
+
+// Angles of attack in degrees, evenly spaced
+struct Sweep {
+    double      first{};
+    double      last{};
+    std::size_t count{};
+};
+
+struct Options {
+    std::vector<fs::path>   inputs{};
+    fs::path                output_dir{};
+    vortisim::Vec2          vinf{1.0, 0.0};
+    vortisim::SolverOptions solver{};
+
+    // Threads of the pool, all cores unless given
+    unsigned jobs{std::max(1U, std::thread::hardware_concurrency())};
+
+    // Panel count of the assembly scaling report, zero when not requested
+    std::size_t scaling_panels{};
+
+    // Strengths as text next to the binary results
+    bool text{false};
+
+    // Chrome trace of the timed regions, empty when not requested
+    fs::path profile{};
+
+    // Velocity export grid, empty when not requested
+    vortisim::Grid grid{};
+
+    // Particle paths, no seeds when not requested
+    Trace trace{};
+
+    // Time stepping, no steps when not requested
+    Unsteady unsteady{};
+
+    // Polar, no angles when not requested
+    Sweep sweep{};
+
+    // Panels per body of the cosine redistribution before solving, zero
+    // when not requested
+    std::size_t repanel{};
+
+    // Tolerance of the lift coefficient for adaptive repaneling, zero when
+    // not requested
+    double adapt{};
+
+    // Generated NACA sections by designation, solved after the inputs
+    std::vector<std::string> naca{};
+    std::size_t              naca_panels{160};
+
+    // Shared by assembly and field export when only one file is processed
+    vortisim::ThreadPool * pool{};
+};
+
+constexpr double G_PI = 3.14159265358979;
+
+void
+print_usage(char const * argv0)
+{
+    std::cerr
+        << "Usage: " << argv0 << " [options] <geometry>...\n"
+        << "Solves every geometry file and writes <name>.results. Airfoil\n"
+        << "coordinates in Selig or Lednicer .dat files are read as one body,\n"
+        << "a directory stands for all of its .dat files\n\n"
+        << "  -j, --jobs <n>     Number of worker threads (default: all cores)\n"
+        << "  -a, --alpha <deg>  Angle of attack of a unit freestream\n"
+        << "  -q, --quadrature <analytic|riemann>\n"
+        << "                     Panel influence evaluation (default: analytic)\n"
+        << "  -f, --formulation <constant|linear>\n"
+        << "                     Panel strength (default: constant); linear\n"
+        << "                     varies it between the nodes and is always\n"
+        << "                     solved dense or mixed\n"
+        << "  -s, --solver <auto|dense|iterative|mixed>\n"
+        << "                     Linear solver (default: auto, iterative from\n"
+        << "                     2000 panels on); mixed factorizes in float\n"
+        << "                     and refines to double accuracy\n"
+        << "  --low-memory       Let the mixed solver assemble every residual\n"
+        << "                     instead of keeping the double matrix\n"
+        << "  -t, --tolerance <r>\n"
+        << "                     Relative residual of the iterative and mixed\n"
+        << "                     solvers\n"
+        << "  -o, --output <dir> Output directory (default: next to input)\n"
+        << "  --text             Also write the strengths as text, one per\n"
+        << "                     line, to <name>.strengths\n"
+        << "  -g, --grid <x0,y0,x1,y1,nx,ny>\n"
+        << "                     Also write the velocity on an nx by ny grid\n"
+        << "                     spanning the box to <name>.field\n"
+        << "  --trace <x,y0,y1,n,dt,samples>\n"
+        << "                     Also trace n particles released between\n"
+        << "                     (x, y0) and (x, y1) and write their positions\n"
+        << "                     every dt to <name>.paths\n"
+        << "  --unsteady <dt,steps>\n"
+        << "                     Also start the freestream impulsively and\n"
+        << "                     write the bound circulation of every body\n"
+        << "                     after each step to <name>.history\n"
+        << "  --sweep <a0,a1,n>  Also solve n angles of attack from a0 to a1\n"
+        << "                     degrees on one factorization and write the\n"
+        << "                     lift and moment polar to <name>.polar\n"
+        << "  --repanel <n>      Redistribute the nodes of every body to n\n"
+        << "                     panels with cosine spacing before solving\n"
+        << "  --adapt <tol>      Repanel adaptively until the lift\n"
+        << "                     coefficient settles within tol, from\n"
+        << "                     --repanel panels (default: 40), and write\n"
+        << "                     the panel count, lift and estimated error\n"
+        << "                     of every step to <name>.adapt\n"
+        << "  --naca <digits>    Also solve a generated NACA 4 or 5 digit\n"
+        << "                     section, written as naca<digits>.results\n"
+        << "  --naca-panels <n>  Panels of generated sections (default: 160)\n"
+        << "  --profile <file>   Write the timed assembly, solve and field\n"
+        << "                     regions as a Chrome trace\n"
+        << "  --scaling <n>      Time the assembly of an n panel ellipse on\n"
+        << "                     1 up to --jobs threads instead of solving\n"
+        << "  -h, --help         Show this help\n";
+}
+
+// Exactly n comma separated numbers
+std::optional<std::vector<double>>
+parse_list(std::string const & value, std::size_t n)
+{
+    std::istringstream  in{value};
+    std::vector<double> values(n);
+
+    for (std::size_t i = 0; i < n; ++i) {
+        char separator = ',';
+        if ((i > 0 && !(in >> separator)) || separator != ',' ||
+            !(in >> values[i])) {
+            return std::nullopt;
+        }
+    }
+
+    if (!(in >> std::ws).eof()) {
+        return std::nullopt;
+    }
+
+    return values;
+}
+
+// "x0,y0,x1,y1,nx,ny"
+std::optional<vortisim::Grid>
+parse_grid(std::string const & value)
+{
+    std::optional<std::vector<double>> const v = parse_list(value, 6);
+    if (!v || (*v)[4] < 1.0 || (*v)[5] < 1.0) {
+        return std::nullopt;
+    }
+
+    return vortisim::uniform_grid({(*v)[0], (*v)[1]},
+                                  {(*v)[2], (*v)[3]},
+                                  static_cast<std::size_t>((*v)[4]),
+                                  static_cast<std::size_t>((*v)[5]));
+}
+
+// "x,y0,y1,n,dt,samples"
+std::optional<Trace>
+parse_trace(std::string const & value)
+{
+    std::optional<std::vector<double>> const v = parse_list(value, 6);
+    if (!v || (*v)[3] < 1.0 || !((*v)[4] > 0.0) || (*v)[5] < 1.0) {
+        return std::nullopt;
+    }
+
+    Trace trace{};
+    auto const n_seeds = static_cast<std::size_t>((*v)[3]);
+    for (std::size_t k = 0; k < n_seeds; ++k) {
+        double const f = (n_seeds > 1) ? static_cast<double>(k) /
+                                             static_cast<double>(n_seeds - 1)
+                                       : 0.5;
+        trace.seeds.push_back({(*v)[0], (*v)[1] + f * ((*v)[2] - (*v)[1])});
+    }
+    trace.dt = (*v)[4];
+    trace.n_samples = static_cast<std::size_t>((*v)[5]);
+
+    return trace;
+}
+
+bool
+parse_options(int argc, char ** argv, Options & options)
+{
+    std::vector<std::string_view> const args(argv + 1, argv + argc);
+
+    for (auto it = args.begin(); it != args.end(); ++it) {
+        std::string_view const arg = *it;
+
+        auto next = [&it, &args]() -> std::string {
+            if (std::next(it) == args.end()) {
+                return {};
+            }
+            return std::string{*++it};
+        };
+
+        if (arg == "-h" || arg == "--help") {
+            return false;
+        }
+
+        if (arg == "-j" || arg == "--jobs") {
+            int const jobs = std::atoi(next().c_str());
+            if (jobs < 1) {
+                std::cerr << "Invalid job count\n";
+                return false;
+            }
+            options.jobs = static_cast<unsigned>(jobs);
+        } else if (arg == "-a" || arg == "--alpha") {
+            std::string const value = next();
+            if (value.empty()) {
+                std::cerr << "Missing angle of attack\n";
+                return false;
+            }
+            double const alpha = std::atof(value.c_str()) * G_PI / 180.0;
+            options.vinf = {std::cos(alpha), std::sin(alpha)};
+        } else if (arg == "-q" || arg == "--quadrature") {
+            std::string const value = next();
+            if (value == "analytic") {
+                options.solver.quadrature = vortisim::Quadrature::ANALYTIC;
+            } else if (value == "riemann") {
+                options.solver.quadrature = vortisim::Quadrature::RIEMANN;
+            } else {
+                std::cerr << "Unknown quadrature " << value << '\n';
+                return false;
+            }
+        } else if (arg == "-f" || arg == "--formulation") {
+            std::string const value = next();
+            if (value == "constant") {
+                options.solver.formulation = vortisim::Formulation::CONSTANT;
+            } else if (value == "linear") {
+                options.solver.formulation = vortisim::Formulation::LINEAR;
+            } else {
+                std::cerr << "Unknown formulation " << value << '\n';
+                return false;
+            }
+        } else if (arg == "-s" || arg == "--solver") {
+            std::string const value = next();
+            if (value == "auto") {
+                options.solver.mode = vortisim::SolverMode::AUTO;
+            } else if (value == "dense") {
+                options.solver.mode = vortisim::SolverMode::DENSE;
+            } else if (value == "iterative") {
+                options.solver.mode = vortisim::SolverMode::ITERATIVE;
+            } else if (value == "mixed") {
+                options.solver.mode = vortisim::SolverMode::MIXED;
+            } else {
+                std::cerr << "Unknown solver " << value << '\n';
+                return false;
+            }
+        } else if (arg == "--low-memory") {
+            options.solver.low_memory = true;
+        } else if (arg == "-t" || arg == "--tolerance") {
+            double const tolerance = std::atof(next().c_str());
+            if (!(tolerance > 0.0)) {
+                std::cerr << "Invalid tolerance\n";
+                return false;
+            }
+            options.solver.iterative.gmres.tolerance = tolerance;
+            options.solver.refinement.tolerance = tolerance;
+        } else if (arg == "-o" || arg == "--output") {
+            options.output_dir = next();
+            if (options.output_dir.empty()) {
+                std::cerr << "Missing output directory\n";
+                return false;
+            }
+        } else if (arg == "--text") {
+            options.text = true;
+        } else if (arg == "--profile") {
+            options.profile = next();
+            if (options.profile.empty()) {
+                std::cerr << "Missing trace file\n";
+                return false;
+            }
+        } else if (arg == "-g" || arg == "--grid") {
+            std::optional<vortisim::Grid> grid = parse_grid(next());
+            if (!grid) {
+                std::cerr << "Invalid grid\n";
+                return false;
+            }
+            options.grid = std::move(*grid);
+        } else if (arg == "--trace") {
+            std::optional<Trace> trace = parse_trace(next());
+            if (!trace) {
+                std::cerr << "Invalid trace\n";
+                return false;
+            }
+            options.trace = std::move(*trace);
+        } else if (arg == "--unsteady") {
+            std::optional<std::vector<double>> const v =
+                parse_list(next(), 2);
+            if (!v || !((*v)[0] > 0.0) || (*v)[1] < 1.0) {
+                std::cerr << "Invalid time stepping\n";
+                return false;
+            }
+            options.unsteady.dt = (*v)[0];
+            options.unsteady.steps = static_cast<std::size_t>((*v)[1]);
+        } else if (arg == "--sweep") {
+            std::optional<std::vector<double>> const v =
+                parse_list(next(), 3);
+            if (!v || (*v)[2] < 1.0) {
+                std::cerr << "Invalid sweep\n";
+                return false;
+            }
+            options.sweep.first = (*v)[0];
+            options.sweep.last = (*v)[1];
+            options.sweep.count = static_cast<std::size_t>((*v)[2]);
+        } else if (arg == "--repanel") {
+            int const n_panels = std::atoi(next().c_str());
+            if (n_panels < 4) {
+                std::cerr << "Invalid panel count\n";
+                return false;
+            }
+            options.repanel = static_cast<std::size_t>(n_panels);
+        } else if (arg == "--adapt") {
+            double const tolerance = std::atof(next().c_str());
+            if (!(tolerance > 0.0)) {
+                std::cerr << "Invalid lift tolerance\n";
+                return false;
+            }
+            options.adapt = tolerance;
+        } else if (arg == "--naca") {
+            std::string value = next();
+            if (!vortisim::naca(value, options.naca_panels)) {
+                std::cerr << "Invalid NACA designation " << value << '\n';
+                return false;
+            }
+            options.naca.push_back(std::move(value));
+        } else if (arg == "--naca-panels") {
+            int const n_panels = std::atoi(next().c_str());
+            if (n_panels < 4) {
+                std::cerr << "Invalid panel count\n";
+                return false;
+            }
+            options.naca_panels = static_cast<std::size_t>(n_panels);
+        } else if (arg == "--scaling") {
+            int const n_panels = std::atoi(next().c_str());
+            if (n_panels < 3) {
+                std::cerr << "Invalid panel count\n";
+                return false;
+            }
+            options.scaling_panels = static_cast<std::size_t>(n_panels);
+        } else if (!arg.empty() && arg.front() == '-') {
+            std::cerr << "Unknown option " << arg << '\n';
+            return false;
+        } else {
+            options.inputs.emplace_back(arg);
+        }
+    }
+
+    return !options.inputs.empty() || !options.naca.empty() ||
+           options.scaling_panels > 0;
+}
+
+// "x y" per position, paths separated by blank lines
+bool
+write_paths(std::ostream & out, vortisim::ParticlePaths const & paths)
+{
+    out << std::setprecision(std::numeric_limits<double>::max_digits10);
+    for (std::size_t i = 0; i < paths.x.size(); ++i) {
+        if (i > 0 && i % paths.samples == 0) {
+            out << '\n';
+        }
+        out << paths.x[i] << ' ' << paths.y[i] << '\n';
+    }
+
+    return static_cast<bool>(out);
+}
+
+// "alpha cl cm" per angle, alpha in degrees
+bool
+write_polar(std::ostream & out, vortisim::Polar const & polar)
+{
+    out << std::setprecision(std::numeric_limits<double>::max_digits10);
+    for (std::size_t k = 0; k < polar.alpha.size(); ++k) {
+        out << polar.alpha[k] * 180.0 / G_PI << ' ' << polar.cl[k] << ' '
+            << polar.cm[k] << '\n';
+    }
+
+    return static_cast<bool>(out);
+}
+
+// "panels cl error" per adaptive step, the error of the first one is -1
+bool
+write_adapt(std::ostream & out, std::vector<vortisim::AdaptStep> const & steps)
+{
+    out << std::setprecision(std::numeric_limits<double>::max_digits10);
+    for (vortisim::AdaptStep const & step : steps) {
+        out << step.panels << ' ' << step.cl << ' ' << step.error << '\n';
+    }
+
+    return static_cast<bool>(out);
+}
+
+// "t circulation..." per step, one column per body
+bool
+write_history(std::ostream &             out,
+              vortisim::UnsteadySolver & solver,
+              std::size_t                steps)
+{
+    std::size_t const n_bodies = solver.scene().bodies.size();
+
+    out << std::setprecision(std::numeric_limits<double>::max_digits10);
+    for (std::size_t s = 0; s < steps; ++s) {
+        solver.step();
+
+        out << solver.time();
+        for (std::size_t k = 0; k < n_bodies; ++k) {
+            out << ' ' << solver.circulation(k);
+        }
+        out << '\n';
+    }
+
+    return static_cast<bool>(out);
+}
+
+bool
+is_airfoil_file(fs::path const & path)
+{
+    std::string extension = path.extension().string();
+    std::transform(
+        extension.begin(), extension.end(), extension.begin(), [](char c) {
+            return static_cast<char>(
+                std::tolower(static_cast<unsigned char>(c)));
+        });
+
+    return extension == ".dat";
+}
+
+// Airfoil coordinates or a scene in the geometry format
+std::optional<vortisim::Scene>
+load_scene(fs::path const & input)
+{
+    if (is_airfoil_file(input)) {
+        std::optional<vortisim::Airfoil> airfoil =
+            vortisim::load_airfoil(input);
+        if (!airfoil) {
+            std::cerr << input.string() << ": malformed airfoil\n";
+            return std::nullopt;
+        }
+
+        vortisim::Scene scene{};
+        scene.bodies.push_back(std::move(airfoil->body));
+        return scene;
+    }
+
+    std::ifstream in{input};
+    if (!in) {
+        std::cerr << input.string() << ": cannot open\n";
+        return std::nullopt;
+    }
+
+    std::optional<vortisim::Scene> scene = vortisim::read_scene(in);
+    if (!scene) {
+        std::cerr << input.string() << ": malformed geometry\n";
+    }
+
+    return scene;
+}
+
+// Solves the scene, repaneled when requested, and writes the requested
+// results next to output, which has no extension yet; label names the
+// geometry in diagnostics
+bool
+solve_scene(vortisim::Scene     scene,
+            std::string const & label,
+            fs::path            output,
+            Options const &     options)
+{
+    // Rejected before any assembly, the solve would only return garbage
+    if (std::optional<vortisim::GeometryError> const error =
+            vortisim::validate_scene(scene)) {
+        std::cerr << label << ": body " << error->body;
+        switch (error->issue) {
+            case vortisim::GeometryIssue::TOO_FEW_NODES:
+                std::cerr << " has fewer than three nodes\n";
+                break;
+            case vortisim::GeometryIssue::DEGENERATE_PANEL:
+                std::cerr << " panel " << error->panel
+                          << " has zero length\n";
+                break;
+            case vortisim::GeometryIssue::CROSSING:
+                std::cerr << " panel " << error->panel << " crosses body "
+                          << error->other_body << " panel "
+                          << error->other_panel << '\n';
+                break;
+        }
+        return false;
+    }
+
+    vortisim::SolverOptions solver = options.solver;
+    solver.pool = options.pool;
+
+    vortisim::Solution solution{};
+    if (options.adapt > 0.0) {
+        vortisim::AdaptOptions adapt{};
+        if (options.repanel > 0) {
+            adapt.initial.panels = options.repanel;
+        }
+        adapt.tolerance = options.adapt;
+        adapt.solver = solver;
+
+        vortisim::AdaptResult result =
+            vortisim::adapt_scene(scene, options.vinf, adapt);
+        if (!result.converged) {
+            std::cerr << label << ": adaptation stopped at "
+                      << result.steps.back().panels
+                      << " panels with an estimated lift error of "
+                      << result.steps.back().error << '\n';
+        }
+
+        fs::path report = output;
+        report += ".adapt";
+        std::ofstream report_out{report};
+        if (!write_adapt(report_out, result.steps)) {
+            std::cerr << report.string() << ": cannot write\n";
+            return false;
+        }
+
+        scene = std::move(result.scene);
+        solution = std::move(result.solution);
+    } else {
+        if (options.repanel > 0) {
+            scene = vortisim::repanel_cosine(scene, {options.repanel});
+        }
+        solution = vortisim::solve(scene, options.vinf, solver);
+    }
+
+    if (solution.mode == vortisim::SolverMode::ITERATIVE &&
+        solution.residual > options.solver.iterative.gmres.tolerance) {
+        std::cerr << label << ": GMRES stopped at relative residual "
+                  << solution.residual << " after " << solution.iterations
+                  << " iterations\n";
+    }
+    if (solution.mode == vortisim::SolverMode::MIXED &&
+        solution.residual > options.solver.refinement.tolerance) {
+        std::cerr << label << ": refinement stopped at relative residual "
+                  << solution.residual << " after " << solution.iterations
+                  << " steps\n";
+    }
+
+    output += ".results";
+    if (!vortisim::write_results(output,
+                                 scene,
+                                 solution,
+                                 options.vinf,
+                                 options.solver.quadrature,
+                                 options.pool)) {
+        std::cerr << output.string() << ": cannot write\n";
+        return false;
+    }
+
+    if (options.text) {
+        output.replace_extension(".strengths");
+        std::ofstream out{output};
+        if (!vortisim::write_strengths(out, solution)) {
+            std::cerr << output.string() << ": cannot write\n";
+            return false;
+        }
+    }
+
+    if (options.grid.size() > 0) {
+        vortisim::FieldExportOptions field{};
+        field.flow.quadrature = options.solver.quadrature;
+
+        output.replace_extension(".field");
+        if (!vortisim::export_field(scene,
+                                    solution,
+                                    options.vinf,
+                                    options.grid,
+                                    output,
+                                    field,
+                                    options.pool)) {
+            std::cerr << output.string() << ": cannot write\n";
+            return false;
+        }
+    }
+
+    if (!options.trace.seeds.empty()) {
+        vortisim::FlowFieldOptions flow{};
+        flow.quadrature = options.solver.quadrature;
+
+        vortisim::FlowField const field{
+            scene, solution, options.vinf, flow};
+        vortisim::ParticlePaths const paths =
+            vortisim::trace_paths(field,
+                                  options.trace.seeds,
+                                  options.trace.dt,
+                                  options.trace.n_samples,
+                                  {},
+                                  options.pool);
+
+        output.replace_extension(".paths");
+        std::ofstream paths_out{output};
+        if (!write_paths(paths_out, paths)) {
+            std::cerr << output.string() << ": cannot write\n";
+            return false;
+        }
+    }
+
+    if (options.sweep.count > 0) {
+        std::size_t const   n = options.sweep.count;
+        std::vector<double> alpha(n, options.sweep.first * G_PI / 180.0);
+        for (std::size_t k = 1; k < n; ++k) {
+            double const f =
+                static_cast<double>(k) / static_cast<double>(n - 1);
+            alpha[k] = (options.sweep.first +
+                        f * (options.sweep.last - options.sweep.first)) *
+                       G_PI / 180.0;
+        }
+
+        vortisim::Polar const polar =
+            vortisim::compute_polar(scene, alpha, solver);
+
+        output.replace_extension(".polar");
+        std::ofstream polar_out{output};
+        if (!write_polar(polar_out, polar)) {
+            std::cerr << output.string() << ": cannot write\n";
+            return false;
+        }
+    }
+
+    if (options.unsteady.steps > 0) {
+        vortisim::Motion motion{};
+        motion.freestream = [vinf = options.vinf](double /*t*/) {
+            return vinf;
+        };
+
+        vortisim::UnsteadyOptions unsteady{};
+        unsteady.dt = options.unsteady.dt;
+        unsteady.quadrature = options.solver.quadrature;
+
+        vortisim::UnsteadySolver stepper{
+            scene, motion, unsteady, options.pool};
+
+        output.replace_extension(".history");
+        std::ofstream history_out{output};
+        if (!write_history(history_out, stepper, options.unsteady.steps)) {
+            std::cerr << output.string() << ": cannot write\n";
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool
+process(fs::path const & input, Options const & options)
+{
+    std::optional<vortisim::Scene> const scene = load_scene(input);
+    if (!scene) {
+        return false;
+    }
+
+    fs::path const directory = options.output_dir.empty()
+                                   ? input.parent_path()
+                                   : options.output_dir;
+
+    return solve_scene(
+        *scene, input.string(), directory / input.stem(), options);
+}
+
+bool
+process_naca(std::string const & designation, Options const & options)
+{
+    std::optional<vortisim::Body> body =
+        vortisim::naca(designation, options.naca_panels);
+    if (!body) {
+        return false;
+    }
+
+    vortisim::Scene scene{};
+    scene.bodies.push_back(std::move(*body));
+
+    std::string const name = "naca" + designation;
+
+    return solve_scene(scene, name, options.output_dir / name, options);
+}
+
+// Best of a few runs of the threaded influence assembly on an ellipse, for
+// doubling thread counts up to the requested job count
+int
+report_scaling(Options const & options)
+{
+    constexpr double    thickness = 0.12;
+    vortisim::Body      body{};
+    std::size_t const   n_panels = options.scaling_panels;
+    for (std::size_t i = 0; i < n_panels; ++i) {
+        double const t =
+            2.0 * G_PI * static_cast<double>(i) / static_cast<double>(n_panels);
+        body.nodes.push_back({0.5 * std::cos(t), thickness * std::sin(t)});
+    }
+
+    vortisim::PanelArrays const panels = vortisim::make_panel_arrays(body);
+
+    std::vector<unsigned> thread_counts;
+    for (unsigned t = 1; t < options.jobs; t *= 2) {
+        thread_counts.push_back(t);
+    }
+    thread_counts.push_back(options.jobs);
+
+    std::cout << "Assembly of " << n_panels << " panels\n"
+              << "threads    time [ms]  speedup  efficiency\n";
+
+    double serial_ms = 0.0;
+    for (unsigned const n_threads : thread_counts) {
+        vortisim::ThreadPool pool{n_threads};
+
+        constexpr int repeats = 3;
+        double        best_ms = std::numeric_limits<double>::max();
+        for (int r = 0; r < repeats; ++r) {
+            auto const start = std::chrono::steady_clock::now();
+            Eigen::MatrixXd const a =
+                vortisim::assemble_influence(panels,
+                                             options.solver.quadrature,
+                                             &pool,
+                                             options.solver.formulation);
+            auto const stop = std::chrono::steady_clock::now();
+
+            best_ms = std::min(
+                best_ms,
+                std::chrono::duration<double, std::milli>(stop - start)
+                    .count());
+        }
+
+        if (n_threads == 1) {
+            serial_ms = best_ms;
+        }
+
+        double const speedup = serial_ms / best_ms;
+        std::cout << std::setw(7) << n_threads << std::fixed
+                  << std::setprecision(2) << std::setw(13) << best_ms
+                  << std::setw(9) << speedup << std::setw(12)
+                  << speedup / n_threads << '\n';
+    }
+
+    return EXIT_SUCCESS;
+}
+
+} // namespace
+
+int
+main(int argc, char ** argv)
+{
+    Options options{};
+    if (!parse_options(argc, argv, options)) {
+        print_usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    if (options.scaling_panels > 0) {
+        return report_scaling(options);
+    }
+
+    if (!options.output_dir.empty()) {
+        std::error_code ec;
+        fs::create_directories(options.output_dir, ec);
+        if (ec) {
+            std::cerr << options.output_dir.string() << ": " << ec.message()
+                      << '\n';
+            return EXIT_FAILURE;
+        }
+    }
+
+    // Directories stand for their airfoil files in name order
+    std::vector<fs::path> inputs;
+    for (fs::path const & input : options.inputs) {
+        std::error_code ec;
+        if (!fs::is_directory(input, ec)) {
+            inputs.push_back(input);
+            continue;
+        }
+
+        std::size_t const first = inputs.size();
+        for (fs::directory_entry const & entry :
+             fs::directory_iterator{input, ec}) {
+            if (is_airfoil_file(entry.path()) && entry.is_regular_file(ec)) {
+                inputs.push_back(entry.path());
+            }
+        }
+        std::sort(inputs.begin() + static_cast<std::ptrdiff_t>(first),
+                  inputs.end());
+    }
+    options.inputs = std::move(inputs);
+
+    std::size_t const n_jobs = options.inputs.size() + options.naca.size();
+
+    // Every geometry is independent, hand them out to the workers one by one
+    std::atomic<std::size_t> next_input{0};
+    std::atomic<bool>        failed{false};
+
+    auto worker = [&]() {
+        for (std::size_t i = next_input++; i < n_jobs; i = next_input++) {
+            vortisim::ScopedTimer const timer{"geometry", "batch"};
+
+            bool const ok =
+                (i < options.inputs.size())
+                    ? process(options.inputs[i], options)
+                    : process_naca(options.naca[i - options.inputs.size()],
+                                   options);
+            if (!ok) {
+                failed = true;
+            }
+        }
+    };
+
+    unsigned const n_workers =
+        std::min<unsigned>(options.jobs, static_cast<unsigned>(n_jobs));
+
+    // A single file gets all threads for its assembly and field export
+    std::unique_ptr<vortisim::ThreadPool> pool;
+    if (n_workers == 1 && options.jobs > 1) {
+        pool = std::make_unique<vortisim::ThreadPool>(options.jobs);
+        options.pool = pool.get();
+    }
+
+    vortisim::Profiler & profiler = vortisim::Profiler::instance();
+    profiler.setEnabled(!options.profile.empty());
+
+    std::vector<std::thread> workers;
+    workers.reserve(n_workers);
+    for (unsigned i = 0; i < n_workers; ++i) {
+        workers.emplace_back(worker);
+    }
+    for (std::thread & t : workers) {
+        t.join();
+    }
+
+    if (profiler.enabled() && !profiler.writeTrace(options.profile)) {
+        std::cerr << options.profile.string() << ": cannot write\n";
+        return EXIT_FAILURE;
+    }
+
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,220 @@
+#include "bench/gpufield.h"
+
+#include "fieldclusters.h"
+
+#include <QMatrix4x4>
+#include <QSurfaceFormat>
+#include <QVector2D>
+#include <QVector4D>
+#include <array>
+#include <chrono>
+
+std::unique_ptr<GpuField>
+GpuField::create(int width, int height)
+{
+    std::unique_ptr<GpuField> field{new GpuField{}};
+    if (!field->init(width, height)) {
+        return nullptr;
+    }
+
+    return field;
+}
+
+bool
+GpuField::init(int width, int height)
+{
+    // The version and profile of the editor
+    QSurfaceFormat format{};
+
+    constexpr int gl_major = 3;
+    constexpr int gl_minor = 2;
+    format.setVersion(gl_major, gl_minor);
+    format.setProfile(QSurfaceFormat::CoreProfile);
+
+    context_.setFormat(format);
+    if (!context_.create()) {
+        return false;
+    }
+
+    surface_.setFormat(context_.format());
+    surface_.create();
+    if (!surface_.isValid() || !context_.makeCurrent(&surface_)) {
+        return false;
+    }
+
+    initializeOpenGLFunctions();
+
+    if (!prog_.addShaderFromSourceFile(QOpenGLShader::Vertex,
+                                       ":/shaders/arrows.v.glsl") ||
+        !prog_.addShaderFromSourceFile(QOpenGLShader::Fragment,
+                                       ":/shaders/field.f.glsl")) {
+        return false;
+    }
+    prog_.bindAttributeLocation("in_position", 0);
+    if (!prog_.link()) {
+        return false;
+    }
+
+    target_ = std::make_unique<QOpenGLFramebufferObject>(
+        QSize{width, height},
+        QOpenGLFramebufferObject::NoAttachment,
+        GL_TEXTURE_2D,
+        GL_RG32F);
+    if (!target_->isValid()) {
+        return false;
+    }
+
+    glGetIntegerv(GL_MAX_TEXTURE_BUFFER_SIZE, &max_panels_);
+    glGenBuffers(1, &line_buffer_);
+    glGenTextures(1, &line_texture_);
+    glGenBuffers(1, &strength_buffer_);
+    glGenTextures(1, &strength_texture_);
+    glGenBuffers(1, &cluster_buffer_);
+    glGenTextures(1, &cluster_texture_);
+
+    // Canvas square
+    vao_.create();
+    vbo_.create();
+    prog_.bind();
+    vao_.bind();
+    vbo_.bind();
+
+    constexpr std::array<GLfloat, 8> square{
+        -1.0F, 1.0F, 1.0F, 1.0F, 1.0F, -1.0F, -1.0F, -1.0F};
+
+    vbo_.setUsagePattern(QOpenGLBuffer::StaticDraw);
+    vbo_.allocate(square.data(), square.size() * sizeof(GLfloat));
+    prog_.setAttributeBuffer("in_position", GL_FLOAT, 0, 2);
+    prog_.enableAttributeArray("in_position");
+
+    vbo_.release();
+    vao_.release();
+
+    // Identity view, the texels span the canvas
+    prog_.setUniformValue("mvp", QMatrix4x4{});
+    prog_.setUniformValue("inverse_mvp", QMatrix4x4{});
+    prog_.setUniformValue("viewport",
+                          QVector4D(0.0F,
+                                    0.0F,
+                                    static_cast<float>(width),
+                                    static_cast<float>(height)));
+    prog_.setUniformValue("lines", 0);
+    prog_.setUniformValue("strengths", 1);
+    prog_.setUniformValue("clusters", 4);
+    prog_.release();
+
+    return true;
+}
+
+GpuField::~GpuField()
+{
+    if (!context_.makeCurrent(&surface_)) {
+        return;
+    }
+
+    glDeleteTextures(1, &line_texture_);
+    glDeleteBuffers(1, &line_buffer_);
+    glDeleteTextures(1, &strength_texture_);
+    glDeleteBuffers(1, &strength_buffer_);
+    glDeleteTextures(1, &cluster_texture_);
+    glDeleteBuffers(1, &cluster_buffer_);
+
+    target_.reset();
+    vao_.destroy();
+    vbo_.destroy();
+    prog_.removeAllShaders();
+
+    context_.doneCurrent();
+}
+
+bool
+GpuField::setPanels(vortisim::PanelArrays const & panels,
+                    std::vector<double> const &   strengths,
+                    vortisim::Vec2 const &        vinf,
+                    vortisim::Quadrature          quadrature)
+{
+    std::size_t const n = panels.size();
+    if (n > static_cast<std::size_t>(max_panels_)) {
+        return false;
+    }
+
+    std::vector<GLfloat> lines;
+    std::vector<GLfloat> values;
+    lines.reserve(4 * n);
+    values.reserve(2 * n);
+    for (std::size_t i = 0; i < n; ++i) {
+        lines.push_back(static_cast<GLfloat>(panels.x1[i]));
+        lines.push_back(static_cast<GLfloat>(panels.y1[i]));
+        lines.push_back(static_cast<GLfloat>(panels.x2[i]));
+        lines.push_back(static_cast<GLfloat>(panels.y2[i]));
+        // Constant strengths, the same at both ends
+        values.push_back(static_cast<GLfloat>(strengths[i]));
+        values.push_back(static_cast<GLfloat>(strengths[i]));
+    }
+
+    auto const upload = [this](GLuint                       buffer,
+                               GLuint                       texture,
+                               GLenum                       format,
+                               std::vector<GLfloat> const & data) {
+        glBindBuffer(GL_TEXTURE_BUFFER, buffer);
+        glBufferData(GL_TEXTURE_BUFFER,
+                     static_cast<GLsizeiptr>(data.size() * sizeof(GLfloat)),
+                     data.data(),
+                     GL_STATIC_DRAW);
+        glBindBuffer(GL_TEXTURE_BUFFER, 0);
+
+        glBindTexture(GL_TEXTURE_BUFFER, texture);
+        glTexBuffer(GL_TEXTURE_BUFFER, format, buffer);
+        glBindTexture(GL_TEXTURE_BUFFER, 0);
+    };
+
+    upload(line_buffer_, line_texture_, GL_RGBA32F, lines);
+    upload(strength_buffer_, strength_texture_, GL_RG32F, values);
+    upload(cluster_buffer_,
+           cluster_texture_,
+           GL_RGBA32F,
+           field_clusters(lines, values));
+
+    prog_.bind();
+    prog_.setUniformValue("n_lines", static_cast<GLint>(n));
+    prog_.setUniformValue("quadrature", static_cast<GLint>(quadrature));
+    prog_.setUniformValue(
+        "formulation", static_cast<GLint>(vortisim::Formulation::CONSTANT));
+    prog_.setUniformValue("vinf",
+                          QVector2D(static_cast<float>(vinf.x),
+                                    static_cast<float>(vinf.y)));
+    prog_.release();
+
+    return true;
+}
+
+double
+GpuField::render()
+{
+    auto const start = std::chrono::steady_clock::now();
+
+    target_->bind();
+    glViewport(0, 0, target_->width(), target_->height());
+
+    prog_.bind();
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_BUFFER, line_texture_);
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_BUFFER, strength_texture_);
+    glActiveTexture(GL_TEXTURE4);
+    glBindTexture(GL_TEXTURE_BUFFER, cluster_texture_);
+    glActiveTexture(GL_TEXTURE0);
+
+    vao_.bind();
+    glDrawArrays(GL_TRIANGLE_FAN, 0, 4);
+    vao_.release();
+
+    prog_.release();
+    target_->release();
+
+    // Draw calls only queue work
+    glFinish();
+
+    auto const stop = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(stop - start).count();
+}
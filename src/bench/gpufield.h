@@ -0,0 +1,77 @@
+#ifndef BENCH_GPUFIELD_H
+#define BENCH_GPUFIELD_H
+
+#include "core/assembly.h"
+#include "core/panel.h"
+#include "core/vec2.h"
+
+#include <QOffscreenSurface>
+#include <QOpenGLBuffer>
+#include <QOpenGLContext>
+#include <QOpenGLExtraFunctions>
+#include <QOpenGLFramebufferObject>
+#include <QOpenGLShaderProgram>
+#include <QOpenGLVertexArrayObject>
+#include <memory>
+#include <vector>
+
+// The field pass of DisplayWidget on an offscreen context: field.f.glsl
+// evaluated once per texel of an RG32F target. The target spans [-1, 1] in
+// both directions, like the editor canvas.
+class GpuField final : protected QOpenGLExtraFunctions {
+public:
+    // Nothing when no OpenGL 3.2 core context is available; needs a
+    // QGuiApplication
+    static std::unique_ptr<GpuField>
+    create(int width, int height);
+
+    GpuField(GpuField const &) = delete;
+    GpuField(GpuField &&) noexcept = delete;
+
+    ~GpuField();
+
+    GpuField &
+    operator=(GpuField const &) = delete;
+    GpuField &
+    operator=(GpuField &&) noexcept = delete;
+
+    // Uploads the panels and their constant strengths; false when they do
+    // not fit into a texture buffer
+    bool
+    setPanels(vortisim::PanelArrays const & panels,
+              std::vector<double> const &   strengths,
+              vortisim::Vec2 const &        vinf,
+              vortisim::Quadrature          quadrature);
+
+    // Renders the field once and waits for it, in milliseconds
+    double
+    render();
+
+private:
+    GpuField() = default;
+
+    bool
+    init(int width, int height);
+
+    QOpenGLContext    context_{};
+    QOffscreenSurface surface_{};
+
+    std::unique_ptr<QOpenGLFramebufferObject> target_{};
+
+    QOpenGLShaderProgram     prog_{};
+    QOpenGLVertexArrayObject vao_{};
+    QOpenGLBuffer            vbo_{};
+
+    // Texture buffers of the panel endpoints, strengths and far-field
+    // clusters
+    GLuint line_buffer_{};
+    GLuint line_texture_{};
+    GLuint strength_buffer_{};
+    GLuint strength_texture_{};
+    GLuint cluster_buffer_{};
+    GLuint cluster_texture_{};
+
+    GLint max_panels_{};
+};
+
+#endif // BENCH_GPUFIELD_H
@@ -0,0 +1,448 @@
+#include "core/airfoil.h"
+#include "core/assembly.h"
+#include "core/flowfield.h"
+#include "core/iterative.h"
+#include "core/mixed.h"
+#include "core/solver.h"
+#include "core/threadpool.h"
+
+#ifdef VORTISIM_BENCH_GPU
+#include "bench/gpufield.h"
+
+#include <QGuiApplication>
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace {
+
+namespace fs = std::filesystem;
+
+struct Options {
+    // Doubling panel counts from min_panels up to max_panels
+    std::size_t min_panels{64};
+    std::size_t max_panels{16384};
+
+    // Field evaluated on field_size by field_size points
+    std::size_t field_size{256};
+
+    int      repeats{3};
+    unsigned jobs{std::max(1U, std::thread::hardware_concurrency())};
+
+    vortisim::SolverOptions solver{};
+    // Dense systems factorized in float and refined
+    bool mixed{false};
+
+    // JSON report, standard output when empty
+    fs::path output{};
+
+    bool gpu{true};
+};
+
+// Best times of one panel count in milliseconds, negative when not measured
+struct Result {
+    std::size_t          panels{};
+    vortisim::SolverMode mode{vortisim::SolverMode::DENSE};
+
+    // Influence matrix, not measured on the iterative path
+    double assembly_ms{-1.0};
+    // QR or float LU, or the preconditioner blocks of the iterative path
+    double factorization_ms{-1.0};
+    // Back substitution, or the whole GMRES solve of the iterative path, or
+    // the refined solve of the mixed path
+    double solve_ms{-1.0};
+    int    iterations{};
+    // Relative residual of the strengths
+    double residual{};
+
+    double field_cpu_ms{-1.0};
+    double field_gpu_ms{-1.0};
+};
+
+void
+print_usage(char const * argv0)
+{
+    std::cerr
+        << "Usage: " << argv0 << " [options]\n"
+        << "Times assembly, solve and field evaluation of NACA 0012 sections\n"
+        << "of doubling panel counts and writes the best of a few runs as\n"
+        << "JSON\n\n"
+        << "  -j, --jobs <n>     Number of worker threads (default: all\n"
+        << "                     cores)\n"
+        << "  -q, --quadrature <analytic|riemann>\n"
+        << "                     Panel influence evaluation (default:\n"
+        << "                     analytic)\n"
+        << "  --min <n>          Smallest panel count (default: 64)\n"
+        << "  --max <n>          Largest panel count (default: 16384)\n"
+        << "  --dense-limit <n>  Solve iteratively from n panels on (default:\n"
+        << "                     2000, like the solver)\n"
+        << "  --mixed            Factorize the dense systems in float and\n"
+        << "                     refine to double accuracy\n"
+        << "  --low-memory       Assemble every residual of --mixed instead\n"
+        << "                     of keeping the double matrix\n"
+        << "  --field <n>        Evaluate the field on n by n points\n"
+        << "                     (default: 256)\n"
+        << "  --repeats <n>      Runs per measurement (default: 3)\n"
+        << "  --no-gpu           Skip the offscreen field rendering\n"
+        << "  -o, --output <file>\n"
+        << "                     Write the report to a file (default: stdout)\n"
+        << "  -h, --help         Show this help\n";
+}
+
+bool
+parse_options(int argc, char ** argv, Options & options)
+{
+    std::vector<std::string_view> const args(argv + 1, argv + argc);
+
+    for (auto it = args.begin(); it != args.end(); ++it) {
+        std::string_view const arg = *it;
+
+        auto next = [&it, &args]() -> std::string {
+            if (std::next(it) == args.end()) {
+                return {};
+            }
+            return std::string{*++it};
+        };
+
+        // Positive integer argument
+        auto count = [&next](std::size_t & value) {
+            long const n = std::atol(next().c_str());
+            if (n < 1) {
+                return false;
+            }
+            value = static_cast<std::size_t>(n);
+            return true;
+        };
+
+        if (arg == "-h" || arg == "--help") {
+            return false;
+        }
+
+        std::size_t value = 0;
+        if (arg == "-j" || arg == "--jobs") {
+            if (!count(value)) {
+                std::cerr << "Invalid job count\n";
+                return false;
+            }
+            options.jobs = static_cast<unsigned>(value);
+        } else if (arg == "-q" || arg == "--quadrature") {
+            std::string const quadrature = next();
+            if (quadrature == "analytic") {
+                options.solver.quadrature = vortisim::Quadrature::ANALYTIC;
+            } else if (quadrature == "riemann") {
+                options.solver.quadrature = vortisim::Quadrature::RIEMANN;
+            } else {
+                std::cerr << "Unknown quadrature " << quadrature << '\n';
+                return false;
+            }
+        } else if (arg == "--min" || arg == "--max") {
+            if (!count(value) || value < 4) {
+                std::cerr << "Invalid panel count\n";
+                return false;
+            }
+            (arg == "--min" ? options.min_panels : options.max_panels) = value;
+        } else if (arg == "--dense-limit") {
+            if (!count(options.solver.iterative_threshold)) {
+                std::cerr << "Invalid panel count\n";
+                return false;
+            }
+        } else if (arg == "--mixed") {
+            options.mixed = true;
+        } else if (arg == "--low-memory") {
+            options.solver.low_memory = true;
+        } else if (arg == "--field") {
+            if (!count(options.field_size) || options.field_size < 2) {
+                std::cerr << "Invalid field size\n";
+                return false;
+            }
+        } else if (arg == "--repeats") {
+            if (!count(value)) {
+                std::cerr << "Invalid repeat count\n";
+                return false;
+            }
+            options.repeats = static_cast<int>(value);
+        } else if (arg == "--no-gpu") {
+            options.gpu = false;
+        } else if (arg == "-o" || arg == "--output") {
+            options.output = next();
+            if (options.output.empty()) {
+                std::cerr << "Missing output file\n";
+                return false;
+            }
+        } else {
+            std::cerr << "Unknown option " << arg << '\n';
+            return false;
+        }
+    }
+
+    return options.min_panels <= options.max_panels;
+}
+
+// Best wall time of repeated runs
+template<typename F>
+double
+best_ms(int repeats, F && run)
+{
+    double best = std::numeric_limits<double>::max();
+    for (int r = 0; r < repeats; ++r) {
+        auto const start = std::chrono::steady_clock::now();
+        run();
+        auto const stop = std::chrono::steady_clock::now();
+
+        best = std::min(
+            best,
+            std::chrono::duration<double, std::milli>(stop - start).count());
+    }
+
+    return best;
+}
+
+// Unit chord NACA 0012 centered on the canvas, which spans [-1, 1]
+vortisim::Scene
+make_scene(std::size_t n_panels)
+{
+    vortisim::Scene scene{};
+    scene.bodies.push_back(vortisim::naca4(0.0, 0.0, 0.12, n_panels));
+    for (vortisim::Vec2 & node : scene.bodies.back().nodes) {
+        node.x -= 0.5;
+    }
+
+    return scene;
+}
+
+// Times the CPU stages of one panel count and keeps the strengths for the
+// GPU pass
+Result
+run_cpu(vortisim::Scene const & scene,
+        Options const &         options,
+        vortisim::ThreadPool *  pool,
+        vortisim::Solution &    solution)
+{
+    vortisim::Vec2 const       vinf{1.0, 0.0};
+    vortisim::Quadrature const quadrature = options.solver.quadrature;
+
+    vortisim::PanelArrays const panels = vortisim::make_panel_arrays(scene);
+    Eigen::VectorXd const       b = vortisim::assemble_rhs(scene, vinf);
+
+    Result result{};
+    result.panels = panels.size();
+
+    Eigen::VectorXd x;
+    if (panels.size() < options.solver.iterative_threshold && options.mixed) {
+        // Residuals against the double matrix, or assembled in every step
+        // with --low-memory
+        bool const      low_memory = options.solver.low_memory;
+        Eigen::MatrixXd a;
+        Eigen::MatrixXf a_float;
+        result.mode = vortisim::SolverMode::MIXED;
+        result.assembly_ms = best_ms(options.repeats, [&]() {
+            if (low_memory) {
+                a_float = vortisim::assemble_influence<float>(
+                    panels, quadrature, pool);
+            } else {
+                a = vortisim::assemble_influence(panels, quadrature, pool);
+            }
+        });
+
+        std::unique_ptr<vortisim::MixedSolver> mixed;
+        result.factorization_ms = best_ms(options.repeats, [&]() {
+            mixed = low_memory ? std::make_unique<vortisim::MixedSolver>(
+                                     panels, a_float, quadrature, pool)
+                               : std::make_unique<vortisim::MixedSolver>(
+                                     panels, a, quadrature, pool);
+        });
+        result.solve_ms = best_ms(options.repeats, [&]() {
+            vortisim::RefinementResult const refined =
+                mixed->solve(b, x, options.solver.refinement);
+            result.iterations = refined.steps;
+            result.residual = refined.residual;
+        });
+    } else if (panels.size() < options.solver.iterative_threshold) {
+        Eigen::MatrixXd a;
+        result.assembly_ms = best_ms(options.repeats, [&]() {
+            a = vortisim::assemble_influence(panels, quadrature, pool);
+        });
+
+        // The factorization of solve()
+        Eigen::FullPivHouseholderQR<Eigen::MatrixXd> qr;
+        result.factorization_ms =
+            best_ms(options.repeats, [&]() { qr.compute(a); });
+        result.solve_ms =
+            best_ms(options.repeats, [&]() { x = qr.solve(b); });
+        result.residual = (b - a * x).norm() / b.norm();
+    } else {
+        vortisim::IterativeOptions const & iterative = options.solver.iterative;
+
+        // No matrix; the preconditioner blocks are its factorization
+        std::unique_ptr<vortisim::BlockJacobi> blocks;
+        result.mode = vortisim::SolverMode::ITERATIVE;
+        result.factorization_ms = best_ms(options.repeats, [&]() {
+            blocks = std::make_unique<vortisim::BlockJacobi>(
+                panels, iterative.block_size, pool);
+        });
+        result.solve_ms = best_ms(options.repeats, [&]() {
+            x = Eigen::VectorXd::Zero(b.size());
+            vortisim::GmresResult const gmres = vortisim::solve_iterative(
+                panels, *blocks, b, x, iterative, pool);
+            result.iterations = gmres.iterations;
+            result.residual = gmres.residual;
+        });
+    }
+
+    solution.strengths.assign(x.data(), x.data() + x.size());
+
+    vortisim::FlowFieldOptions flow{};
+    flow.quadrature = quadrature;
+
+    vortisim::FlowField field{scene, solution, vinf, flow};
+    result.field_cpu_ms = best_ms(options.repeats, [&]() {
+        field.sample({-1.0, -1.0},
+                     {1.0, 1.0},
+                     options.field_size,
+                     options.field_size,
+                     pool);
+    });
+
+    return result;
+}
+
+void
+write_ms(std::ostream & out, char const * key, double ms)
+{
+    out << ", \"" << key << "\": ";
+    if (ms < 0.0) {
+        out << "null";
+    } else {
+        out << ms;
+    }
+}
+
+bool
+write_report(std::ostream &              out,
+             Options const &             options,
+             std::vector<Result> const & results)
+{
+    bool const analytic =
+        options.solver.quadrature == vortisim::Quadrature::ANALYTIC;
+
+    out << std::setprecision(6);
+    out << "{\n"
+        << "  \"version\": 1,\n"
+        << "  \"threads\": " << options.jobs << ",\n"
+        << "  \"quadrature\": \"" << (analytic ? "analytic" : "riemann")
+        << "\",\n"
+        << "  \"field_points\": " << options.field_size * options.field_size
+        << ",\n"
+        << "  \"repeats\": " << options.repeats << ",\n"
+        << "  \"low_memory\": " << std::boolalpha
+        << options.solver.low_memory << std::noboolalpha << ",\n"
+        << "  \"results\": [";
+
+    for (std::size_t k = 0; k < results.size(); ++k) {
+        Result const & r = results[k];
+        char const *   solver = "dense";
+        if (r.mode == vortisim::SolverMode::ITERATIVE) {
+            solver = "iterative";
+        } else if (r.mode == vortisim::SolverMode::MIXED) {
+            solver = "mixed";
+        }
+
+        out << ((k > 0) ? "," : "") << "\n    {\"panels\": " << r.panels
+            << ", \"solver\": \"" << solver << '"';
+        write_ms(out, "assembly_ms", r.assembly_ms);
+        write_ms(out, "factorization_ms", r.factorization_ms);
+        write_ms(out, "solve_ms", r.solve_ms);
+        out << ", \"iterations\": " << r.iterations
+            << ", \"residual\": " << r.residual;
+        write_ms(out, "field_cpu_ms", r.field_cpu_ms);
+        write_ms(out, "field_gpu_ms", r.field_gpu_ms);
+        out << '}';
+    }
+    out << "\n  ]\n}\n";
+
+    return static_cast<bool>(out);
+}
+
+} // namespace
+
+int
+main(int argc, char ** argv)
+{
+    Options options{};
+    if (!parse_options(argc, argv, options)) {
+        print_usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    std::unique_ptr<vortisim::ThreadPool> pool;
+    if (options.jobs > 1) {
+        pool = std::make_unique<vortisim::ThreadPool>(options.jobs);
+    }
+
+#ifdef VORTISIM_BENCH_GPU
+    // The offscreen context needs a display connection
+    std::unique_ptr<QGuiApplication> app;
+    std::unique_ptr<GpuField>        gpu;
+    if (options.gpu) {
+        app = std::make_unique<QGuiApplication>(argc, argv);
+
+        int const size = static_cast<int>(options.field_size);
+        gpu = GpuField::create(size, size);
+        if (!gpu) {
+            std::cerr << "No OpenGL 3.2 context, skipping the GPU field\n";
+        }
+    }
+#endif
+
+    std::vector<Result> results;
+    for (std::size_t n = options.min_panels; n <= options.max_panels; n *= 2) {
+        std::cerr << n << " panels\n";
+
+        vortisim::Scene const scene = make_scene(n);
+        vortisim::Solution    solution{};
+        Result result = run_cpu(scene, options, pool.get(), solution);
+
+#ifdef VORTISIM_BENCH_GPU
+        if (gpu && gpu->setPanels(vortisim::make_panel_arrays(scene),
+                                  solution.strengths,
+                                  {1.0, 0.0},
+                                  options.solver.quadrature)) {
+            // The first draw also finishes compiling the shader
+            gpu->render();
+
+            result.field_gpu_ms = std::numeric_limits<double>::max();
+            for (int r = 0; r < options.repeats; ++r) {
+                result.field_gpu_ms =
+                    std::min(result.field_gpu_ms, gpu->render());
+            }
+        }
+#endif
+
+        results.push_back(result);
+    }
+
+    if (options.output.empty()) {
+        return write_report(std::cout, options, results) ? EXIT_SUCCESS
+                                                         : EXIT_FAILURE;
+    }
+
+    std::ofstream out{options.output};
+    if (!write_report(out, options, results)) {
+        std::cerr << options.output.string() << ": cannot write\n";
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,391 @@
+#include "core/airfoil.h"
+
+#include "core/mapping.h"
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <charconv>
+#include <cmath>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <utility>
+
+namespace vortisim {
+
+namespace {
+
+constexpr double G_PI = 3.14159265358979;
+
+// Files per parallel task of a directory load
+constexpr std::size_t G_FILE_CHUNK = 8;
+
+std::string_view
+trim(std::string_view s)
+{
+    std::size_t const first = s.find_first_not_of(" \t\r");
+    if (first == std::string_view::npos) {
+        return {};
+    }
+
+    return s.substr(first, s.find_last_not_of(" \t\r") + 1 - first);
+}
+
+// Removes the first line, without its terminator, from text
+std::string_view
+next_line(std::string_view & text)
+{
+    std::size_t const end = text.find('\n');
+    std::string_view  line = text.substr(0, end);
+
+    text.remove_prefix((end == std::string_view::npos) ? text.size()
+                                                       : end + 1);
+
+    return line;
+}
+
+// Parses a number at the start of s and removes it with the whitespace
+// before it
+bool
+parse_number(std::string_view & s, double & value)
+{
+    s = trim(s);
+    if (!s.empty() && s.front() == '+') {
+        s.remove_prefix(1);
+    }
+
+    std::from_chars_result const result =
+        std::from_chars(s.data(), s.data() + s.size(), value);
+    if (result.ec != std::errc{}) {
+        return false;
+    }
+
+    s.remove_prefix(static_cast<std::size_t>(result.ptr - s.data()));
+    return true;
+}
+
+// Exactly two numbers
+bool
+parse_pair(std::string_view line, Vec2 & p)
+{
+    return parse_number(line, p.x) && parse_number(line, p.y) &&
+           trim(line).empty();
+}
+
+// Counter-clockwise closed outline from a Selig ordered point list
+bool
+finish_outline(std::vector<Vec2> & nodes)
+{
+    nodes.erase(std::unique(nodes.begin(), nodes.end()), nodes.end());
+
+    if (nodes.size() > 1) {
+        if (nodes.front() != nodes.back()) {
+            nodes.front() = 0.5 * (nodes.front() + nodes.back());
+        }
+        nodes.pop_back();
+    }
+
+    constexpr std::size_t min_panels = 3;
+    if (nodes.size() < min_panels) {
+        return false;
+    }
+
+    // Shoelace formula; clockwise files start along the lower surface
+    double area = 0.0;
+    for (std::size_t i = 0; i < nodes.size(); ++i) {
+        Vec2 const & a = nodes[i];
+        Vec2 const & b = nodes[(i + 1) % nodes.size()];
+        area += a.x * b.y - b.x * a.y;
+    }
+    if (area < 0.0) {
+        std::reverse(nodes.begin() + 1, nodes.end());
+    }
+
+    return true;
+}
+
+// Camber line height and slope at x
+struct MeanLine {
+    double y{};
+    double slope{};
+};
+
+// Cosine spaced outline of a NACA section around the given mean line, from
+// the trailing edge over the upper surface
+template<typename Camber>
+Body
+naca_outline(Camber const & camber, double thickness, std::size_t n_panels)
+{
+    std::size_t const half = std::max<std::size_t>((n_panels + 1) / 2, 2);
+
+    auto const surface = [&camber, thickness](double beta, double side) {
+        double const x = 0.5 * (1.0 - std::cos(beta));
+
+        // Closed trailing edge variant of the thickness distribution
+        double const yt =
+            5.0 * thickness *
+            (0.2969 * std::sqrt(x) -
+             x * (0.1260 + x * (0.3516 - x * (0.2843 - x * 0.1036))));
+
+        MeanLine const mean = camber(x);
+        double const   theta = std::atan(mean.slope);
+
+        return Vec2{x - side * yt * std::sin(theta),
+                    mean.y + side * yt * std::cos(theta)};
+    };
+
+    double const step = G_PI / static_cast<double>(half);
+
+    Body body{};
+    body.nodes.reserve(2 * half);
+    for (std::size_t k = half + 1; k-- > 0;) {
+        body.nodes.push_back(surface(step * static_cast<double>(k), 1.0));
+    }
+    for (std::size_t k = 1; k < half; ++k) {
+        body.nodes.push_back(surface(step * static_cast<double>(k), -1.0));
+    }
+
+    return body;
+}
+
+} // namespace
+
+std::optional<Airfoil>
+parse_airfoil(std::string_view text)
+{
+    Airfoil           airfoil{};
+    std::vector<Vec2> points;
+
+    bool has_name = false;
+    while (!text.empty()) {
+        std::string_view const line = trim(next_line(text));
+        if (line.empty()) {
+            continue;
+        }
+
+        Vec2 p{};
+        if (parse_pair(line, p)) {
+            points.push_back(p);
+        } else if (!has_name && points.empty()) {
+            airfoil.name = std::string{line};
+        } else {
+            return std::nullopt;
+        }
+        has_name = true;
+    }
+
+    if (points.empty()) {
+        return std::nullopt;
+    }
+
+    // Lednicer files start with the point counts of both surfaces, Selig
+    // coordinates stay within the unit chord
+    constexpr double max_coordinate = 1.5;
+    if (points.front().x > max_coordinate) {
+        auto const n_upper = static_cast<std::size_t>(points.front().x);
+        auto const n_lower = static_cast<std::size_t>(points.front().y);
+        if (n_upper < 2 || n_lower < 2 ||
+            points.size() != 1 + n_upper + n_lower) {
+            return std::nullopt;
+        }
+
+        // Upper surface reversed to run from the trailing edge, then the
+        // lower one from the leading edge
+        auto const upper = points.begin() + 1;
+        auto const lower = upper + static_cast<std::ptrdiff_t>(n_upper);
+
+        std::vector<Vec2> selig(std::make_reverse_iterator(lower),
+                                std::make_reverse_iterator(upper));
+        selig.insert(selig.end(), lower, points.end());
+        points = std::move(selig);
+    }
+
+    if (!finish_outline(points)) {
+        return std::nullopt;
+    }
+    airfoil.body.nodes = std::move(points);
+
+    return airfoil;
+}
+
+std::optional<Airfoil>
+load_airfoil(std::filesystem::path const & path)
+{
+    FileDescriptor const fd{::open(path.c_str(), O_RDONLY)};
+    if (fd.get() < 0) {
+        return std::nullopt;
+    }
+
+    struct stat info {};
+    if (::fstat(fd.get(), &info) != 0 || info.st_size <= 0) {
+        return std::nullopt;
+    }
+
+    Mapping const file{
+        fd.get(), 0, static_cast<std::size_t>(info.st_size), false};
+    if (file.data() == nullptr) {
+        return std::nullopt;
+    }
+
+    std::optional<Airfoil> airfoil =
+        parse_airfoil({file.data(), file.size()});
+    if (airfoil && airfoil->name.empty()) {
+        airfoil->name = path.stem().string();
+    }
+
+    return airfoil;
+}
+
+AirfoilLibrary
+load_airfoil_directory(std::filesystem::path const & directory,
+                       ThreadPool *                  pool)
+{
+    std::vector<std::filesystem::path> paths;
+
+    std::error_code ec;
+    for (std::filesystem::directory_entry const & entry :
+         std::filesystem::directory_iterator{directory, ec}) {
+        std::string extension = entry.path().extension().string();
+        std::transform(
+            extension.begin(), extension.end(), extension.begin(), [](char c) {
+                return static_cast<char>(
+                    std::tolower(static_cast<unsigned char>(c)));
+            });
+
+        if (extension == ".dat" && entry.is_regular_file(ec)) {
+            paths.push_back(entry.path());
+        }
+    }
+    std::sort(paths.begin(), paths.end());
+
+    std::vector<std::optional<Airfoil>> loaded(paths.size());
+    parallel_for(pool,
+                 paths.size(),
+                 G_FILE_CHUNK,
+                 [&paths, &loaded](std::size_t begin, std::size_t end) {
+                     for (std::size_t i = begin; i < end; ++i) {
+                         loaded[i] = load_airfoil(paths[i]);
+                     }
+                 });
+
+    AirfoilLibrary library{};
+    for (std::size_t i = 0; i < paths.size(); ++i) {
+        if (loaded[i]) {
+            library.airfoils.push_back(std::move(*loaded[i]));
+        } else {
+            library.failed.push_back(paths[i]);
+        }
+    }
+
+    return library;
+}
+
+Body
+naca4(double      camber,
+      double      camber_position,
+      double      thickness,
+      std::size_t n_panels)
+{
+    double const m = camber;
+    double const p = camber_position;
+
+    auto const mean_line = [m, p](double x) {
+        if (m == 0.0 || p <= 0.0 || p >= 1.0) {
+            return MeanLine{};
+        }
+        if (x < p) {
+            return MeanLine{m / (p * p) * (2.0 * p * x - x * x),
+                            2.0 * m / (p * p) * (p - x)};
+        }
+
+        double const q = (1.0 - p) * (1.0 - p);
+        return MeanLine{m / q * (1.0 - 2.0 * p + 2.0 * p * x - x * x),
+                        2.0 * m / q * (p - x)};
+    };
+
+    return naca_outline(mean_line, thickness, n_panels);
+}
+
+std::optional<Body>
+naca5(std::string_view designation, std::size_t n_panels)
+{
+    if (designation.size() != 5 ||
+        !std::all_of(designation.begin(), designation.end(), [](char c) {
+            return std::isdigit(static_cast<unsigned char>(c)) != 0;
+        })) {
+        return std::nullopt;
+    }
+
+    int const    lift = designation[0] - '0';
+    int const    position = designation[1] - '0';
+    bool const   reflex = designation[2] == '1';
+    double const thickness =
+        ((designation[3] - '0') * 10 + (designation[4] - '0')) / 100.0;
+
+    if (designation[2] > '1' || position < 1 || position > 5 ||
+        (reflex && position < 2)) {
+        return std::nullopt;
+    }
+
+    // Mean line constants for a design lift coefficient of 0.3, by position
+    constexpr std::array<double, 5> standard_m{
+        0.0580, 0.1260, 0.2025, 0.2900, 0.3910};
+    constexpr std::array<double, 5> standard_k1{
+        361.400, 51.640, 15.957, 6.643, 3.230};
+    constexpr std::array<double, 5> reflex_m{
+        0.0, 0.1300, 0.2170, 0.3180, 0.4410};
+    constexpr std::array<double, 5> reflex_k1{
+        0.0, 51.990, 15.793, 6.520, 3.191};
+    constexpr std::array<double, 5> reflex_k21{
+        0.0, 0.000764, 0.00677, 0.0303, 0.1355};
+
+    // k1 scales linearly with the design lift coefficient 0.15 L
+    auto const   i = static_cast<std::size_t>(position - 1);
+    double const scale = 0.15 * lift / 0.3;
+    double const m = reflex ? reflex_m[i] : standard_m[i];
+    double const k1 = scale * (reflex ? reflex_k1[i] : standard_k1[i]);
+    double const k21 = reflex ? reflex_k21[i] : 0.0;
+
+    auto const mean_line = [m, k1, k21, reflex](double x) {
+        double const m3 = m * m * m;
+        if (!reflex) {
+            if (x < m) {
+                double const c = m * m * (3.0 - m);
+                return MeanLine{
+                    k1 / 6.0 * (x * x * x - 3.0 * m * x * x + c * x),
+                    k1 / 6.0 * (3.0 * x * x - 6.0 * m * x + c)};
+            }
+            return MeanLine{k1 * m3 / 6.0 * (1.0 - x), -k1 * m3 / 6.0};
+        }
+
+        double const tail = k21 * (1.0 - m) * (1.0 - m) * (1.0 - m);
+        double const d = x - m;
+        double const r = (x < m) ? 1.0 : k21;
+        return MeanLine{k1 / 6.0 * (r * d * d * d - tail * x - m3 * x + m3),
+                        k1 / 6.0 * (3.0 * r * d * d - tail - m3)};
+    };
+
+    return naca_outline(mean_line, thickness, n_panels);
+}
+
+std::optional<Body>
+naca(std::string_view designation, std::size_t n_panels)
+{
+    if (!std::all_of(designation.begin(), designation.end(), [](char c) {
+            return std::isdigit(static_cast<unsigned char>(c)) != 0;
+        })) {
+        return std::nullopt;
+    }
+
+    if (designation.size() == 4) {
+        return naca4((designation[0] - '0') / 100.0,
+                     (designation[1] - '0') / 10.0,
+                     ((designation[2] - '0') * 10 + (designation[3] - '0')) /
+                         100.0,
+                     n_panels);
+    }
+
+    return naca5(designation, n_panels);
+}
+
+} // namespace vortisim
@@ -0,0 +1,69 @@
+#ifndef CORE_AIRFOIL_H
+#define CORE_AIRFOIL_H
+
+#include "core/body.h"
+#include "core/threadpool.h"
+
+#include <cstddef>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace vortisim {
+
+struct Airfoil {
+    std::string name{};
+    Body        body{};
+};
+
+// Parses an airfoil coordinate file in place. Both common layouts are read:
+// Selig, a name line followed by "x y" pairs from the trailing edge over the
+// upper surface and back along the lower one, and Lednicer, a name line, the
+// point counts of both surfaces and then each surface from the leading to the
+// trailing edge. The outline is returned counter-clockwise from the trailing
+// edge as node 0. An open trailing edge is closed at the midpoint of its two
+// ends, which the Kutta condition needs.
+std::optional<Airfoil>
+parse_airfoil(std::string_view text);
+
+// Maps the file read-only and parses it without copying
+std::optional<Airfoil>
+load_airfoil(std::filesystem::path const & path);
+
+struct AirfoilLibrary {
+    // In file name order
+    std::vector<Airfoil>               airfoils{};
+    std::vector<std::filesystem::path> failed{};
+};
+
+// Loads every .dat file of a directory, spread across the pool
+AirfoilLibrary
+load_airfoil_directory(std::filesystem::path const & directory,
+                       ThreadPool *                  pool = nullptr);
+
+// NACA four-digit section MPTT: maximum camber M percent at P tenths of the
+// chord and TT percent thickness. Nodes are cosine spaced along the unit
+// chord, which clusters them at both edges; the trailing edge is closed.
+// n_panels is rounded up to an even count.
+Body
+naca4(double      camber,
+      double      camber_position,
+      double      thickness,
+      std::size_t n_panels);
+
+// NACA five-digit section LPSTT: design lift coefficient 0.15 L, maximum
+// camber at P twentieths of the chord, standard (S = 0) or reflexed (S = 1)
+// mean line and TT percent thickness. Nothing for designations outside the
+// tabulated mean lines.
+std::optional<Body>
+naca5(std::string_view designation, std::size_t n_panels);
+
+// Four or five digit designation, e.g. "2412" or "23012"
+std::optional<Body>
+naca(std::string_view designation, std::size_t n_panels);
+
+} // namespace vortisim
+
+#endif // CORE_AIRFOIL_H
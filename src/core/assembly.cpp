@@ -0,0 +1,714 @@
+#include "core/assembly.h"
+
+#include "core/profiler.h"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <utility>
+
+namespace vortisim {
+
+namespace {
+
+constexpr double G_PI = 3.14159265358979;
+constexpr double G_TAU = 2.0 * G_PI;
+
+// Rows per block; sized so that the scratch columns stay in L1
+constexpr std::size_t G_BLOCK_ROWS = 64;
+
+// Columns of the residual assembled at once, 128 KiB of scratch per task
+constexpr std::size_t G_RESIDUAL_COLS = 256;
+
+template<typename T>
+using Scratch = std::array<T, G_BLOCK_ROWS>;
+
+// Exact coefficients of source panel j on the control points of
+// [begin, end). The geometric terms and the final combination are plain
+// loops over contiguous arrays which the compiler vectorizes; only the
+// transcendental calls are kept in a separate pass. Offsets from the panel
+// are taken in double before narrowing, so that a float column is accurate
+// far from the origin.
+template<typename T>
+void
+analytic_column(PanelArrays const & p,
+                std::size_t         j,
+                std::size_t         begin,
+                std::size_t         end,
+                T *                 out)
+{
+    Scratch<T> num;
+    Scratch<T> den;
+    Scratch<T> ratio;
+    Scratch<T> ct;
+    Scratch<T> cn;
+
+    double const x1 = p.x1[j];
+    double const y1 = p.y1[j];
+    auto const   tx = static_cast<T>(p.tx[j]);
+    auto const   ty = static_cast<T>(p.ty[j]);
+    auto const   len = static_cast<T>(p.len[j]);
+
+    std::size_t const rows = end - begin;
+
+    double const * xc = p.xc.data() + begin;
+    double const * yc = p.yc.data() + begin;
+    double const * nx = p.nx.data() + begin;
+    double const * ny = p.ny.data() + begin;
+
+    for (std::size_t k = 0; k < rows; ++k) {
+        // Control point in the frame of panel j
+        auto const dx = static_cast<T>(xc[k] - x1);
+        auto const dy = static_cast<T>(yc[k] - y1);
+        T const    x = dx * tx + dy * ty;
+        T const    y = dy * tx - dx * ty;
+        T const    y_sq = y * y;
+
+        num[k] = y * len;
+        den[k] = x * (x - len) + y_sq;
+        ratio[k] = (x * x + y_sq) / ((x - len) * (x - len) + y_sq);
+
+        // Projection of the panel frame on the control point normal
+        ct[k] = tx * static_cast<T>(nx[k]) + ty * static_cast<T>(ny[k]);
+        cn[k] = tx * static_cast<T>(ny[k]) - ty * static_cast<T>(nx[k]);
+    }
+
+    for (std::size_t k = 0; k < rows; ++k) {
+        num[k] = std::atan2(num[k], den[k]);
+        ratio[k] = std::log(ratio[k]);
+    }
+
+    constexpr T scale = static_cast<T>(1.0 / G_TAU);
+    constexpr T half = static_cast<T>(0.5);
+    for (std::size_t k = 0; k < rows; ++k) {
+        out[k] = scale * (half * ratio[k] * cn[k] - num[k] * ct[k]);
+    }
+}
+
+template<typename T>
+void
+riemann_column(PanelArrays const & p,
+               std::size_t         j,
+               std::size_t         begin,
+               std::size_t         end,
+               T *                 out)
+{
+    Vec2 const p1{p.x1[j], p.y1[j]};
+    Vec2 const p2{p.x2[j], p.y2[j]};
+
+    for (std::size_t i = begin; i < end; ++i) {
+        // The sampled quadrature is singular on its own panel, where the
+        // principal value of the normal velocity vanishes
+        if (i == j) {
+            out[i - begin] = T{0};
+            continue;
+        }
+
+        Vec2 const v = panel_velocity(
+            p1, p2, {p.xc[i], p.yc[i]}, Quadrature::RIEMANN);
+        out[i - begin] = static_cast<T>(v.x * p.nx[i] + v.y * p.ny[i]);
+    }
+}
+
+// Exact coefficients of the two halves of linear panel j, unit strength at
+// its start node and at its end node
+template<typename T>
+void
+analytic_linear_column(PanelArrays const & p,
+                       std::size_t         j,
+                       std::size_t         begin,
+                       std::size_t         end,
+                       T *                 at_start,
+                       T *                 at_end)
+{
+    Scratch<T> xs;
+    Scratch<T> ys;
+    Scratch<T> num;
+    Scratch<T> den;
+    Scratch<T> ratio;
+    Scratch<T> ct;
+    Scratch<T> cn;
+
+    double const x1 = p.x1[j];
+    double const y1 = p.y1[j];
+    auto const   tx = static_cast<T>(p.tx[j]);
+    auto const   ty = static_cast<T>(p.ty[j]);
+    auto const   len = static_cast<T>(p.len[j]);
+
+    std::size_t const rows = end - begin;
+
+    double const * xc = p.xc.data() + begin;
+    double const * yc = p.yc.data() + begin;
+    double const * nx = p.nx.data() + begin;
+    double const * ny = p.ny.data() + begin;
+
+    for (std::size_t k = 0; k < rows; ++k) {
+        auto const dx = static_cast<T>(xc[k] - x1);
+        auto const dy = static_cast<T>(yc[k] - y1);
+        T const    x = dx * tx + dy * ty;
+        T const    y = dy * tx - dx * ty;
+        T const    y_sq = y * y;
+
+        xs[k] = x;
+        ys[k] = y;
+        num[k] = y * len;
+        den[k] = x * (x - len) + y_sq;
+        ratio[k] = (x * x + y_sq) / ((x - len) * (x - len) + y_sq);
+
+        ct[k] = tx * static_cast<T>(nx[k]) + ty * static_cast<T>(ny[k]);
+        cn[k] = tx * static_cast<T>(ny[k]) - ty * static_cast<T>(nx[k]);
+    }
+
+    for (std::size_t k = 0; k < rows; ++k) {
+        num[k] = std::atan2(num[k], den[k]);
+        ratio[k] = std::log(ratio[k]);
+    }
+
+    constexpr T scale = static_cast<T>(1.0 / G_TAU);
+    constexpr T half = static_cast<T>(0.5);
+    T const     scale_len = scale / len;
+    for (std::size_t k = 0; k < rows; ++k) {
+        T const dtheta = num[k];
+        T const log_ratio = half * ratio[k];
+
+        // Same split as linear_panel_velocity
+        T const u_end = -scale_len * (xs[k] * dtheta - ys[k] * log_ratio);
+        T const v_end = scale_len * (xs[k] * log_ratio - len + ys[k] * dtheta);
+        T const u_start = -scale * dtheta - u_end;
+        T const v_start = scale * log_ratio - v_end;
+
+        at_start[k] = u_start * ct[k] + v_start * cn[k];
+        at_end[k] = u_end * ct[k] + v_end * cn[k];
+    }
+}
+
+template<typename T>
+void
+riemann_linear_column(PanelArrays const & p,
+                      std::size_t         j,
+                      std::size_t         begin,
+                      std::size_t         end,
+                      T *                 at_start,
+                      T *                 at_end)
+{
+    Vec2 const p1{p.x1[j], p.y1[j]};
+    Vec2 const p2{p.x2[j], p.y2[j]};
+
+    for (std::size_t i = begin; i < end; ++i) {
+        // The principal value on its own panel no longer vanishes and is
+        // taken from the exact coefficients
+        LinearPanelVelocity const v = linear_panel_velocity(
+            p1,
+            p2,
+            {p.xc[i], p.yc[i]},
+            i == j ? Quadrature::ANALYTIC : Quadrature::RIEMANN);
+        at_start[i - begin] =
+            static_cast<T>(v.start.x * p.nx[i] + v.start.y * p.ny[i]);
+        at_end[i - begin] =
+            static_cast<T>(v.end.x * p.nx[i] + v.end.y * p.ny[i]);
+    }
+}
+
+template<typename T>
+void
+linear_column(PanelArrays const & p,
+              std::size_t         j,
+              std::size_t         begin,
+              std::size_t         end,
+              Quadrature          quadrature,
+              T *                 at_start,
+              T *                 at_end)
+{
+    switch (quadrature) {
+        case Quadrature::ANALYTIC:
+            analytic_linear_column(p, j, begin, end, at_start, at_end);
+            break;
+        case Quadrature::RIEMANN:
+            riemann_linear_column(p, j, begin, end, at_start, at_end);
+            break;
+    }
+}
+
+template<typename T>
+void
+assemble_columns(PanelArrays const &            panels,
+                 std::size_t                    row_begin,
+                 std::size_t                    row_end,
+                 std::size_t                    col_begin,
+                 std::size_t                    col_end,
+                 Quadrature                     quadrature,
+                 Formulation                    formulation,
+                 Eigen::Ref<InfluenceMatrix<T>> out)
+{
+    assert(static_cast<std::size_t>(out.rows()) == row_end - row_begin);
+    assert(static_cast<std::size_t>(out.cols()) == col_end - col_begin);
+
+    auto const in_block = [col_begin, col_end](std::size_t j) {
+        return j >= col_begin && j < col_end;
+    };
+
+    for (std::size_t begin = row_begin; begin < row_end;
+         begin += G_BLOCK_ROWS) {
+        std::size_t const end = std::min(begin + G_BLOCK_ROWS, row_end);
+        std::size_t const rows = end - begin;
+
+        if (formulation == Formulation::LINEAR) {
+            out.middleRows(static_cast<Eigen::Index>(begin - row_begin),
+                          static_cast<Eigen::Index>(rows))
+                .setZero();
+        }
+
+        Scratch<T> at_start;
+        Scratch<T> at_end;
+        for (std::size_t j = col_begin; j < col_end; ++j) {
+            T * column = &out(begin - row_begin, j - col_begin);
+
+            if (formulation == Formulation::CONSTANT) {
+                switch (quadrature) {
+                    case Quadrature::ANALYTIC:
+                        analytic_column(panels, j, begin, end, column);
+                        break;
+                    case Quadrature::RIEMANN:
+                        riemann_column(panels, j, begin, end, column);
+                        break;
+                }
+                continue;
+            }
+
+            // Both halves of panel j go to the columns of its nodes, so
+            // every panel of the block is integrated once
+            linear_column(panels,
+                          j,
+                          begin,
+                          end,
+                          quadrature,
+                          at_start.data(),
+                          at_end.data());
+
+            for (std::size_t k = 0; k < rows; ++k) {
+                column[k] += at_start[k];
+            }
+            std::size_t const next = panels.nextPanel(j);
+            if (in_block(next)) {
+                T * next_column = &out(begin - row_begin, next - col_begin);
+                for (std::size_t k = 0; k < rows; ++k) {
+                    next_column[k] += at_end[k];
+                }
+            }
+
+            // The falling half of a panel outside the block
+            std::size_t const previous = panels.previousPanel(j);
+            if (!in_block(previous)) {
+                linear_column(panels,
+                              previous,
+                              begin,
+                              end,
+                              quadrature,
+                              at_start.data(),
+                              at_end.data());
+                for (std::size_t k = 0; k < rows; ++k) {
+                    column[k] += at_end[k];
+                }
+            }
+        }
+    }
+}
+
+// Rows [begin, end) of the block of body pair (row_body, col_body)
+struct Tile {
+    std::size_t row_body{};
+    std::size_t col_body{};
+    std::size_t begin{};
+    std::size_t end{};
+};
+
+// Row blocks of the tangency rows of the given body pairs
+std::vector<Tile>
+make_tiles(PanelArrays const &                                    panels,
+           std::vector<std::pair<std::size_t, std::size_t>> const & pairs)
+{
+    std::vector<Tile> tiles;
+    for (auto const & [row_body, col_body] : pairs) {
+        std::size_t const kutta = panels.kuttaRow(row_body);
+
+        // Both sides of the Kutta row
+        for (auto const & [first, last] :
+             {std::pair{panels.body_starts[row_body], kutta},
+              std::pair{kutta + 1, panels.body_starts[row_body + 1]}}) {
+            for (std::size_t begin = first; begin < last;
+                 begin += G_BLOCK_ROWS) {
+                tiles.push_back({row_body,
+                                 col_body,
+                                 begin,
+                                 std::min(begin + G_BLOCK_ROWS, last)});
+            }
+        }
+    }
+
+    return tiles;
+}
+
+// Skips the remaining tiles once *cancel is set
+template<typename T>
+void
+assemble_tiles(PanelArrays const &       panels,
+               std::vector<Tile> const & tiles,
+               Quadrature                quadrature,
+               Formulation               formulation,
+               ThreadPool *              pool,
+               InfluenceMatrix<T> &      a,
+               std::atomic<bool> const * cancel = nullptr)
+{
+    parallel_for(
+        pool,
+        tiles.size(),
+        1,
+        [&panels, &tiles, quadrature, formulation, &a, cancel](
+            std::size_t first, std::size_t last) {
+            for (std::size_t t = first; t < last; ++t) {
+                if (cancel != nullptr && *cancel) {
+                    return;
+                }
+
+                Tile const &      tile = tiles[t];
+                std::size_t const col_begin = panels.body_starts[tile.col_body];
+                std::size_t const col_end =
+                    panels.body_starts[tile.col_body + 1];
+
+                assemble_columns<T>(panels,
+                                    tile.begin,
+                                    tile.end,
+                                    col_begin,
+                                    col_end,
+                                    quadrature,
+                                    formulation,
+                                    a.block(tile.begin,
+                                            col_begin,
+                                            tile.end - tile.begin,
+                                            col_end - col_begin));
+            }
+        });
+}
+
+// Replaces the kuttaRow of every body with its Kutta condition, equal and
+// opposite strengths on the two panels at the trailing edge. A linear sheet
+// is continuous there, and a finite velocity at the edge leaves it zero
+// strength, a stagnation point.
+template<typename T>
+void
+set_kutta_rows(PanelArrays const &  panels,
+               Formulation          formulation,
+               InfluenceMatrix<T> & a)
+{
+    for (std::size_t k = 0; k < panels.bodyCount(); ++k) {
+        std::size_t const row = panels.kuttaRow(k);
+
+        a.row(row).setZero();
+        a(row, panels.body_starts[k]) = T{1};
+        if (formulation == Formulation::CONSTANT) {
+            a(row, panels.body_starts[k + 1] - 1) = T{1};
+        }
+    }
+}
+
+void
+resize_panel_arrays(PanelArrays & p, std::size_t n_panels)
+{
+    for (std::vector<double> * v : {&p.x1,
+                                    &p.y1,
+                                    &p.x2,
+                                    &p.y2,
+                                    &p.xc,
+                                    &p.yc,
+                                    &p.tx,
+                                    &p.ty,
+                                    &p.nx,
+                                    &p.ny,
+                                    &p.len}) {
+        v->resize(n_panels);
+    }
+}
+
+} // namespace
+
+PanelArrays
+make_panel_arrays(Body const & body, Formulation formulation)
+{
+    std::size_t const n_panels = body.panelCount();
+
+    PanelArrays p{};
+    resize_panel_arrays(p, n_panels);
+    p.body_starts = {0, n_panels};
+    p.kutta_rows = {body.kuttaPanel(formulation)};
+
+    for (std::size_t i = 0; i < n_panels; ++i) {
+        set_panel(p, i, body.panelStart(i), body.panelEnd(i));
+    }
+
+    return p;
+}
+
+PanelArrays
+make_panel_arrays(Scene const & scene, Formulation formulation)
+{
+    PanelArrays p{};
+    resize_panel_arrays(p, scene.panelCount());
+
+    std::size_t offset = 0;
+    for (Body const & body : scene.bodies) {
+        p.body_starts.push_back(offset);
+        p.kutta_rows.push_back(offset + body.kuttaPanel(formulation));
+        for (std::size_t i = 0; i < body.panelCount(); ++i) {
+            set_panel(p, offset + i, body.panelStart(i), body.panelEnd(i));
+        }
+        offset += body.panelCount();
+    }
+    p.body_starts.push_back(offset);
+
+    return p;
+}
+
+void
+set_panel(PanelArrays & panels,
+          std::size_t   i,
+          Vec2 const &  p1,
+          Vec2 const &  p2)
+{
+    constexpr double half = 0.5;
+    Vec2 const       diff = p2 - p1;
+    double const     len = length(diff);
+
+    panels.x1[i] = p1.x;
+    panels.y1[i] = p1.y;
+    panels.x2[i] = p2.x;
+    panels.y2[i] = p2.y;
+    panels.xc[i] = half * (p1.x + p2.x);
+    panels.yc[i] = half * (p1.y + p2.y);
+    panels.tx[i] = diff.x / len;
+    panels.ty[i] = diff.y / len;
+    panels.nx[i] = panels.ty[i];
+    panels.ny[i] = -panels.tx[i];
+    panels.len[i] = len;
+}
+
+void
+assemble_block(PanelArrays const &         panels,
+               std::size_t                 row_begin,
+               std::size_t                 row_end,
+               std::size_t                 col_begin,
+               std::size_t                 col_end,
+               Quadrature                  quadrature,
+               Eigen::Ref<Eigen::MatrixXd> out,
+               Formulation                 formulation)
+{
+    assemble_columns<double>(panels,
+                          row_begin,
+                          row_end,
+                          col_begin,
+                          col_end,
+                          quadrature,
+                          formulation,
+                          out);
+}
+
+void
+assemble_block(PanelArrays const &         panels,
+               std::size_t                 row_begin,
+               std::size_t                 row_end,
+               std::size_t                 col_begin,
+               std::size_t                 col_end,
+               Quadrature                  quadrature,
+               Eigen::Ref<Eigen::MatrixXf> out,
+               Formulation                 formulation)
+{
+    assemble_columns<float>(panels,
+                          row_begin,
+                          row_end,
+                          col_begin,
+                          col_end,
+                          quadrature,
+                          formulation,
+                          out);
+}
+
+template<typename T>
+InfluenceMatrix<T>
+assemble_influence(PanelArrays const & panels,
+                   Quadrature          quadrature,
+                   ThreadPool *        pool,
+                   Formulation         formulation)
+{
+    ScopedTimer const timer{"assembly"};
+
+    std::size_t const n_panels = panels.size();
+    assert(n_panels > 1);
+
+    InfluenceMatrix<T> a(n_panels, n_panels);
+
+    // Tangency rows of every body pair, all control points but the Kutta
+    // rows
+    std::vector<std::pair<std::size_t, std::size_t>> pairs;
+    for (std::size_t i = 0; i < panels.bodyCount(); ++i) {
+        for (std::size_t j = 0; j < panels.bodyCount(); ++j) {
+            pairs.emplace_back(i, j);
+        }
+    }
+    assemble_tiles(
+        panels, make_tiles(panels, pairs), quadrature, formulation, pool, a);
+
+    set_kutta_rows(panels, formulation, a);
+
+    return a;
+}
+
+template InfluenceMatrix<double>
+assemble_influence<double>(PanelArrays const &,
+                           Quadrature,
+                           ThreadPool *,
+                           Formulation);
+template InfluenceMatrix<float>
+assemble_influence<float>(PanelArrays const &,
+                          Quadrature,
+                          ThreadPool *,
+                          Formulation);
+
+Eigen::VectorXd
+influence_residual(PanelArrays const &     panels,
+                   Eigen::VectorXd const & x,
+                   Eigen::VectorXd const & b,
+                   Quadrature              quadrature,
+                   ThreadPool *            pool,
+                   Formulation             formulation)
+{
+    ScopedTimer const timer{"residual"};
+
+    std::size_t const n_panels = panels.size();
+    assert(static_cast<std::size_t>(x.size()) == n_panels);
+    assert(static_cast<std::size_t>(b.size()) == n_panels);
+
+    // Tangency rows of every body against all columns; each tile owns its
+    // rows of the residual
+    std::vector<std::pair<std::size_t, std::size_t>> pairs;
+    for (std::size_t k = 0; k < panels.bodyCount(); ++k) {
+        pairs.emplace_back(k, 0);
+    }
+    std::vector<Tile> const tiles = make_tiles(panels, pairs);
+
+    Eigen::VectorXd r = b;
+
+    parallel_for(
+        pool,
+        tiles.size(),
+        1,
+        [&panels, &tiles, &x, quadrature, formulation, n_panels, &r](
+            std::size_t first, std::size_t last) {
+            Eigen::MatrixXd scratch(G_BLOCK_ROWS, G_RESIDUAL_COLS);
+
+            for (std::size_t t = first; t < last; ++t) {
+                Tile const & tile = tiles[t];
+                auto const   rows =
+                    static_cast<Eigen::Index>(tile.end - tile.begin);
+
+                for (std::size_t col = 0; col < n_panels;
+                     col += G_RESIDUAL_COLS) {
+                    std::size_t const col_end =
+                        std::min(col + G_RESIDUAL_COLS, n_panels);
+                    auto const cols = static_cast<Eigen::Index>(col_end - col);
+
+                    auto block = scratch.topLeftCorner(rows, cols);
+                    assemble_columns<double>(panels,
+                                             tile.begin,
+                                             tile.end,
+                                             col,
+                                             col_end,
+                                             quadrature,
+                                             formulation,
+                                             block);
+
+                    r.segment(static_cast<Eigen::Index>(tile.begin), rows)
+                        .noalias() -=
+                        block * x.segment(static_cast<Eigen::Index>(col), cols);
+                }
+            }
+        });
+
+    for (std::size_t k = 0; k < panels.bodyCount(); ++k) {
+        std::size_t const row = panels.kuttaRow(k);
+        r(row) -= x(panels.body_starts[k]);
+        if (formulation == Formulation::CONSTANT) {
+            r(row) -= x(panels.body_starts[k + 1] - 1);
+        }
+    }
+
+    return r;
+}
+
+SceneAssembler::SceneAssembler(Quadrature   quadrature,
+                               ThreadPool * pool,
+                               Formulation  formulation)
+    : quadrature_{quadrature}, pool_{pool}, formulation_{formulation}
+{
+}
+
+Eigen::MatrixXd const &
+SceneAssembler::assemble(Scene const &             scene,
+                         std::atomic<bool> const * cancel)
+{
+    ScopedTimer const timer{"assembly"};
+
+    PanelArrays const panels = make_panel_arrays(scene, formulation_);
+    std::size_t const n_bodies = scene.bodies.size();
+    auto const        n_panels = static_cast<Eigen::Index>(panels.size());
+
+    // Bodies are matched by position in the scene
+    std::vector<bool> unchanged(n_bodies, false);
+    for (std::size_t k = 0; k < std::min(n_bodies, bodies_.size()); ++k) {
+        // A moved Kutta row would leave a tangency row behind in the block
+        unchanged[k] = scene.bodies[k].nodes == bodies_[k].nodes &&
+                       scene.bodies[k].kuttaPanel(formulation_) ==
+                           bodies_[k].kuttaPanel(formulation_);
+    }
+
+    Eigen::MatrixXd a(n_panels, n_panels);
+
+    std::vector<std::pair<std::size_t, std::size_t>> pairs;
+    reused_blocks_ = 0;
+    for (std::size_t i = 0; i < n_bodies; ++i) {
+        for (std::size_t j = 0; j < n_bodies; ++j) {
+            if (!unchanged[i] || !unchanged[j]) {
+                pairs.emplace_back(i, j);
+                continue;
+            }
+
+            // The Kutta rows are rewritten below
+            auto const rows =
+                static_cast<Eigen::Index>(scene.bodies[i].panelCount());
+            auto const cols =
+                static_cast<Eigen::Index>(scene.bodies[j].panelCount());
+            a.block(panels.body_starts[i], panels.body_starts[j], rows, cols) =
+                a_.block(body_starts_[i], body_starts_[j], rows, cols);
+            ++reused_blocks_;
+        }
+    }
+    assemble_tiles(panels,
+                   make_tiles(panels, pairs),
+                   quadrature_,
+                   formulation_,
+                   pool_,
+                   a,
+                   cancel);
+    if (cancel != nullptr && *cancel) {
+        return a_;
+    }
+
+    set_kutta_rows(panels, formulation_, a);
+
+    bodies_ = scene.bodies;
+    body_starts_ = panels.body_starts;
+    a_ = std::move(a);
+
+    return a_;
+}
+
+} // namespace vortisim
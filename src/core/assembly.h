@@ -0,0 +1,209 @@
+#ifndef CORE_ASSEMBLY_H
+#define CORE_ASSEMBLY_H
+
+#include "core/body.h"
+#include "core/panel.h"
+#include "core/scene.h"
+#include "core/threadpool.h"
+
+#include <Eigen/Dense>
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+namespace vortisim {
+
+// Influence matrix stored in double, or in float for mixed precision
+template<typename T>
+using InfluenceMatrix = Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic>;
+
+// Panel geometry copied into contiguous structure-of-arrays buffers, so that
+// the assembly loops stream through memory instead of chasing references.
+struct PanelArrays {
+    // Endpoints
+    std::vector<double> x1{};
+    std::vector<double> y1{};
+    std::vector<double> x2{};
+    std::vector<double> y2{};
+
+    // Control points at the panel midpoints
+    std::vector<double> xc{};
+    std::vector<double> yc{};
+
+    // Unit tangents, outward normals and lengths
+    std::vector<double> tx{};
+    std::vector<double> ty{};
+    std::vector<double> nx{};
+    std::vector<double> ny{};
+    std::vector<double> len{};
+
+    // First panel of every body, followed by the total panel count
+    std::vector<std::size_t> body_starts{};
+
+    // Row of the Kutta condition of every body, that of its
+    // Body::kuttaPanel
+    std::vector<std::size_t> kutta_rows{};
+
+    std::size_t
+    size() const
+    {
+        return len.size();
+    }
+
+    std::size_t
+    bodyCount() const
+    {
+        return body_starts.size() - 1;
+    }
+
+    std::size_t
+    kuttaRow(std::size_t k) const
+    {
+        return kutta_rows[k];
+    }
+
+    // Body of panel i
+    std::size_t
+    bodyOf(std::size_t i) const
+    {
+        auto const it =
+            std::upper_bound(body_starts.begin(), body_starts.end(), i);
+        return static_cast<std::size_t>(it - body_starts.begin()) - 1;
+    }
+
+    // Neighbours of panel i around its closed body
+    std::size_t
+    nextPanel(std::size_t i) const
+    {
+        std::size_t const k = bodyOf(i);
+        return i + 1 == body_starts[k + 1] ? body_starts[k] : i + 1;
+    }
+
+    std::size_t
+    previousPanel(std::size_t i) const
+    {
+        std::size_t const k = bodyOf(i);
+        return i == body_starts[k] ? body_starts[k + 1] - 1 : i - 1;
+    }
+};
+
+// The Kutta rows are those of the formulation the arrays are assembled with
+PanelArrays
+make_panel_arrays(Body const & body,
+                  Formulation  formulation = Formulation::CONSTANT);
+
+PanelArrays
+make_panel_arrays(Scene const & scene,
+                  Formulation   formulation = Formulation::CONSTANT);
+
+// Overwrites panel i of already sized arrays
+void
+set_panel(PanelArrays & panels,
+          std::size_t   i,
+          Vec2 const &  p1,
+          Vec2 const &  p2);
+
+// Fills out with the normal velocity influence of the unknowns
+// [col_begin, col_end) on the control points [row_begin, row_end). Rows are
+// processed in blocks; for every source panel the inner loop runs down the
+// contiguous column segment of the block. With the linear formulation
+// unknown j is the strength at the start node of panel j, and its column
+// gathers the rising half of panel j and the falling half of the panel
+// before it.
+void
+assemble_block(PanelArrays const &         panels,
+               std::size_t                 row_begin,
+               std::size_t                 row_end,
+               std::size_t                 col_begin,
+               std::size_t                 col_end,
+               Quadrature                  quadrature,
+               Eigen::Ref<Eigen::MatrixXd> out,
+               Formulation                 formulation = Formulation::CONSTANT);
+
+// Float coefficients, twice as many per vector register
+void
+assemble_block(PanelArrays const &         panels,
+               std::size_t                 row_begin,
+               std::size_t                 row_end,
+               std::size_t                 col_begin,
+               std::size_t                 col_end,
+               Quadrature                  quadrature,
+               Eigen::Ref<Eigen::MatrixXf> out,
+               Formulation                 formulation = Formulation::CONSTANT);
+
+// Splits every body-pair block into row blocks and spreads them across the
+// pool. The kuttaRow of every body holds its Kutta condition. Instantiated
+// for double and float.
+template<typename T = double>
+InfluenceMatrix<T>
+assemble_influence(PanelArrays const & panels,
+                   Quadrature          quadrature = Quadrature::ANALYTIC,
+                   ThreadPool *        pool = nullptr,
+                   Formulation         formulation = Formulation::CONSTANT);
+
+extern template InfluenceMatrix<double>
+assemble_influence<double>(PanelArrays const &,
+                           Quadrature,
+                           ThreadPool *,
+                           Formulation);
+extern template InfluenceMatrix<float>
+assemble_influence<float>(PanelArrays const &,
+                          Quadrature,
+                          ThreadPool *,
+                          Formulation);
+
+// b - A x in double, with the coefficients of A assembled block by block
+// and never stored
+Eigen::VectorXd
+influence_residual(PanelArrays const &     panels,
+                   Eigen::VectorXd const & x,
+                   Eigen::VectorXd const & b,
+                   Quadrature              quadrature = Quadrature::ANALYTIC,
+                   ThreadPool *            pool = nullptr,
+                   Formulation             formulation = Formulation::CONSTANT);
+
+// Influence matrix of a scene kept between calls. Body-pair blocks are only
+// reassembled when one of their two bodies changed, so moving or adding one
+// body leaves the self-blocks and mutual blocks of the others untouched.
+class SceneAssembler {
+public:
+    explicit SceneAssembler(Quadrature   quadrature = Quadrature::ANALYTIC,
+                            ThreadPool * pool = nullptr,
+                            Formulation  formulation = Formulation::CONSTANT);
+
+    // Stops between row blocks once *cancel is set, and then keeps and
+    // returns the previous matrix
+    Eigen::MatrixXd const &
+    assemble(Scene const &             scene,
+             std::atomic<bool> const * cancel = nullptr);
+
+    Eigen::MatrixXd const &
+    matrix() const
+    {
+        return a_;
+    }
+
+    // Blocks copied over from the previous matrix by the last assemble()
+    std::size_t
+    reusedBlocks() const
+    {
+        return reused_blocks_;
+    }
+
+private:
+    Quadrature   quadrature_;
+    ThreadPool * pool_;
+    Formulation  formulation_;
+
+    // Bodies and layout of a_
+    std::vector<Body>        bodies_{};
+    std::vector<std::size_t> body_starts_{};
+    Eigen::MatrixXd          a_{};
+
+    std::size_t reused_blocks_{};
+};
+
+} // namespace vortisim
+
+#endif // CORE_ASSEMBLY_H
@@ -0,0 +1,164 @@
+#include "core/asyncsolver.h"
+
+#include "core/profiler.h"
+
+#include <utility>
+
+namespace vortisim {
+
+AsyncSolver::AsyncSolver(ThreadPool * pool, std::function<void()> ready)
+    : pool_{pool},
+      ready_{std::move(ready)},
+      assembler_{quadrature_, pool_, formulation_},
+      worker_{[this]() { work(); }}
+{
+}
+
+AsyncSolver::~AsyncSolver()
+{
+    {
+        std::lock_guard<std::mutex> lock{mutex_};
+        stop_ = true;
+        cancel_ = true;
+    }
+    cv_.notify_one();
+
+    worker_.join();
+}
+
+std::uint64_t
+AsyncSolver::submit(Scene                       scene,
+                    Vec2 const &                vinf,
+                    Quadrature                  quadrature,
+                    Formulation                 formulation,
+                    std::optional<AdaptOptions> adapt)
+{
+    std::uint64_t generation = 0;
+    {
+        std::lock_guard<std::mutex> lock{mutex_};
+
+        generation = ++generation_;
+        request_ = Request{generation,
+                           std::move(scene),
+                           vinf,
+                           quadrature,
+                           formulation,
+                           std::move(adapt)};
+        if (running_) {
+            cancel_ = true;
+        }
+    }
+    cv_.notify_one();
+
+    return generation;
+}
+
+std::optional<AsyncSolver::Result>
+AsyncSolver::take()
+{
+    std::lock_guard<std::mutex> lock{mutex_};
+
+    if (!fresh_) {
+        return std::nullopt;
+    }
+    fresh_ = false;
+
+    return std::move(results_[1 - back_]);
+}
+
+void
+AsyncSolver::work()
+{
+    std::unique_lock<std::mutex> lock{mutex_};
+
+    while (true) {
+        cv_.wait(lock, [this]() { return stop_ || request_.has_value(); });
+        if (stop_) {
+            return;
+        }
+
+        Request request = std::move(*request_);
+        request_.reset();
+        cancel_ = false;
+        running_ = true;
+
+        // The back buffer is never touched by take()
+        Result & result = results_[back_];
+        lock.unlock();
+
+        bool const done = solve(std::move(request), result);
+
+        lock.lock();
+        running_ = false;
+
+        // A solve that finished after being superseded is dropped as well
+        bool const publish = done && !request_ && !stop_;
+        if (publish) {
+            back_ = 1 - back_;
+            fresh_ = true;
+        }
+
+        if (publish && ready_) {
+            lock.unlock();
+            ready_();
+            lock.lock();
+        }
+    }
+}
+
+bool
+AsyncSolver::solve(Request request, Result & result)
+{
+    ScopedTimer const timer{"async solve"};
+
+    if (request.quadrature != quadrature_ ||
+        request.formulation != formulation_) {
+        quadrature_ = request.quadrature;
+        formulation_ = request.formulation;
+        assembler_ = SceneAssembler{quadrature_, pool_, formulation_};
+    }
+
+    result.adapt_steps.clear();
+    if (request.adapt) {
+        AdaptOptions options = *request.adapt;
+        options.solver.quadrature = quadrature_;
+        options.solver.formulation = formulation_;
+        options.solver.pool = pool_;
+
+        // Only the adapted scene is kept, its final system is assembled
+        // again below for further edits
+        AdaptResult adapted =
+            adapt_scene(request.scene, request.vinf, options);
+        if (cancel_) {
+            return false;
+        }
+
+        request.scene = std::move(adapted.scene);
+        result.adapt_steps = std::move(adapted.steps);
+    }
+
+    // Blocks of the bodies that did not change are reused
+    Eigen::MatrixXd influence = assembler_.assemble(request.scene, &cancel_);
+    if (cancel_) {
+        return false;
+    }
+
+    auto solver = std::make_unique<IncrementalSolver>(std::move(request.scene),
+                                                      std::move(influence),
+                                                      quadrature_,
+                                                      pool_,
+                                                      formulation_);
+    if (cancel_) {
+        return false;
+    }
+
+    result.generation = request.generation;
+    result.quadrature = quadrature_;
+    result.formulation = formulation_;
+    result.solution = solver->solve(request.vinf);
+    result.solver = std::move(solver);
+
+    return true;
+}
+
+} // namespace vortisim
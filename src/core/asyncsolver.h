@@ -0,0 +1,122 @@
+#ifndef CORE_ASYNCSOLVER_H
+#define CORE_ASYNCSOLVER_H
+
+#include "core/assembly.h"
+#include "core/incremental.h"
+#include "core/repanel.h"
+#include "core/scene.h"
+#include "core/solver.h"
+#include "core/threadpool.h"
+#include "core/vec2.h"
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+namespace vortisim {
+
+// Solves scene snapshots on a worker thread. A newer request supersedes a
+// queued one and cancels the running one between the row blocks of its
+// assembly and before factorization and solve. Finished results go to the
+// back of a double buffer and are swapped to the front, where take() picks
+// them up without waiting for a solve in progress.
+class AsyncSolver {
+public:
+    struct Result {
+        // Of the request, increasing with every submit()
+        std::uint64_t generation{};
+        Quadrature    quadrature{Quadrature::ANALYTIC};
+        Formulation   formulation{Formulation::CONSTANT};
+
+        // Factorized system of the snapshot, for further incremental edits
+        std::unique_ptr<IncrementalSolver> solver{};
+        Solution                           solution{};
+
+        // Of the adaptive repaneling, empty without it
+        std::vector<AdaptStep> adapt_steps{};
+    };
+
+    // ready is called on the worker thread whenever a result was published.
+    // Loops on the pool are serialized with those of other threads, so a
+    // thread that must not wait for a solve uses a pool of its own.
+    explicit AsyncSolver(ThreadPool *          pool = nullptr,
+                         std::function<void()> ready = {});
+
+    AsyncSolver(AsyncSolver const &) = delete;
+    AsyncSolver(AsyncSolver &&) noexcept = delete;
+
+    // Cancels the running solve and waits for it to stop
+    ~AsyncSolver();
+
+    AsyncSolver &
+    operator=(AsyncSolver const &) = delete;
+    AsyncSolver &
+    operator=(AsyncSolver &&) noexcept = delete;
+
+    // Generation of the request. With adapt, the scene is repaneled by
+    // adapt_scene first and the solver holds the adapted one; its
+    // quadrature, formulation and pool are those of the request.
+    std::uint64_t
+    submit(Scene                       scene,
+           Vec2 const &                vinf,
+           Quadrature                  quadrature,
+           Formulation                 formulation = Formulation::CONSTANT,
+           std::optional<AdaptOptions> adapt = std::nullopt);
+
+    // The latest result not taken yet
+    std::optional<Result>
+    take();
+
+private:
+    struct Request {
+        std::uint64_t generation{};
+        Scene         scene{};
+        Vec2          vinf{};
+        Quadrature    quadrature{Quadrature::ANALYTIC};
+        Formulation   formulation{Formulation::CONSTANT};
+
+        std::optional<AdaptOptions> adapt{};
+    };
+
+    void
+    work();
+
+    // False when cancelled
+    bool
+    solve(Request request, Result & result);
+
+    ThreadPool *          pool_;
+    std::function<void()> ready_;
+
+    // Used by the worker only; reuses the blocks of unchanged bodies
+    Quadrature     quadrature_{Quadrature::ANALYTIC};
+    Formulation    formulation_{Formulation::CONSTANT};
+    SceneAssembler assembler_;
+
+    std::mutex              mutex_{};
+    std::condition_variable cv_{};
+
+    std::optional<Request> request_{};
+    std::uint64_t          generation_{};
+    bool                   running_{false};
+    bool                   stop_{false};
+    std::atomic<bool>      cancel_{false};
+
+    // Written by the worker at back_, read by take() at 1 - back_
+    std::array<Result, 2> results_{};
+    std::size_t           back_{0};
+    bool                  fresh_{false};
+
+    std::thread worker_;
+};
+
+} // namespace vortisim
+
+#endif // CORE_ASYNCSOLVER_H
@@ -0,0 +1,78 @@
+#ifndef CORE_BODY_H
+#define CORE_BODY_H
+
+#include "core/panel.h"
+#include "core/vec2.h"
+
+#include <cstddef>
+#include <vector>
+
+namespace vortisim {
+
+// Panel whose flow tangency condition gives way to the Kutta condition of
+// constant panels. Linear panels always use OPPOSITE: their strengths are
+// already tied together at the trailing edge node, and dropping the tangency
+// of a panel next to it breaks the symmetry of the solution.
+enum class KuttaRow
+{
+    // The last one, which closes the loop at the trailing edge node 0
+    LAST,
+    // The one opposite the trailing edge node 0. Its condition follows from
+    // the others, while dropping the one of a trailing edge panel leaves the
+    // odd-even oscillation of the strengths free to grow there. Only
+    // meaningful when node 0 really is the trailing edge, as after
+    // repaneling.
+    OPPOSITE
+};
+
+// Closed polygonal outline. Panel i runs from nodes[i] to nodes[i + 1], the
+// last panel closes the loop back to nodes[0].
+struct Body {
+    std::vector<Vec2> nodes{};
+    KuttaRow          kutta_row{KuttaRow::LAST};
+
+    std::size_t
+    panelCount() const
+    {
+        return nodes.size();
+    }
+
+    Vec2 const &
+    panelStart(std::size_t i) const
+    {
+        return nodes[i];
+    }
+
+    Vec2 const &
+    panelEnd(std::size_t i) const
+    {
+        return nodes[(i + 1) % nodes.size()];
+    }
+
+    Vec2
+    panelCenter(std::size_t i) const
+    {
+        constexpr double half = 0.5;
+        return half * (panelStart(i) + panelEnd(i));
+    }
+
+    // Panel whose flow tangency condition gives way to the Kutta condition
+    std::size_t
+    kuttaPanel(Formulation formulation) const
+    {
+        bool const opposite = formulation == Formulation::LINEAR ||
+                              kutta_row == KuttaRow::OPPOSITE;
+        return opposite ? nodes.size() / 2 : nodes.size() - 1;
+    }
+
+    Vec2
+    panelNormal(std::size_t i) const
+    {
+        Vec2 const diff = panelEnd(i) - panelStart(i);
+        return (1.0 / length(diff)) * right_normal(diff);
+    }
+};
+
+} // namespace vortisim
+
+#endif // CORE_BODY_H
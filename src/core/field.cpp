@@ -0,0 +1,72 @@
+#include "core/field.h"
+
+#include <cassert>
+
+namespace vortisim {
+
+namespace {
+
+// Induced by the panels of body, whose strengths start at offset
+Vec2
+body_velocity(Body const &     body,
+              Solution const & solution,
+              std::size_t      offset,
+              Vec2 const &     p,
+              Quadrature       quadrature)
+{
+    std::size_t const n_panels = body.panelCount();
+    double const *    strengths = solution.strengths.data() + offset;
+
+    Vec2 v{};
+    for (std::size_t i = 0; i < n_panels; ++i) {
+        if (solution.formulation == Formulation::CONSTANT) {
+            v += strengths[i] *
+                 panel_velocity(
+                     body.panelStart(i), body.panelEnd(i), p, quadrature);
+            continue;
+        }
+
+        // The end node strength is that of the next panel
+        LinearPanelVelocity const linear = linear_panel_velocity(
+            body.panelStart(i), body.panelEnd(i), p, quadrature);
+        v += strengths[i] * linear.start;
+        v += strengths[(i + 1) % n_panels] * linear.end;
+    }
+
+    return v;
+}
+
+} // namespace
+
+Vec2
+velocity(Body const &     body,
+         Solution const & solution,
+         Vec2 const &     vinf,
+         Vec2 const &     p,
+         Quadrature       quadrature)
+{
+    assert(solution.strengths.size() == body.panelCount());
+
+    return vinf + body_velocity(body, solution, 0, p, quadrature);
+}
+
+Vec2
+velocity(Scene const &    scene,
+         Solution const & solution,
+         Vec2 const &     vinf,
+         Vec2 const &     p,
+         Quadrature       quadrature)
+{
+    assert(solution.strengths.size() == scene.panelCount());
+
+    Vec2        total_flow = vinf;
+    std::size_t offset = 0;
+    for (Body const & body : scene.bodies) {
+        total_flow += body_velocity(body, solution, offset, p, quadrature);
+        offset += body.panelCount();
+    }
+
+    return total_flow;
+}
+
+} // namespace vortisim
@@ -0,0 +1,30 @@
+#ifndef CORE_FIELD_H
+#define CORE_FIELD_H
+
+#include "core/body.h"
+#include "core/panel.h"
+#include "core/scene.h"
+#include "core/solver.h"
+#include "core/vec2.h"
+
+namespace vortisim {
+
+// Total flow velocity at p: freestream plus the contribution of every panel,
+// in the formulation of the solution
+Vec2
+velocity(Body const &     body,
+         Solution const & solution,
+         Vec2 const &     vinf,
+         Vec2 const &     p,
+         Quadrature       quadrature = Quadrature::ANALYTIC);
+
+Vec2
+velocity(Scene const &    scene,
+         Solution const & solution,
+         Vec2 const &     vinf,
+         Vec2 const &     p,
+         Quadrature       quadrature = Quadrature::ANALYTIC);
+
+} // namespace vortisim
+
+#endif // CORE_FIELD_H
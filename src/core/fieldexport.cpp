@@ -0,0 +1,150 @@
+#include "core/fieldexport.h"
+
+#include "core/mapping.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace vortisim {
+
+namespace {
+
+// (u, v) per grid point
+constexpr std::size_t G_COMPONENTS = 2;
+
+bool
+write_all(int fd, void const * data, std::size_t size, off_t offset)
+{
+    auto const * bytes = static_cast<char const *>(data);
+    while (size > 0) {
+        ssize_t const written = ::pwrite(fd, bytes, size, offset);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+
+        bytes += written;
+        size -= static_cast<std::size_t>(written);
+        offset += written;
+    }
+
+    return true;
+}
+
+} // namespace
+
+Grid
+uniform_grid(Vec2 const & lo, Vec2 const & hi, std::size_t nx, std::size_t ny)
+{
+    auto axis = [](double a, double b, std::size_t n) {
+        std::vector<double> v(n, a);
+        for (std::size_t i = 1; i < n; ++i) {
+            v[i] = a + (b - a) * static_cast<double>(i) /
+                           static_cast<double>(n - 1);
+        }
+        return v;
+    };
+
+    return {axis(lo.x, hi.x, nx), axis(lo.y, hi.y, ny)};
+}
+
+bool
+export_field(Scene const &                 scene,
+             Solution const &              solution,
+             Vec2 const &                  vinf,
+             Grid const &                  grid,
+             std::filesystem::path const & path,
+             FieldExportOptions const &    options,
+             ThreadPool *                  pool)
+{
+    assert(solution.strengths.size() == scene.panelCount());
+    assert(options.tile_rows > 0);
+
+    std::size_t const nx = grid.x.size();
+    std::size_t const ny = grid.y.size();
+
+    FlowField const field{scene, solution, vinf, options.flow};
+
+    FileDescriptor const fd{
+        ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644)};
+    if (fd.get() < 0) {
+        return false;
+    }
+
+    FieldHeader header{};
+    header.nx = nx;
+    header.ny = ny;
+
+    auto const        header_size = static_cast<off_t>(sizeof(FieldHeader));
+    auto const        x_offset = header_size;
+    auto const y_offset = x_offset + static_cast<off_t>(nx * sizeof(double));
+    auto const data_offset =
+        y_offset + static_cast<off_t>(ny * sizeof(double));
+    std::size_t const row_bytes = nx * G_COMPONENTS * sizeof(double);
+    auto const        file_size =
+        data_offset + static_cast<off_t>(ny * row_bytes);
+
+    if (::ftruncate(fd.get(), file_size) != 0 ||
+        !write_all(fd.get(), &header, sizeof(header), 0) ||
+        !write_all(fd.get(), grid.x.data(), nx * sizeof(double), x_offset) ||
+        !write_all(fd.get(), grid.y.data(), ny * sizeof(double), y_offset)) {
+        return false;
+    }
+
+    if (nx == 0 || ny == 0) {
+        return true;
+    }
+
+    // Rows mapped at once: one tile for every thread
+    std::size_t const n_threads = (pool != nullptr) ? pool->size() : 1;
+    std::size_t const window_rows = n_threads * options.tile_rows;
+    auto const        page = static_cast<off_t>(::sysconf(_SC_PAGESIZE));
+
+    for (std::size_t row_begin = 0; row_begin < ny; row_begin += window_rows) {
+        std::size_t const row_end = std::min(row_begin + window_rows, ny);
+
+        // Mappings start on a page boundary
+        off_t const begin =
+            data_offset + static_cast<off_t>(row_begin * row_bytes);
+        off_t const map_begin = begin - begin % page;
+        std::size_t const map_size =
+            static_cast<std::size_t>(begin - map_begin) +
+            (row_end - row_begin) * row_bytes;
+
+        Mapping const window{fd.get(), map_begin, map_size};
+        if (window.data() == nullptr) {
+            return false;
+        }
+
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+        auto * out = reinterpret_cast<double *>(window.data() +
+                                                (begin - map_begin));
+
+        parallel_for(pool,
+                     row_end - row_begin,
+                     options.tile_rows,
+                     [&](std::size_t first, std::size_t last) {
+                         for (std::size_t r = first; r < last; ++r) {
+                             double const y = grid.y[row_begin + r];
+                             double *     row = out + r * nx * G_COMPONENTS;
+
+                             for (std::size_t i = 0; i < nx; ++i) {
+                                 Vec2 const v =
+                                     field.exactVelocity({grid.x[i], y});
+                                 row[G_COMPONENTS * i] = v.x;
+                                 row[G_COMPONENTS * i + 1] = v.y;
+                             }
+                         }
+                     });
+    }
+
+    return true;
+}
+
+} // namespace vortisim
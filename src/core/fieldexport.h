@@ -0,0 +1,73 @@
+#ifndef CORE_FIELDEXPORT_H
+#define CORE_FIELDEXPORT_H
+
+#include "core/flowfield.h"
+#include "core/scene.h"
+#include "core/solver.h"
+#include "core/threadpool.h"
+#include "core/vec2.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+namespace vortisim {
+
+// Rectilinear grid given by its axis coordinates; point (i, j) lies at
+// (x[i], y[j])
+struct Grid {
+    std::vector<double> x{};
+    std::vector<double> y{};
+
+    std::size_t
+    size() const
+    {
+        return x.size() * y.size();
+    }
+};
+
+// nx by ny points spanning [lo, hi] evenly, both ends included
+Grid
+uniform_grid(Vec2 const & lo, Vec2 const & hi, std::size_t nx, std::size_t ny);
+
+struct FieldExportOptions {
+    // Points are evaluated exactly, never interpolated
+    FlowFieldOptions flow{};
+
+    // Grid rows evaluated as one task; the output is mapped one tile per
+    // thread at a time, which bounds the memory in use
+    std::size_t tile_rows{16};
+};
+
+// Layout of an exported field file, all little-endian:
+//   char     magic[8]   "VSFIELD"
+//   uint32   version    1
+//   uint32   reserved   0
+//   uint64   nx, ny
+//   float64  x[nx], y[ny]
+//   float64  (u, v)[ny][nx]
+struct FieldHeader {
+    char          magic[8]{'V', 'S', 'F', 'I', 'E', 'L', 'D', '\0'};
+    std::uint32_t version{1};
+    std::uint32_t reserved{};
+    std::uint64_t nx{};
+    std::uint64_t ny{};
+};
+
+// Evaluates the total velocity of a solved scene on every grid point and
+// streams it to a memory-mapped file, row after row. Tiles of rows are
+// computed in parallel straight into the mapping. Returns false when the
+// file cannot be created or mapped.
+bool
+export_field(Scene const &                 scene,
+             Solution const &              solution,
+             Vec2 const &                  vinf,
+             Grid const &                  grid,
+             std::filesystem::path const & path,
+             FieldExportOptions const &    options = {},
+             ThreadPool *                  pool = nullptr);
+
+} // namespace vortisim
+
+#endif // CORE_FIELDEXPORT_H
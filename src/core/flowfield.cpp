@@ -0,0 +1,110 @@
+#include "core/flowfield.h"
+
+#include "core/profiler.h"
+
+#include <cassert>
+#include <utility>
+
+namespace vortisim {
+
+FlowField::FlowField(Scene const &            scene,
+                     Solution const &         solution,
+                     Vec2 const &             vinf,
+                     FlowFieldOptions const & options)
+    : panels_{make_panel_arrays(scene)},
+      strengths_{solution.strengths},
+      vinf_{vinf},
+      quadrature_{options.quadrature},
+      formulation_{solution.formulation}
+{
+    assert(strengths_.size() == panels_.size());
+
+    // Far panels are lumped into multipoles once the direct sum gets costly
+    if (quadrature_ == Quadrature::ANALYTIC &&
+        formulation_ == Formulation::CONSTANT &&
+        panels_.size() >= options.tree_threshold) {
+        tree_.emplace(panels_, options.tree);
+        tree_->setStrengths(strengths_.data());
+    }
+}
+
+Vec2
+FlowField::exactVelocity(Vec2 const & p) const
+{
+    if (tree_) {
+        return vinf_ + tree_->velocity(p);
+    }
+
+    Vec2 v = vinf_;
+    if (formulation_ == Formulation::CONSTANT) {
+        for (std::size_t j = 0; j < panels_.size(); ++j) {
+            v += strengths_[j] *
+                 panel_velocity({panels_.x1[j], panels_.y1[j]},
+                                {panels_.x2[j], panels_.y2[j]},
+                                p,
+                                quadrature_);
+        }
+        return v;
+    }
+
+    for (std::size_t k = 0; k < panels_.bodyCount(); ++k) {
+        std::size_t const first = panels_.body_starts[k];
+        std::size_t const last = panels_.body_starts[k + 1];
+
+        for (std::size_t j = first; j < last; ++j) {
+            std::size_t const next = (j + 1 == last) ? first : j + 1;
+
+            LinearPanelVelocity const linear =
+                linear_panel_velocity({panels_.x1[j], panels_.y1[j]},
+                                      {panels_.x2[j], panels_.y2[j]},
+                                      p,
+                                      quadrature_);
+            v += strengths_[j] * linear.start;
+            v += strengths_[next] * linear.end;
+        }
+    }
+    return v;
+}
+
+void
+FlowField::sample(Vec2 const & lo,
+                  Vec2 const & hi,
+                  std::size_t  nx,
+                  std::size_t  ny,
+                  ThreadPool * pool)
+{
+    ScopedTimer const timer{"field"};
+
+    assert(nx > 1 && ny > 1);
+    assert(hi.x > lo.x && hi.y > lo.y);
+
+    // Evaluated exactly while the grid is being filled
+    samples_.clear();
+
+    std::vector<Vec2> samples(nx * ny);
+
+    double const dx = (hi.x - lo.x) / static_cast<double>(nx - 1);
+    double const dy = (hi.y - lo.y) / static_cast<double>(ny - 1);
+
+    parallel_for(pool,
+                 ny,
+                 1,
+                 [&](std::size_t first, std::size_t last) {
+                     for (std::size_t j = first; j < last; ++j) {
+                         double const y = lo.y + dy * static_cast<double>(j);
+                         for (std::size_t i = 0; i < nx; ++i) {
+                             samples[j * nx + i] = exactVelocity(
+                                 {lo.x + dx * static_cast<double>(i), y});
+                         }
+                     }
+                 });
+
+    lo_ = lo;
+    inverse_spacing_ = {1.0 / dx, 1.0 / dy};
+    max_ = {static_cast<double>(nx - 1), static_cast<double>(ny - 1)};
+    nx_ = nx;
+    ny_ = ny;
+    samples_ = std::move(samples);
+}
+
+} // namespace vortisim
@@ -0,0 +1,97 @@
+#ifndef CORE_FLOWFIELD_H
+#define CORE_FLOWFIELD_H
+
+#include "core/assembly.h"
+#include "core/panel.h"
+#include "core/scene.h"
+#include "core/solver.h"
+#include "core/threadpool.h"
+#include "core/treecode.h"
+#include "core/vec2.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <optional>
+#include <vector>
+
+namespace vortisim {
+
+struct FlowFieldOptions {
+    Quadrature quadrature{Quadrature::ANALYTIC};
+
+    // Evaluate the analytic constant-strength panels through a treecode
+    // from this many panels on, summing all panels directly below
+    std::size_t tree_threshold{256};
+    TreeOptions tree{};
+};
+
+// Total velocity of a solved scene, for evaluation at many points. Besides
+// the exact sum, the field can be sampled once on a grid and bilinearly
+// interpolated inside it, which is what makes tracing large particle sets
+// cheap.
+class FlowField {
+public:
+    FlowField(Scene const &            scene,
+              Solution const &         solution,
+              Vec2 const &             vinf,
+              FlowFieldOptions const & options = {});
+
+    // Interpolated inside the sampled box, exact elsewhere
+    Vec2
+    velocity(Vec2 const & p) const
+    {
+        // Grid coordinates
+        double const gx = (p.x - lo_.x) * inverse_spacing_.x;
+        double const gy = (p.y - lo_.y) * inverse_spacing_.y;
+
+        if (samples_.empty() || !(gx >= 0.0) || !(gy >= 0.0) ||
+            gx > max_.x || gy > max_.y) {
+            return exactVelocity(p);
+        }
+
+        // Cell and position inside it; the far edges use the last cell
+        std::size_t const i = std::min(static_cast<std::size_t>(gx), nx_ - 2);
+        std::size_t const j = std::min(static_cast<std::size_t>(gy), ny_ - 2);
+        double const      fx = gx - static_cast<double>(i);
+        double const      fy = gy - static_cast<double>(j);
+
+        Vec2 const * cell = samples_.data() + j * nx_ + i;
+        Vec2 const   bottom = cell[0] + fx * (cell[1] - cell[0]);
+        Vec2 const   top = cell[nx_] + fx * (cell[nx_ + 1] - cell[nx_]);
+
+        return bottom + fy * (top - bottom);
+    }
+
+    // Freestream plus the induced velocity of every panel
+    Vec2
+    exactVelocity(Vec2 const & p) const;
+
+    // Samples the exact velocity on nx by ny points spanning [lo, hi]
+    void
+    sample(Vec2 const & lo,
+           Vec2 const & hi,
+           std::size_t  nx,
+           std::size_t  ny,
+           ThreadPool * pool = nullptr);
+
+private:
+    PanelArrays         panels_;
+    std::vector<double> strengths_;
+    Vec2                vinf_;
+    Quadrature          quadrature_;
+    Formulation         formulation_;
+
+    std::optional<VortexTree> tree_{};
+
+    // Sampled grid, empty when not sampled
+    Vec2              lo_{};
+    Vec2              inverse_spacing_{};
+    Vec2              max_{};
+    std::size_t       nx_{};
+    std::size_t       ny_{};
+    std::vector<Vec2> samples_{};
+};
+
+} // namespace vortisim
+
+#endif // CORE_FLOWFIELD_H
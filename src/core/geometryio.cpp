@@ -0,0 +1,92 @@
+#include "core/geometryio.h"
+
+#include <iomanip>
+#include <istream>
+#include <limits>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <utility>
+
+namespace vortisim {
+
+namespace {
+
+// Drops a closing node repeating the first and checks the node count
+bool
+finish_body(Body & body)
+{
+    if (body.nodes.size() > 1 && body.nodes.front() == body.nodes.back()) {
+        body.nodes.pop_back();
+    }
+
+    constexpr std::size_t min_panels = 3;
+    return body.nodes.size() >= min_panels;
+}
+
+} // namespace
+
+std::optional<Body>
+read_body(std::istream & in)
+{
+    std::optional<Scene> scene = read_scene(in);
+    if (!scene || scene->bodies.size() != 1) {
+        return std::nullopt;
+    }
+
+    return std::move(scene->bodies.front());
+}
+
+std::optional<Scene>
+read_scene(std::istream & in)
+{
+    Scene scene{};
+    Body  body{};
+
+    std::string line;
+    while (std::getline(in, line)) {
+        std::size_t const first = line.find_first_not_of(" \t\r");
+        if (first == std::string::npos || line[first] == '#') {
+            continue;
+        }
+
+        std::size_t const last = line.find_last_not_of(" \t\r");
+        if (line.compare(first, last + 1 - first, "---") == 0) {
+            if (!finish_body(body)) {
+                return std::nullopt;
+            }
+            scene.bodies.push_back(std::move(body));
+            body = Body{};
+            continue;
+        }
+
+        std::istringstream fields{line};
+
+        Vec2 node{};
+        if (!(fields >> node.x >> node.y)) {
+            return std::nullopt;
+        }
+
+        body.nodes.push_back(node);
+    }
+
+    if (in.bad() || !finish_body(body)) {
+        return std::nullopt;
+    }
+    scene.bodies.push_back(std::move(body));
+
+    return scene;
+}
+
+bool
+write_strengths(std::ostream & out, Solution const & solution)
+{
+    out << std::setprecision(std::numeric_limits<double>::max_digits10);
+    for (double const s : solution.strengths) {
+        out << s << '\n';
+    }
+
+    return static_cast<bool>(out);
+}
+
+} // namespace vortisim
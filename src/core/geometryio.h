@@ -0,0 +1,30 @@
+#ifndef CORE_GEOMETRYIO_H
+#define CORE_GEOMETRYIO_H
+
+#include "core/body.h"
+#include "core/scene.h"
+#include "core/solver.h"
+
+#include <iosfwd>
+#include <optional>
+
+namespace vortisim {
+
+// Reads a closed outline given as one whitespace separated "x y" pair per
+// line. Lines starting with '#' are comments. A final node repeating the
+// first one is dropped. Returns nothing on malformed input.
+std::optional<Body>
+read_body(std::istream & in);
+
+// Reads several outlines in the format of read_body, separated by lines
+// holding only "---"
+std::optional<Scene>
+read_scene(std::istream & in);
+
+// Writes one panel strength per line
+bool
+write_strengths(std::ostream & out, Solution const & solution);
+
+} // namespace vortisim
+
+#endif // CORE_GEOMETRYIO_H
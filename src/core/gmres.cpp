@@ -0,0 +1,111 @@
+#include "core/gmres.h"
+
+#include <cassert>
+#include <cmath>
+
+namespace vortisim {
+
+GmresResult
+gmres(LinearOperator const &  a,
+      LinearOperator const &  preconditioner,
+      Eigen::VectorXd const & b,
+      Eigen::VectorXd &       x,
+      GmresOptions const &    options)
+{
+    assert(options.restart > 0);
+    assert(x.size() == b.size());
+
+    Eigen::Index const n = b.size();
+    auto const         m = static_cast<Eigen::Index>(options.restart);
+
+    GmresResult result{};
+
+    double const b_norm = b.norm();
+    if (b_norm == 0.0) {
+        x.setZero();
+        result.converged = true;
+        return result;
+    }
+    double const target = options.tolerance * b_norm;
+
+    Eigen::MatrixXd v(n, m + 1);
+    Eigen::MatrixXd h = Eigen::MatrixXd::Zero(m + 1, m);
+    Eigen::VectorXd cs(m);
+    Eigen::VectorXd sn(m);
+    Eigen::VectorXd g(m + 1);
+    Eigen::VectorXd r(n);
+    Eigen::VectorXd w(n);
+    Eigen::VectorXd z(n);
+
+    while (result.iterations < options.max_iterations) {
+        a(x, r);
+        r = b - r;
+
+        double const beta = r.norm();
+        result.residual = beta / b_norm;
+        if (beta <= target) {
+            result.converged = true;
+            return result;
+        }
+
+        v.col(0) = r / beta;
+        g.setZero();
+        g(0) = beta;
+
+        Eigen::Index k = 0;
+        while (k < m && result.iterations < options.max_iterations) {
+            preconditioner(v.col(k), z);
+            a(z, w);
+
+            // Modified Gram-Schmidt
+            for (Eigen::Index i = 0; i <= k; ++i) {
+                h(i, k) = w.dot(v.col(i));
+                w -= h(i, k) * v.col(i);
+            }
+            h(k + 1, k) = w.norm();
+            if (h(k + 1, k) > 0.0) {
+                v.col(k + 1) = w / h(k + 1, k);
+            }
+
+            // Previous Givens rotations, then one eliminating h(k + 1, k)
+            for (Eigen::Index i = 0; i < k; ++i) {
+                double const t = cs(i) * h(i, k) + sn(i) * h(i + 1, k);
+                h(i + 1, k) = -sn(i) * h(i, k) + cs(i) * h(i + 1, k);
+                h(i, k) = t;
+            }
+
+            double const denom = std::hypot(h(k, k), h(k + 1, k));
+            cs(k) = h(k, k) / denom;
+            sn(k) = h(k + 1, k) / denom;
+            h(k, k) = denom;
+            h(k + 1, k) = 0.0;
+
+            g(k + 1) = -sn(k) * g(k);
+            g(k) = cs(k) * g(k);
+
+            ++k;
+            ++result.iterations;
+
+            result.residual = std::abs(g(k)) / b_norm;
+            if (std::abs(g(k)) <= target) {
+                break;
+            }
+        }
+
+        // Least squares update from the current Krylov basis
+        Eigen::VectorXd const y = h.topLeftCorner(k, k)
+                                      .triangularView<Eigen::Upper>()
+                                      .solve(g.head(k));
+        preconditioner(v.leftCols(k) * y, z);
+        x += z;
+
+        if (result.residual * b_norm <= target) {
+            result.converged = true;
+            return result;
+        }
+    }
+
+    return result;
+}
+
+} // namespace vortisim
@@ -0,0 +1,38 @@
+#ifndef CORE_GMRES_H
+#define CORE_GMRES_H
+
+#include <Eigen/Dense>
+#include <functional>
+
+namespace vortisim {
+
+// y = A x for a matrix that is only available through its action
+using LinearOperator =
+    std::function<void(Eigen::VectorXd const & x, Eigen::VectorXd & y)>;
+
+struct GmresOptions {
+    // Relative residual |b - A x| / |b| to stop at
+    double tolerance{1e-10};
+    // Krylov basis size before restarting; memory is restart + 1 vectors
+    int restart{100};
+    int max_iterations{1000};
+};
+
+struct GmresResult {
+    int    iterations{};
+    double residual{};
+    bool   converged{false};
+};
+
+// Restarted GMRES with right preconditioning, solving A x = b starting from
+// the given x. The preconditioner applies an approximation of A^-1.
+GmresResult
+gmres(LinearOperator const &  a,
+      LinearOperator const &  preconditioner,
+      Eigen::VectorXd const & b,
+      Eigen::VectorXd &       x,
+      GmresOptions const &    options = {});
+
+} // namespace vortisim
+
+#endif // CORE_GMRES_H
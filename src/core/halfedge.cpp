@@ -0,0 +1,112 @@
+#include "core/halfedge.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace vortisim {
+
+HalfEdgeMesh::Index
+HalfEdgeMesh::addVertex()
+{
+    first_out_.push_back(NONE);
+
+    return static_cast<Index>(first_out_.size() - 1);
+}
+
+HalfEdgeMesh::Index
+HalfEdgeMesh::addEdge(Index a, Index b)
+{
+    assert(a < vertexCount() && b < vertexCount() && a != b);
+
+    auto const h = static_cast<Index>(origins_.size());
+
+    origins_.push_back(a);
+    origins_.push_back(b);
+    next_out_.push_back(first_out_[a]);
+    next_out_.push_back(first_out_[b]);
+    panels_.push_back(NONE);
+    panels_.push_back(NONE);
+
+    first_out_[a] = h;
+    first_out_[b] = twin(h);
+
+    return h;
+}
+
+HalfEdgeMesh::Index
+HalfEdgeMesh::find(Index a, Index b) const
+{
+    for (Index h = first_out_[a]; h != NONE; h = next_out_[h]) {
+        if (target(h) == b) {
+            return h;
+        }
+    }
+
+    return NONE;
+}
+
+HalfEdgeMesh::Index
+HalfEdgeMesh::closeLoop(Index h)
+{
+    assert(h < origins_.size() && panels_[h] == NONE);
+
+    Index const start = target(h);
+    Index const goal = origin(h);
+
+    // Breadth-first search from start; via[v] is the half-edge that reached
+    // vertex v
+    std::vector<Index> via(vertexCount(), NONE);
+    std::vector<Index> queue{start};
+    bool               found = false;
+
+    for (std::size_t next = 0; next < queue.size() && !found; ++next) {
+        Index const v = queue[next];
+
+        for (Index g = first_out_[v]; g != NONE; g = next_out_[g]) {
+            Index const w = target(g);
+            if (panels_[g] != NONE || g == twin(h) || w == start ||
+                via[w] != NONE) {
+                continue;
+            }
+
+            via[w] = g;
+            if (w == goal) {
+                found = true;
+                break;
+            }
+            queue.push_back(w);
+        }
+    }
+
+    if (!found) {
+        return NONE;
+    }
+
+    // The path backwards from goal, then reversed
+    std::size_t const begin = loop_half_edges_.size();
+    for (Index v = goal; v != start; v = origin(via[v])) {
+        loop_half_edges_.push_back(via[v]);
+    }
+    std::reverse(loop_half_edges_.begin() + static_cast<std::ptrdiff_t>(begin),
+                 loop_half_edges_.end());
+    loop_half_edges_.push_back(h);
+
+    for (std::size_t k = begin; k < loop_half_edges_.size(); ++k) {
+        panels_[loop_half_edges_[k]] = static_cast<Index>(k);
+    }
+    loop_ends_.push_back(loop_half_edges_.size());
+
+    return static_cast<Index>(loop_ends_.size() - 1);
+}
+
+std::size_t
+HalfEdgeMesh::loopOf(std::size_t panel) const
+{
+    assert(panel < loop_half_edges_.size());
+
+    return static_cast<std::size_t>(
+        std::upper_bound(loop_ends_.begin(), loop_ends_.end(), panel) -
+        loop_ends_.begin());
+}
+
+} // namespace vortisim
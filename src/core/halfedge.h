@@ -0,0 +1,146 @@
+#ifndef CORE_HALFEDGE_H
+#define CORE_HALFEDGE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace vortisim {
+
+// Topology of a drawing of line segments between vertices given by index;
+// positions are kept by the caller in the same order. Every edge e is stored
+// as the half-edges 2 e and 2 e + 1 running in opposite directions, so the
+// twin of a half-edge is found by flipping its lowest bit. The half-edges
+// leaving a vertex are chained into a list, which makes adding an edge and
+// stepping to a neighbour O(1). Closed loops are recorded as runs of
+// half-edges, one panel per half-edge, in one contiguous array.
+class HalfEdgeMesh {
+public:
+    using Index = std::uint32_t;
+
+    static constexpr Index NONE = std::numeric_limits<Index>::max();
+
+    Index
+    addVertex();
+
+    // Half-edge from a to b
+    Index
+    addEdge(Index a, Index b);
+
+    std::size_t
+    vertexCount() const
+    {
+        return first_out_.size();
+    }
+
+    std::size_t
+    edgeCount() const
+    {
+        return origins_.size() / 2;
+    }
+
+    static Index
+    twin(Index h)
+    {
+        return h ^ 1U;
+    }
+
+    Index
+    origin(Index h) const
+    {
+        return origins_[h];
+    }
+
+    Index
+    target(Index h) const
+    {
+        return origins_[twin(h)];
+    }
+
+    // First half-edge leaving v, NONE for an isolated vertex
+    Index
+    firstOut(Index v) const
+    {
+        return first_out_[v];
+    }
+
+    // Next half-edge with the same origin as h, NONE after the last
+    Index
+    nextOut(Index h) const
+    {
+        return next_out_[h];
+    }
+
+    // Half-edge from a to b, NONE when they are not connected
+    Index
+    find(Index a, Index b) const;
+
+    // Both ends of every edge in edge order: the element array of the edges
+    // drawn as GL_LINES
+    std::vector<Index> const &
+    origins() const
+    {
+        return origins_;
+    }
+
+    // Closes a loop with half-edge h along the shortest path from the target
+    // of h back to its origin, over half-edges of no loop yet. The loop
+    // starts at the target of h and ends with h. Returns the loop, or NONE
+    // when the drawing has no such path. O(V + E).
+    Index
+    closeLoop(Index h);
+
+    std::size_t
+    loopCount() const
+    {
+        return loop_ends_.size();
+    }
+
+    // Half-edges of all loops, loop after loop
+    std::vector<Index> const &
+    loopHalfEdges() const
+    {
+        return loop_half_edges_;
+    }
+
+    // One past the last half-edge of every loop in loopHalfEdges()
+    std::vector<std::size_t> const &
+    loopEnds() const
+    {
+        return loop_ends_;
+    }
+
+    std::size_t
+    loopBegin(std::size_t loop) const
+    {
+        return (loop == 0) ? 0 : loop_ends_[loop - 1];
+    }
+
+    // Loop of the position of a half-edge in loopHalfEdges()
+    std::size_t
+    loopOf(std::size_t panel) const;
+
+    // Position of h in loopHalfEdges(), NONE when it is on no loop
+    Index
+    panel(Index h) const
+    {
+        return panels_[h];
+    }
+
+private:
+    // Per vertex
+    std::vector<Index> first_out_{};
+
+    // Per half-edge
+    std::vector<Index> origins_{};
+    std::vector<Index> next_out_{};
+    std::vector<Index> panels_{};
+
+    std::vector<Index>       loop_half_edges_{};
+    std::vector<std::size_t> loop_ends_{};
+};
+
+} // namespace vortisim
+
+#endif // CORE_HALFEDGE_H
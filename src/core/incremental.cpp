@@ -0,0 +1,327 @@
+#include "core/incremental.h"
+
+#include "core/profiler.h"
+
+#include <algorithm>
+#include <cassert>
+#include <iterator>
+#include <utility>
+
+namespace vortisim {
+
+IncrementalSolver::IncrementalSolver(Scene        scene,
+                                     Quadrature   quadrature,
+                                     ThreadPool * pool,
+                                     Formulation  formulation,
+                                     std::size_t  max_modified)
+    : scene_{std::move(scene)},
+      quadrature_{quadrature},
+      pool_{pool},
+      formulation_{formulation},
+      max_modified_{max_modified},
+      panels_{make_panel_arrays(scene_, formulation)}
+{
+    a0_ = assemble_influence(panels_, quadrature_, pool_, formulation_);
+    factorize();
+}
+
+IncrementalSolver::IncrementalSolver(Scene           scene,
+                                     Eigen::MatrixXd influence,
+                                     Quadrature      quadrature,
+                                     ThreadPool *    pool,
+                                     Formulation     formulation,
+                                     std::size_t     max_modified)
+    : scene_{std::move(scene)},
+      quadrature_{quadrature},
+      pool_{pool},
+      formulation_{formulation},
+      max_modified_{max_modified},
+      panels_{make_panel_arrays(scene_, formulation)},
+      a0_{std::move(influence)}
+{
+    assert(static_cast<std::size_t>(a0_.rows()) == panels_.size());
+    factorize();
+}
+
+void
+IncrementalSolver::factorize()
+{
+    ScopedTimer const timer{"factorization"};
+
+    auto const n = static_cast<Eigen::Index>(panels_.size());
+
+    // The Kutta rows have no freestream term
+    normals0_.resize(n, 2);
+    normals0_.col(0) = Eigen::Map<Eigen::VectorXd const>(panels_.nx.data(), n);
+    normals0_.col(1) = Eigen::Map<Eigen::VectorXd const>(panels_.ny.data(), n);
+    for (std::size_t k = 0; k < panels_.bodyCount(); ++k) {
+        normals0_.row(static_cast<Eigen::Index>(panels_.kuttaRow(k)))
+            .setZero();
+    }
+
+    lu_.compute(a0_);
+    normal_solves_ = lu_.solve(normals0_);
+}
+
+bool
+IncrementalSolver::isKuttaRow(std::size_t row) const
+{
+    auto const next = std::upper_bound(
+        panels_.body_starts.begin(), panels_.body_starts.end(), row);
+    auto const body =
+        static_cast<std::size_t>(next - panels_.body_starts.begin()) - 1;
+
+    return row == panels_.kuttaRow(body);
+}
+
+std::vector<std::size_t>
+IncrementalSolver::modifiedColumns() const
+{
+    if (formulation_ == Formulation::CONSTANT) {
+        return modified_;
+    }
+
+    // A linear unknown spans its own panel and the one before it
+    std::vector<std::size_t> columns = modified_;
+    for (std::size_t const panel : modified_) {
+        columns.push_back(panels_.nextPanel(panel));
+    }
+    std::sort(columns.begin(), columns.end());
+    columns.erase(std::unique(columns.begin(), columns.end()), columns.end());
+
+    return columns;
+}
+
+void
+IncrementalSolver::moveNode(std::size_t  body,
+                            std::size_t  node,
+                            Vec2 const & position)
+{
+    assert(body < scene_.bodies.size());
+
+    Body &            b = scene_.bodies[body];
+    std::size_t const n_panels = b.panelCount();
+    assert(node < n_panels);
+
+    b.nodes[node] = position;
+
+    // The panels ending and starting at the node
+    std::size_t const offset = panels_.body_starts[body];
+    std::size_t const prev = (node + n_panels - 1) % n_panels;
+    updatePanel(offset + prev, b.panelStart(prev), b.panelEnd(prev));
+    updatePanel(offset + node, b.panelStart(node), b.panelEnd(node));
+
+    if (modified_.size() > max_modified_) {
+        refactorize();
+    } else {
+        updateCorrection();
+    }
+}
+
+void
+IncrementalSolver::updatePanel(std::size_t  panel,
+                               Vec2 const & p1,
+                               Vec2 const & p2)
+{
+    set_panel(panels_, panel, p1, p2);
+
+    column_solves_.erase(panel);
+    if (formulation_ == Formulation::LINEAR) {
+        column_solves_.erase(panels_.nextPanel(panel));
+    }
+
+    auto const it =
+        std::lower_bound(modified_.begin(), modified_.end(), panel);
+    if (it == modified_.end() || *it != panel) {
+        modified_.insert(it, panel);
+    }
+}
+
+void
+IncrementalSolver::updateCorrection()
+{
+    auto const n = static_cast<Eigen::Index>(panels_.size());
+
+    // The Kutta rows do not depend on geometry
+    std::vector<std::size_t> rows;
+    std::copy_if(modified_.begin(),
+                 modified_.end(),
+                 std::back_inserter(rows),
+                 [this](std::size_t i) { return !isKuttaRow(i); });
+
+    std::vector<std::size_t> const columns = modifiedColumns();
+
+    auto const n_rows = static_cast<Eigen::Index>(rows.size());
+    auto const n_cols = static_cast<Eigen::Index>(columns.size());
+
+    v_ = Eigen::MatrixXd::Zero(n, n_rows + n_cols);
+    z_.resize(n, n_rows + n_cols);
+
+    // Changed rows: U = e_r, V = new row - old row
+    Eigen::MatrixXd row(1, n);
+    for (Eigen::Index k = 0; k < n_rows; ++k) {
+        std::size_t const r = rows[k];
+        assemble_block(panels_,
+                       r,
+                       r + 1,
+                       0,
+                       panels_.size(),
+                       quadrature_,
+                       row,
+                       formulation_);
+
+        v_.col(k) = (row - a0_.row(r)).transpose();
+
+        auto it = unit_solves_.find(r);
+        if (it == unit_solves_.end()) {
+            it = unit_solves_
+                     .emplace(r, lu_.solve(Eigen::VectorXd::Unit(n, r)))
+                     .first;
+        }
+        z_.col(k) = it->second;
+    }
+
+    // Changed columns outside the changed rows: U = new - old, V = e_c.
+    // Columns solved during earlier moves only lose the rows modified since,
+    // A0^-1 (u - u_r e_r) = A0^-1 u - u_r A0^-1 e_r.
+    std::vector<std::size_t> missing;
+    for (Eigen::Index k = 0; k < n_cols; ++k) {
+        std::size_t const c = columns[k];
+        v_(c, n_rows + k) = 1.0;
+
+        auto const it = column_solves_.find(c);
+        if (it == column_solves_.end()) {
+            missing.push_back(c);
+            continue;
+        }
+
+        ColumnSolve &            cached = it->second;
+        std::vector<std::size_t> added;
+        std::set_difference(rows.begin(),
+                            rows.end(),
+                            cached.rows.begin(),
+                            cached.rows.end(),
+                            std::back_inserter(added));
+        for (std::size_t const r : added) {
+            auto const i = static_cast<Eigen::Index>(r);
+            cached.z -= cached.u(i) * unit_solves_.at(r);
+            cached.u(i) = 0.0;
+        }
+        cached.rows = rows;
+    }
+
+    auto const n_missing = static_cast<Eigen::Index>(missing.size());
+    Eigen::MatrixXd u(n, n_missing);
+    for (Eigen::Index k = 0; k < n_missing; ++k) {
+        std::size_t const c = missing[k];
+        assemble_block(panels_,
+                       0,
+                       panels_.size(),
+                       c,
+                       c + 1,
+                       quadrature_,
+                       u.col(k),
+                       formulation_);
+
+        u.col(k) -= a0_.col(c);
+        for (std::size_t b = 0; b < panels_.bodyCount(); ++b) {
+            u(panels_.kuttaRow(b), k) = 0.0;
+        }
+        for (std::size_t const r : rows) {
+            u(r, k) = 0.0;
+        }
+    }
+    Eigen::MatrixXd const z = lu_.solve(u);
+    for (Eigen::Index k = 0; k < n_missing; ++k) {
+        column_solves_[missing[k]] = ColumnSolve{u.col(k), z.col(k), rows};
+    }
+
+    for (Eigen::Index k = 0; k < n_cols; ++k) {
+        z_.col(n_rows + k) = column_solves_.at(columns[k]).z;
+    }
+
+    capacitance_.compute(
+        Eigen::MatrixXd::Identity(n_rows + n_cols, n_rows + n_cols) +
+        v_.transpose() * z_);
+}
+
+void
+IncrementalSolver::refactorize()
+{
+    if (!modified_.empty()) {
+        std::size_t const n_panels = panels_.size();
+
+        // Kutta entries of the columns are kept
+        Eigen::VectorXd column(n_panels);
+        for (std::size_t const c : modifiedColumns()) {
+            assemble_block(panels_,
+                           0,
+                           n_panels,
+                           c,
+                           c + 1,
+                           quadrature_,
+                           column,
+                           formulation_);
+
+            for (std::size_t r = 0; r < n_panels; ++r) {
+                if (!isKuttaRow(r)) {
+                    a0_(r, c) = column(r);
+                }
+            }
+        }
+        for (std::size_t const r : modified_) {
+            if (!isKuttaRow(r)) {
+                assemble_block(panels_,
+                               r,
+                               r + 1,
+                               0,
+                               n_panels,
+                               quadrature_,
+                               a0_.middleRows(r, 1),
+                               formulation_);
+            }
+        }
+    }
+
+    factorize();
+
+    modified_.clear();
+    unit_solves_.clear();
+    column_solves_.clear();
+    v_.resize(0, 0);
+    z_.resize(0, 0);
+}
+
+Solution
+IncrementalSolver::solve(Vec2 const & vinf) const
+{
+    ScopedTimer const timer{"solve"};
+
+    // y = A0^-1 b, from the base normals plus the changed ones
+    Eigen::VectorXd x =
+        -(normal_solves_.col(0) * vinf.x + normal_solves_.col(1) * vinf.y);
+    for (std::size_t const r : modified_) {
+        if (isKuttaRow(r)) {
+            continue;
+        }
+
+        auto const   i = static_cast<Eigen::Index>(r);
+        double const db = -(panels_.nx[r] - normals0_(i, 0)) * vinf.x -
+                          (panels_.ny[r] - normals0_(i, 1)) * vinf.y;
+        x += db * unit_solves_.at(r);
+    }
+
+    // (A0 + U V^T)^-1 b = y - Z (I + V^T Z)^-1 V^T y
+    if (!modified_.empty()) {
+        x -= z_ * capacitance_.solve(v_.transpose() * x);
+    }
+
+    Solution solution{};
+    solution.strengths.assign(x.data(), x.data() + x.size());
+    solution.formulation = formulation_;
+    solution.mode = SolverMode::DENSE;
+
+    return solution;
+}
+
+} // namespace vortisim
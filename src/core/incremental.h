@@ -0,0 +1,138 @@
+#ifndef CORE_INCREMENTAL_H
+#define CORE_INCREMENTAL_H
+
+#include "core/assembly.h"
+#include "core/body.h"
+#include "core/panel.h"
+#include "core/scene.h"
+#include "core/solver.h"
+#include "core/threadpool.h"
+#include "core/vec2.h"
+
+#include <Eigen/Dense>
+#include <cstddef>
+#include <unordered_map>
+#include <vector>
+
+namespace vortisim {
+
+// Dense panel system that follows node moves without refactorizing. The
+// factorization of a base matrix A0 is kept; rows and columns of panels
+// modified since then form a low-rank correction A = A0 + U V^T which is
+// applied through the Sherman-Morrison-Woodbury identity. Moving one node
+// touches two panels, so dragging a node around keeps the rank at four, or
+// at five with the linear formulation, whose unknowns also take in the
+// panel before them.
+class IncrementalSolver {
+public:
+    explicit IncrementalSolver(
+        Scene        scene,
+        Quadrature   quadrature = Quadrature::ANALYTIC,
+        ThreadPool * pool = nullptr,
+        Formulation  formulation = Formulation::CONSTANT,
+        std::size_t  max_modified = 32);
+
+    // Starts from an influence matrix of the scene assembled elsewhere, e.g.
+    // by a SceneAssembler
+    IncrementalSolver(Scene           scene,
+                      Eigen::MatrixXd influence,
+                      Quadrature      quadrature = Quadrature::ANALYTIC,
+                      ThreadPool *    pool = nullptr,
+                      Formulation     formulation = Formulation::CONSTANT,
+                      std::size_t     max_modified = 32);
+
+    Scene const &
+    scene() const
+    {
+        return scene_;
+    }
+
+    // Number of panels differing from the factorized base matrix
+    std::size_t
+    modifiedPanels() const
+    {
+        return modified_.size();
+    }
+
+    // Pool of the following edits and solves, for a solver handed over from
+    // the thread that built it
+    void
+    setPool(ThreadPool * pool)
+    {
+        pool_ = pool;
+    }
+
+    // Moves one node of a body and updates the correction of the two
+    // adjacent panels; only their columns are solved again. Refactorizes
+    // once more than max_modified panels differ from the base.
+    void
+    moveNode(std::size_t body, std::size_t node, Vec2 const & position);
+
+    // Folds the correction into a fresh factorization
+    void
+    refactorize();
+
+    // Strengths for the current geometry. The residual is not evaluated, it
+    // would cost as much as the solve itself.
+    Solution
+    solve(Vec2 const & vinf) const;
+
+private:
+    void
+    updatePanel(std::size_t panel, Vec2 const & p1, Vec2 const & p2);
+
+    void
+    updateCorrection();
+
+    void
+    factorize();
+
+    bool
+    isKuttaRow(std::size_t row) const;
+
+    // Sorted columns of a0_ changed along with the modified panels
+    std::vector<std::size_t>
+    modifiedColumns() const;
+
+    Scene        scene_;
+    Quadrature   quadrature_;
+    ThreadPool * pool_;
+    Formulation  formulation_;
+    std::size_t  max_modified_;
+
+    PanelArrays panels_{};
+
+    // Base matrix and its factorization
+    Eigen::MatrixXd                      a0_{};
+    Eigen::PartialPivLU<Eigen::MatrixXd> lu_{};
+
+    // The right-hand side is linear in the freestream, b = -N vinf. Keeps the
+    // base normals N0 and A0^-1 N0 so solving needs no triangular solves.
+    Eigen::MatrixX2d normals0_{};
+    Eigen::MatrixX2d normal_solves_{};
+
+    // Sorted panels whose rows and columns differ from a0_
+    std::vector<std::size_t> modified_{};
+
+    // Woodbury terms: V, Z = A0^-1 U and the factorized capacitance matrix
+    // I + V^T Z
+    Eigen::MatrixXd                      v_{};
+    Eigen::MatrixXd                      z_{};
+    Eigen::PartialPivLU<Eigen::MatrixXd> capacitance_{};
+
+    // A0^-1 e_r for the modified rows, which stay fixed while dragging
+    std::unordered_map<std::size_t, Eigen::VectorXd> unit_solves_{};
+
+    // Correction u of a modified column, zero in the listed rows, and
+    // A0^-1 u. Kept until the panels spanned by the column move again.
+    struct ColumnSolve {
+        Eigen::VectorXd          u{};
+        Eigen::VectorXd          z{};
+        std::vector<std::size_t> rows{};
+    };
+    std::unordered_map<std::size_t, ColumnSolve> column_solves_{};
+};
+
+} // namespace vortisim
+
+#endif // CORE_INCREMENTAL_H
@@ -0,0 +1,162 @@
+#include "core/iterative.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace vortisim {
+
+namespace {
+
+// Control points handed to one task of the matrix-vector product
+constexpr std::size_t G_TARGET_CHUNK = 256;
+
+} // namespace
+
+BlockJacobi::BlockJacobi(PanelArrays const & panels,
+                         std::size_t         block_size,
+                         ThreadPool *        pool)
+{
+    assert(block_size > 0);
+
+    // Blocks do not straddle bodies
+    std::vector<std::size_t> bodies;
+    for (std::size_t k = 0; k < panels.bodyCount(); ++k) {
+        std::size_t const body_end = panels.body_starts[k + 1];
+        for (std::size_t start = panels.body_starts[k]; start < body_end;
+             start += block_size) {
+            starts_.push_back(start);
+            bodies.push_back(k);
+        }
+    }
+    starts_.push_back(panels.size());
+
+    blocks_.resize(starts_.size() - 1);
+
+    parallel_for(
+        pool,
+        blocks_.size(),
+        1,
+        [this, &panels, &bodies](std::size_t first, std::size_t last) {
+            for (std::size_t b = first; b < last; ++b) {
+                std::size_t const begin = starts_[b];
+                std::size_t const end = starts_[b + 1];
+                auto const        size = static_cast<Eigen::Index>(end - begin);
+
+                Eigen::MatrixXd block(size, size);
+                assemble_block(panels,
+                               begin,
+                               end,
+                               begin,
+                               end,
+                               Quadrature::ANALYTIC,
+                               block);
+
+                // Kutta row, as far as it falls inside the block. Without
+                // either trailing edge panel it keeps its diagonal, so the
+                // block stays invertible.
+                std::size_t const body = bodies[b];
+                std::size_t const kutta = panels.kuttaRow(body);
+                if (begin <= kutta && kutta < end) {
+                    auto const row = static_cast<Eigen::Index>(kutta - begin);
+                    bool const head = begin == panels.body_starts[body];
+                    bool const tail = end == panels.body_starts[body + 1];
+
+                    block.row(row).setZero();
+                    if (head) {
+                        block(row, 0) = 1.0;
+                    }
+                    if (tail) {
+                        block(row, size - 1) = 1.0;
+                    }
+                    if (!head && !tail) {
+                        block(row, row) = 1.0;
+                    }
+                }
+
+                blocks_[b].compute(block);
+            }
+        });
+}
+
+void
+BlockJacobi::apply(Eigen::VectorXd const & r, Eigen::VectorXd & z) const
+{
+    z.resize(r.size());
+
+    for (std::size_t b = 0; b < blocks_.size(); ++b) {
+        auto const begin = static_cast<Eigen::Index>(starts_[b]);
+        auto const size = static_cast<Eigen::Index>(starts_[b + 1]) - begin;
+
+        z.segment(begin, size) = blocks_[b].solve(r.segment(begin, size));
+    }
+}
+
+GmresResult
+solve_iterative(PanelArrays const &      panels,
+                Eigen::VectorXd const &  rhs,
+                Eigen::VectorXd &        x,
+                IterativeOptions const & options,
+                ThreadPool *             pool)
+{
+    BlockJacobi const preconditioner{panels, options.block_size, pool};
+
+    return solve_iterative(panels, preconditioner, rhs, x, options, pool);
+}
+
+GmresResult
+solve_iterative(PanelArrays const &      panels,
+                BlockJacobi const &      preconditioner,
+                Eigen::VectorXd const &  rhs,
+                Eigen::VectorXd &        x,
+                IterativeOptions const & options,
+                ThreadPool *             pool)
+{
+    std::size_t const n_panels = panels.size();
+    assert(n_panels > 1);
+    assert(static_cast<std::size_t>(rhs.size()) == n_panels);
+
+    VortexTree tree{panels, options.tree};
+
+    LinearOperator const matvec = [&tree, &panels, n_panels, pool](
+                                      Eigen::VectorXd const & in,
+                                      Eigen::VectorXd &       out) {
+        out.resize(in.size());
+        tree.setStrengths(in.data());
+
+        // Normal velocity at every control point, the Kutta rows are
+        // overwritten below
+        parallel_for(pool,
+                     n_panels,
+                     G_TARGET_CHUNK,
+                     [&tree, &panels, &out](std::size_t begin,
+                                            std::size_t end) {
+                         for (std::size_t i = begin; i < end; ++i) {
+                             Vec2 const v =
+                                 tree.velocity({panels.xc[i], panels.yc[i]});
+                             out(i) = v.x * panels.nx[i] + v.y * panels.ny[i];
+                         }
+                     });
+
+        // Kutta conditions
+        for (std::size_t k = 0; k < panels.bodyCount(); ++k) {
+            auto const first = static_cast<Eigen::Index>(panels.body_starts[k]);
+            auto const last =
+                static_cast<Eigen::Index>(panels.body_starts[k + 1]) - 1;
+            out(static_cast<Eigen::Index>(panels.kuttaRow(k))) =
+                in(first) + in(last);
+        }
+    };
+
+    LinearOperator const precondition =
+        [&preconditioner](Eigen::VectorXd const & in, Eigen::VectorXd & out) {
+            preconditioner.apply(in, out);
+        };
+
+    if (x.size() != rhs.size()) {
+        x = Eigen::VectorXd::Zero(rhs.size());
+    }
+
+    return gmres(matvec, precondition, rhs, x, options.gmres);
+}
+
+} // namespace vortisim
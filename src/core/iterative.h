@@ -0,0 +1,70 @@
+#ifndef CORE_ITERATIVE_H
+#define CORE_ITERATIVE_H
+
+#include "core/assembly.h"
+#include "core/gmres.h"
+#include "core/threadpool.h"
+#include "core/treecode.h"
+
+#include <Eigen/Dense>
+#include <cstddef>
+#include <vector>
+
+namespace vortisim {
+
+struct IterativeOptions {
+    // More terms than the particle default: product errors reach the
+    // strengths amplified along the near-null mode of solve_iterative
+    TreeOptions  tree{30};
+    GmresOptions gmres{};
+    // Panels per diagonal block of the preconditioner
+    std::size_t block_size{256};
+};
+
+// Block-diagonal preconditioner: the dense self-influence of runs of
+// consecutive panels of one body, each factorized on its own. Storage is
+// O(N * block_size).
+class BlockJacobi {
+public:
+    BlockJacobi(PanelArrays const & panels,
+                std::size_t         block_size,
+                ThreadPool *        pool = nullptr);
+
+    void
+    apply(Eigen::VectorXd const & r, Eigen::VectorXd & z) const;
+
+private:
+    std::vector<std::size_t>                          starts_{};
+    std::vector<Eigen::PartialPivLU<Eigen::MatrixXd>> blocks_{};
+};
+
+// Solves the panel system, with the Kutta condition on the kuttaRow of every
+// body, by GMRES on a treecode matrix-vector product. x holds the initial
+// guess.
+//
+// The system has a near-null mode, strengths alternating from panel to
+// panel, with a singular value around 1e-6 at a few hundred panels. The
+// truncation error of the product is amplified along it, so the strengths
+// match the dense solve only to about 1e-6 of their largest magnitude,
+// whatever the GMRES tolerance. The mode cancels from the loads: cl and cm
+// match to about 1e-9.
+GmresResult
+solve_iterative(PanelArrays const &      panels,
+                Eigen::VectorXd const &  rhs,
+                Eigen::VectorXd &        x,
+                IterativeOptions const & options = {},
+                ThreadPool *             pool = nullptr);
+
+// Same with a preconditioner of the panels built beforehand, e.g. shared by
+// several right-hand sides
+GmresResult
+solve_iterative(PanelArrays const &      panels,
+                BlockJacobi const &      preconditioner,
+                Eigen::VectorXd const &  rhs,
+                Eigen::VectorXd &        x,
+                IterativeOptions const & options = {},
+                ThreadPool *             pool = nullptr);
+
+} // namespace vortisim
+
+#endif // CORE_ITERATIVE_H
@@ -0,0 +1,267 @@
+#include "core/loads.h"
+
+#include "core/assembly.h"
+#include "core/treecode.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <optional>
+
+namespace vortisim {
+
+namespace {
+
+// Panels evaluated through a treecode from this count on
+constexpr std::size_t G_TREE_THRESHOLD = 256;
+
+// Control points handed to a thread at once
+constexpr std::size_t G_CHUNK = 64;
+
+// Panels whose control point lies within this many local panel lengths of
+// both trailing edge panel lines, and the distance off the surface, in the
+// same lengths, at which their outside velocity is evaluated
+constexpr double G_WEDGE_REACH = 2.0;
+constexpr double G_WEDGE_OFFSET = 2.5;
+
+// Sheet strength at the control point of panel i
+double
+midpoint_strength(PanelArrays const & panels,
+                  Solution const &    solution,
+                  std::size_t         i)
+{
+    if (solution.formulation == Formulation::CONSTANT) {
+        return solution.strengths[i];
+    }
+
+    return 0.5 * (solution.strengths[i] +
+                  solution.strengths[panels.nextPanel(i)]);
+}
+
+Surface
+surface_of(PanelArrays const & panels,
+           Solution const &    solution,
+           Vec2 const &        vinf,
+           Quadrature          quadrature,
+           ThreadPool *        pool)
+{
+    std::size_t const n = panels.size();
+    assert(solution.strengths.size() == n);
+
+    std::vector<double> const & strengths = solution.strengths;
+
+    double const speed = length(vinf);
+
+    Surface surface{};
+    surface.x = panels.xc;
+    surface.y = panels.yc;
+    surface.velocity.resize(n);
+    surface.cp.resize(n);
+
+    if (solution.formulation == Formulation::LINEAR) {
+        for (std::size_t i = 0; i < n; ++i) {
+            surface.velocity[i] = midpoint_strength(panels, solution, i);
+
+            double const q = surface.velocity[i] / speed;
+            surface.cp[i] = 1.0 - q * q;
+        }
+        return surface;
+    }
+
+    std::optional<VortexTree> tree;
+    if (quadrature == Quadrature::ANALYTIC && n >= G_TREE_THRESHOLD) {
+        tree.emplace(panels);
+        tree->setStrengths(strengths.data());
+    }
+
+    // Velocity induced at p by every panel
+    auto const induced = [&](Vec2 const & p) {
+        if (tree) {
+            return tree->velocity(p);
+        }
+
+        Vec2 v{};
+        for (std::size_t j = 0; j < n; ++j) {
+            v += strengths[j] * panel_velocity({panels.x1[j], panels.y1[j]},
+                                               {panels.x2[j], panels.y2[j]},
+                                               p,
+                                               quadrature);
+        }
+        return v;
+    };
+
+    parallel_for(pool, n, G_CHUNK, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i) {
+            Vec2 const p1{panels.x1[i], panels.y1[i]};
+            Vec2 const p2{panels.x2[i], panels.y2[i]};
+            Vec2 const c{panels.xc[i], panels.yc[i]};
+            Vec2 const t = (1.0 / panels.len[i]) * (p2 - p1);
+
+            // Inside the trailing edge wedge the panels of the other surface
+            // are within a few panel lengths, and their odd-even oscillation
+            // does not cancel in the mean. Off the surface it decays by
+            // exp(-pi) per panel length, that of the own panel included. The
+            // longest neighbour sets the length, the trailing edge pair is
+            // graded the most steeply.
+            std::size_t const k = panels.bodyOf(i);
+            std::size_t const first = panels.body_starts[k];
+            std::size_t const last = panels.body_starts[k + 1] - 1;
+            Vec2 const r = c - Vec2{panels.x1[first], panels.y1[first]};
+            double const wedge = std::max(
+                std::abs(dot(r, {panels.nx[first], panels.ny[first]})),
+                std::abs(dot(r, {panels.nx[last], panels.ny[last]})));
+            double const h = std::max({panels.len[panels.previousPanel(i)],
+                                       panels.len[i],
+                                       panels.len[panels.nextPanel(i)]});
+            if (wedge < G_WEDGE_REACH * h) {
+                Vec2 const normal{panels.nx[i], panels.ny[i]};
+                Vec2 const p = c + (G_WEDGE_OFFSET * h) * normal;
+
+                surface.velocity[i] = dot(vinf + induced(p), t);
+            } else {
+                // Every panel but the own one; the tree includes it, and
+                // subtracting the same direct term removes it again
+                Vec2 v = vinf;
+                if (tree) {
+                    v += tree->velocity(c) -
+                         strengths[i] * panel_velocity(p1, p2, c, quadrature);
+                } else {
+                    for (std::size_t j = 0; j < n; ++j) {
+                        if (j != i) {
+                            v += strengths[j] *
+                                 panel_velocity({panels.x1[j], panels.y1[j]},
+                                                {panels.x2[j], panels.y2[j]},
+                                                c,
+                                                quadrature);
+                        }
+                    }
+                }
+
+                // The sheet adds half its strength on either side, and the
+                // flow inside the body is at rest
+                surface.velocity[i] = 2.0 * dot(v, t);
+            }
+
+            double const q = surface.velocity[i] / speed;
+            surface.cp[i] = 1.0 - q * q;
+        }
+    });
+
+    return surface;
+}
+
+} // namespace
+
+Surface
+compute_surface(Scene const &    scene,
+                Solution const & solution,
+                Vec2 const &     vinf,
+                Quadrature       quadrature,
+                ThreadPool *     pool)
+{
+    return surface_of(
+        make_panel_arrays(scene), solution, vinf, quadrature, pool);
+}
+
+Loads
+compute_loads(Scene const &    scene,
+              Solution const & solution,
+              Vec2 const &     vinf,
+              Quadrature       quadrature,
+              ThreadPool *     pool)
+{
+    return compute_loads(
+        scene,
+        solution,
+        compute_surface(scene, solution, vinf, quadrature, pool),
+        vinf);
+}
+
+Loads
+compute_loads(Scene const &    scene,
+              Solution const & solution,
+              Surface const &  surface,
+              Vec2 const &     vinf)
+{
+    assert(!scene.bodies.empty());
+
+    PanelArrays const panels = make_panel_arrays(scene);
+    assert(surface.cp.size() == panels.size());
+
+    // Leading edge of the first body
+    std::vector<Vec2> const & nodes = scene.bodies.front().nodes;
+    Vec2 const &              trailing = nodes[0];
+    Vec2                      leading = trailing;
+    for (Vec2 const & node : nodes) {
+        if (length(node - trailing) > length(leading - trailing)) {
+            leading = node;
+        }
+    }
+
+    double const chord = length(leading - trailing);
+    Vec2 const   reference = leading + 0.25 * (trailing - leading);
+    double const speed = length(vinf);
+
+    double circulation = 0.0;
+    double moment = 0.0;
+    for (std::size_t i = 0; i < panels.size(); ++i) {
+        circulation += midpoint_strength(panels, solution, i) * panels.len[i];
+
+        Vec2 const n{panels.nx[i], panels.ny[i]};
+        Vec2 const f = (-surface.cp[i] * panels.len[i]) * n;
+        Vec2 const r = Vec2{panels.xc[i], panels.yc[i]} - reference;
+        moment += r.x * f.y - r.y * f.x;
+    }
+
+    // Counter-clockwise circulation lifts downwards; nose up is clockwise
+    Loads loads{};
+    loads.cl = -2.0 * circulation / (speed * chord);
+    loads.cm = -moment / (chord * chord);
+
+    return loads;
+}
+
+Polar
+compute_polar(Scene const &               scene,
+              std::vector<double> const & alpha,
+              SolverOptions const &       options)
+{
+    // The surface velocity is linear in the freestream as well, so it is
+    // evaluated for the two unit freestreams solved first and combined
+    std::vector<Vec2> freestreams{{1.0, 0.0}, {0.0, 1.0}};
+    for (double const a : alpha) {
+        freestreams.push_back({std::cos(a), std::sin(a)});
+    }
+
+    std::vector<Solution> const solutions =
+        solve_sweep(scene, freestreams, options);
+
+    Surface const unit_x = compute_surface(
+        scene, solutions[0], freestreams[0], options.quadrature, options.pool);
+    Surface const unit_y = compute_surface(
+        scene, solutions[1], freestreams[1], options.quadrature, options.pool);
+
+    Polar polar{};
+    polar.alpha = alpha;
+    for (std::size_t k = 0; k < alpha.size(); ++k) {
+        Vec2 const & vinf = freestreams[k + 2];
+
+        Surface surface = unit_x;
+        for (std::size_t i = 0; i < surface.velocity.size(); ++i) {
+            surface.velocity[i] =
+                vinf.x * unit_x.velocity[i] + vinf.y * unit_y.velocity[i];
+
+            double const q = surface.velocity[i] / length(vinf);
+            surface.cp[i] = 1.0 - q * q;
+        }
+
+        Loads const loads =
+            compute_loads(scene, solutions[k + 2], surface, vinf);
+        polar.cl.push_back(loads.cl);
+        polar.cm.push_back(loads.cm);
+    }
+
+    return polar;
+}
+
+} // namespace vortisim
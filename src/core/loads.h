@@ -0,0 +1,82 @@
+#ifndef CORE_LOADS_H
+#define CORE_LOADS_H
+
+#include "core/scene.h"
+#include "core/panel.h"
+#include "core/solver.h"
+#include "core/threadpool.h"
+#include "core/vec2.h"
+
+#include <vector>
+
+namespace vortisim {
+
+// Pressure distribution of a solved scene, one entry per panel body after
+// body, at the control points
+struct Surface {
+    std::vector<double> x{};
+    std::vector<double> y{};
+    // Tangential velocity just outside the surface, positive along the panel
+    // direction
+    std::vector<double> velocity{};
+    // 1 - (velocity / |vinf|)^2
+    std::vector<double> cp{};
+};
+
+// The outside velocity is twice the mean of the velocities on both sides of
+// the sheet, from the freestream and all other panels. It equals the
+// strength for an exact solution, but unlike the strength it does not pick up
+// the odd-even oscillation that constant-strength panels with exact
+// influences develop on thin bodies. Inside a trailing edge wedge, where the
+// other surface is too close for its oscillation to cancel, the outside
+// velocity is taken a few panel lengths off the surface instead. Uses a
+// treecode from 256 analytic panels on. A linear sheet has no such
+// oscillation, and its strength at the control point is the outside velocity
+// directly.
+Surface
+compute_surface(Scene const &    scene,
+                Solution const & solution,
+                Vec2 const &     vinf,
+                Quadrature       quadrature = Quadrature::ANALYTIC,
+                ThreadPool *     pool = nullptr);
+
+// Force and moment coefficients of a solved scene. The reference length is
+// the chord of the first body, from its trailing edge node 0 to the node
+// farthest from it, and the moment is taken about its quarter chord.
+struct Loads {
+    // From the Kutta-Joukowski theorem on the total bound circulation
+    double cl{};
+    // Moment of the compute_surface pressures, positive nose up
+    double cm{};
+};
+
+Loads
+compute_loads(Scene const &    scene,
+              Solution const & solution,
+              Vec2 const &     vinf,
+              Quadrature       quadrature = Quadrature::ANALYTIC,
+              ThreadPool *     pool = nullptr);
+
+// Same from an already computed surface distribution
+Loads
+compute_loads(Scene const &    scene,
+              Solution const & solution,
+              Surface const &  surface,
+              Vec2 const &     vinf);
+
+// Lift and moment curves over angles of attack of a unit freestream
+struct Polar {
+    std::vector<double> alpha{};
+    std::vector<double> cl{};
+    std::vector<double> cm{};
+};
+
+// Solves every angle, in radians, through solve_sweep
+Polar
+compute_polar(Scene const &               scene,
+              std::vector<double> const & alpha,
+              SolverOptions const &       options = {});
+
+} // namespace vortisim
+
+#endif // CORE_LOADS_H
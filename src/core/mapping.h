@@ -0,0 +1,88 @@
+#ifndef CORE_MAPPING_H
+#define CORE_MAPPING_H
+
+#include <cstddef>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+namespace vortisim {
+
+// Owns a POSIX file descriptor, closing it on destruction
+class FileDescriptor {
+    int fd_;
+
+public:
+    explicit FileDescriptor(int fd) : fd_{fd} {}
+
+    FileDescriptor(FileDescriptor const &) = delete;
+    FileDescriptor(FileDescriptor &&) noexcept = delete;
+
+    ~FileDescriptor()
+    {
+        if (fd_ >= 0) {
+            ::close(fd_);
+        }
+    }
+
+    FileDescriptor &
+    operator=(FileDescriptor const &) = delete;
+    FileDescriptor &
+    operator=(FileDescriptor &&) noexcept = delete;
+
+    int
+    get() const
+    {
+        return fd_;
+    }
+};
+
+// Shared mapping of a byte range of a file, writable or read-only
+class Mapping {
+    void *      data_;
+    std::size_t size_;
+
+public:
+    Mapping(int fd, off_t offset, std::size_t size, bool writable = true)
+        : data_{::mmap(nullptr,
+                       size,
+                       writable ? PROT_READ | PROT_WRITE : PROT_READ,
+                       MAP_SHARED,
+                       fd,
+                       offset)},
+          size_{size}
+    {
+    }
+
+    Mapping(Mapping const &) = delete;
+    Mapping(Mapping &&) noexcept = delete;
+
+    ~Mapping()
+    {
+        if (data_ != MAP_FAILED) {
+            ::munmap(data_, size_);
+        }
+    }
+
+    Mapping &
+    operator=(Mapping const &) = delete;
+    Mapping &
+    operator=(Mapping &&) noexcept = delete;
+
+    char *
+    data() const
+    {
+        return (data_ == MAP_FAILED) ? nullptr : static_cast<char *>(data_);
+    }
+
+    std::size_t
+    size() const
+    {
+        return size_;
+    }
+};
+
+} // namespace vortisim
+
+#endif // CORE_MAPPING_H
@@ -0,0 +1,109 @@
+#include "core/mixed.h"
+
+#include "core/profiler.h"
+
+#include <utility>
+
+namespace vortisim {
+
+namespace {
+
+// A step that does not at least halve the residual has hit the accuracy of
+// the double residual itself
+constexpr double G_MIN_REDUCTION = 0.5;
+
+} // namespace
+
+MixedSolver::MixedSolver(PanelArrays     panels,
+                         Eigen::MatrixXd a,
+                         Quadrature      quadrature,
+                         ThreadPool *    pool,
+                         Formulation     formulation)
+    : panels_{std::move(panels)},
+      quadrature_{quadrature},
+      pool_{pool},
+      formulation_{formulation},
+      a_double_{std::move(a)},
+      a_{a_double_.cast<float>()},
+      lu_{a_}
+{
+}
+
+MixedSolver::MixedSolver(PanelArrays     panels,
+                         Eigen::MatrixXf a,
+                         Quadrature      quadrature,
+                         ThreadPool *    pool,
+                         Formulation     formulation)
+    : panels_{std::move(panels)},
+      quadrature_{quadrature},
+      pool_{pool},
+      formulation_{formulation},
+      a_{std::move(a)},
+      lu_{a_}
+{
+}
+
+RefinementResult
+MixedSolver::solve(Eigen::VectorXd const &   b,
+                   Eigen::VectorXd &         x,
+                   RefinementOptions const & options) const
+{
+    ScopedTimer const timer{"refinement"};
+
+    RefinementResult result{};
+    double const     b_norm = b.norm();
+
+    // The relative residual is undefined, the solution exact
+    if (b_norm == 0.0) {
+        x = Eigen::VectorXd::Zero(b.size());
+        result.converged = true;
+        return result;
+    }
+
+    x = lu_.solve(b.cast<float>()).cast<double>();
+
+    Eigen::VectorXd r = residual(x, b);
+    result.residual = r.norm() / b_norm;
+
+    while (result.residual > options.tolerance &&
+           result.steps < options.max_steps) {
+        // Correction from the float factors, accumulated in double
+        Eigen::VectorXd const dx = lu_.solve(r.cast<float>()).cast<double>();
+        x += dx;
+
+        Eigen::VectorXd const r_next = residual(x, b);
+        double const residual = r_next.norm() / b_norm;
+
+        if (residual >= result.residual) {
+            x -= dx;
+            break;
+        }
+        ++result.steps;
+
+        bool const stalled = residual > G_MIN_REDUCTION * result.residual;
+        r = r_next;
+        result.residual = residual;
+        if (stalled) {
+            break;
+        }
+    }
+
+    result.converged = result.residual <= options.tolerance;
+
+    return result;
+}
+
+Eigen::VectorXd
+MixedSolver::residual(Eigen::VectorXd const & x,
+                      Eigen::VectorXd const & b) const
+{
+    if (a_double_.size() == 0) {
+        return influence_residual(
+            panels_, x, b, quadrature_, pool_, formulation_);
+    }
+
+    ScopedTimer const timer{"residual"};
+    return b - a_double_ * x;
+}
+
+} // namespace vortisim
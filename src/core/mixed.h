@@ -0,0 +1,82 @@
+#ifndef CORE_MIXED_H
+#define CORE_MIXED_H
+
+#include "core/assembly.h"
+#include "core/panel.h"
+#include "core/threadpool.h"
+
+#include <Eigen/Dense>
+
+namespace vortisim {
+
+struct RefinementOptions {
+    // Relative residual |b - A x| / |b| to stop at
+    double tolerance{1e-12};
+    int    max_steps{10};
+};
+
+struct RefinementResult {
+    // Corrections applied after the first float solve
+    int    steps{};
+    double residual{};
+    bool   converged{false};
+};
+
+// Dense solve in mixed precision: the influence matrix is LU factorized in
+// float, and every solve is refined against the residual in double until it
+// reaches double accuracy. The float factorization moves half the memory
+// and fits twice the values in a SIMD register. Refinement converges while
+// the condition number stays well below 1 / float epsilon, about 10^7.
+class MixedSolver {
+public:
+    // Factorizes a float copy of a and keeps a, so that every residual is a
+    // matrix-vector product
+    MixedSolver(PanelArrays     panels,
+                Eigen::MatrixXd a,
+                Quadrature      quadrature = Quadrature::ANALYTIC,
+                ThreadPool *    pool = nullptr,
+                Formulation     formulation = Formulation::CONSTANT);
+
+    // Factorizes a in place, half the memory of the double matrix. Every
+    // residual assembles the double coefficients again, block by block.
+    MixedSolver(PanelArrays     panels,
+                Eigen::MatrixXf a,
+                Quadrature      quadrature = Quadrature::ANALYTIC,
+                ThreadPool *    pool = nullptr,
+                Formulation     formulation = Formulation::CONSTANT);
+
+    MixedSolver(MixedSolver const &) = delete;
+    MixedSolver(MixedSolver &&) noexcept = delete;
+
+    ~MixedSolver() = default;
+
+    MixedSolver &
+    operator=(MixedSolver const &) = delete;
+    MixedSolver &
+    operator=(MixedSolver &&) noexcept = delete;
+
+    // x = 0 for b = 0
+    RefinementResult
+    solve(Eigen::VectorXd const &   b,
+          Eigen::VectorXd &         x,
+          RefinementOptions const & options = {}) const;
+
+private:
+    Eigen::VectorXd
+    residual(Eigen::VectorXd const & x, Eigen::VectorXd const & b) const;
+
+    PanelArrays  panels_;
+    Quadrature   quadrature_;
+    ThreadPool * pool_;
+    Formulation  formulation_;
+
+    // Double matrix of the residuals, empty when they are assembled
+    Eigen::MatrixXd a_double_{};
+    // Holds the factors; lu_ refers to it
+    Eigen::MatrixXf                                  a_;
+    Eigen::PartialPivLU<Eigen::Ref<Eigen::MatrixXf>> lu_;
+};
+
+} // namespace vortisim
+
+#endif // CORE_MIXED_H
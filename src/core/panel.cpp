@@ -0,0 +1,152 @@
+#include "core/panel.h"
+
+#include <cmath>
+
+namespace vortisim {
+
+namespace {
+
+constexpr double G_PI = 3.14159265358979;
+constexpr double G_TAU = 2.0 * G_PI;
+
+Vec2
+analytic_velocity(Vec2 const & p1, Vec2 const & p2, Vec2 const & p)
+{
+    Vec2 const   diff = p2 - p1;
+    double const len = length(diff);
+    Vec2 const   t = (1.0 / len) * diff;
+    Vec2 const   n{-t.y, t.x};
+
+    // Panel-local coordinates, panel along [0, len] on the x axis
+    Vec2 const   d = p - p1;
+    double const x = dot(d, t);
+    double const y = dot(d, n);
+
+    double const r1_sq = x * x + y * y;
+    double const r2_sq = (x - len) * (x - len) + y * y;
+
+    // Angle subtended by the panel, theta2 - theta1, in a single atan2
+    double const dtheta = std::atan2(y * len, x * (x - len) + y * y);
+
+    double const u = -dtheta / G_TAU;
+    double const v = std::log(r1_sq / r2_sq) / (2.0 * G_TAU);
+
+    return u * t + v * n;
+}
+
+Vec2
+riemann_velocity(Vec2 const & p1, Vec2 const & p2, Vec2 const & p)
+{
+    constexpr int    integrator_steps = 30;
+    constexpr double slice = 1.0 / static_cast<double>(integrator_steps);
+
+    Vec2 const delta = slice * (p2 - p1);
+
+    Vec2 ans{};
+    for (int i = 0; i < integrator_steps; ++i) {
+        Vec2 const current_pos = p1 + static_cast<double>(i) * delta;
+
+        Vec2 const   r = p - current_pos;
+        double const denom = dot(r, r);
+
+        ans += (1.0 / denom) * Vec2{current_pos.y - p.y, p.x - current_pos.x};
+    }
+
+    return (length(delta) / G_TAU) * ans;
+}
+
+LinearPanelVelocity
+analytic_linear_velocity(Vec2 const & p1, Vec2 const & p2, Vec2 const & p)
+{
+    Vec2 const   diff = p2 - p1;
+    double const len = length(diff);
+    Vec2 const   t = (1.0 / len) * diff;
+    Vec2 const   n{-t.y, t.x};
+
+    Vec2 const   d = p - p1;
+    double const x = dot(d, t);
+    double const y = dot(d, n);
+
+    double const r1_sq = x * x + y * y;
+    double const r2_sq = (x - len) * (x - len) + y * y;
+
+    double const dtheta = std::atan2(y * len, x * (x - len) + y * y);
+    double const log_ratio = 0.5 * std::log(r1_sq / r2_sq);
+
+    // Strength x / len rising towards p2; the constant part is the rest
+    double const scale = 1.0 / (G_TAU * len);
+    double const u_end = -scale * (x * dtheta - y * log_ratio);
+    double const v_end = scale * (x * log_ratio - len + y * dtheta);
+    double const u_start = -dtheta / G_TAU - u_end;
+    double const v_start = log_ratio / G_TAU - v_end;
+
+    return {u_start * t + v_start * n, u_end * t + v_end * n};
+}
+
+LinearPanelVelocity
+riemann_linear_velocity(Vec2 const & p1, Vec2 const & p2, Vec2 const & p)
+{
+    constexpr int    integrator_steps = 30;
+    constexpr double slice = 1.0 / static_cast<double>(integrator_steps);
+
+    Vec2 const delta = slice * (p2 - p1);
+
+    LinearPanelVelocity ans{};
+    for (int i = 0; i < integrator_steps; ++i) {
+        double const s = static_cast<double>(i) * slice;
+        Vec2 const   current_pos = p1 + static_cast<double>(i) * delta;
+
+        Vec2 const   r = p - current_pos;
+        double const denom = dot(r, r);
+        Vec2 const   v =
+            (1.0 / denom) * Vec2{current_pos.y - p.y, p.x - current_pos.x};
+
+        ans.start += (1.0 - s) * v;
+        ans.end += s * v;
+    }
+
+    double const scale = length(delta) / G_TAU;
+
+    return {scale * ans.start, scale * ans.end};
+}
+
+} // namespace
+
+Vec2
+panel_velocity(Vec2 const & p1,
+               Vec2 const & p2,
+               Vec2 const & p,
+               Quadrature   quadrature)
+{
+    switch (quadrature) {
+        case Quadrature::ANALYTIC: return analytic_velocity(p1, p2, p);
+        case Quadrature::RIEMANN: return riemann_velocity(p1, p2, p);
+    }
+
+    return {};
+}
+
+LinearPanelVelocity
+linear_panel_velocity(Vec2 const & p1,
+                      Vec2 const & p2,
+                      Vec2 const & p,
+                      Quadrature   quadrature)
+{
+    switch (quadrature) {
+        case Quadrature::ANALYTIC: return analytic_linear_velocity(p1, p2, p);
+        case Quadrature::RIEMANN: return riemann_linear_velocity(p1, p2, p);
+    }
+
+    return {};
+}
+
+Vec2
+particle_velocity(Vec2 const & q, Vec2 const & p, double core)
+{
+    Vec2 const   r = p - q;
+    double const denom = G_TAU * (dot(r, r) + core * core);
+
+    return (1.0 / denom) * Vec2{-r.y, r.x};
+}
+
+} // namespace vortisim
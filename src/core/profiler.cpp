@@ -0,0 +1,153 @@
+#include "core/profiler.h"
+
+#include <algorithm>
+#include <fstream>
+
+namespace vortisim {
+
+namespace {
+
+// Events kept for the trace, about a minute of interactive use
+constexpr std::size_t G_MAX_EVENTS = std::size_t{1} << 16;
+
+double
+to_us(Profiler::Clock::duration d)
+{
+    return std::chrono::duration<double, std::micro>(d).count();
+}
+
+} // namespace
+
+Profiler &
+Profiler::instance()
+{
+    static Profiler profiler;
+    return profiler;
+}
+
+void
+Profiler::setEnabled(bool enabled)
+{
+    enabled_.store(enabled, std::memory_order_relaxed);
+}
+
+void
+Profiler::record(Event const & event)
+{
+    double const ms =
+        std::chrono::duration<double, std::milli>(event.duration).count();
+
+    std::lock_guard<std::mutex> lock{mutex_};
+
+    if (events_.size() < G_MAX_EVENTS) {
+        events_.push_back(event);
+    } else {
+        events_[next_event_] = event;
+        next_event_ = (next_event_ + 1) % G_MAX_EVENTS;
+    }
+
+    Window & window = windows_[event.name];
+    window.samples[window.next] = ms;
+    window.next = (window.next + 1) % window.samples.size();
+    window.count = std::min(window.count + 1, window.samples.size());
+}
+
+double
+Profiler::meanMs(std::string const & name) const
+{
+    std::lock_guard<std::mutex> lock{mutex_};
+
+    auto const it = windows_.find(name);
+    if (it == windows_.end() || it->second.count == 0) {
+        return -1.0;
+    }
+
+    Window const & window = it->second;
+    double         sum = 0.0;
+    for (std::size_t i = 0; i < window.count; ++i) {
+        sum += window.samples[i];
+    }
+
+    return sum / static_cast<double>(window.count);
+}
+
+bool
+Profiler::writeTrace(std::filesystem::path const & path) const
+{
+    std::vector<Event> events;
+    {
+        std::lock_guard<std::mutex> lock{mutex_};
+        events = events_;
+    }
+
+    auto const earlier = [](Event const & a, Event const & b) {
+        return a.start < b.start;
+    };
+    std::sort(events.begin(), events.end(), earlier);
+
+    std::ofstream out{path, std::ios::trunc};
+
+    // Complete events in microseconds since the profiler started, all in one
+    // process; the GPU track gets a name
+    out << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n"
+        << "  {\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 0, "
+        << "\"tid\": " << GPU_TRACK << ", \"args\": {\"name\": \"GPU\"}}";
+
+    out.precision(3);
+    out << std::fixed;
+    for (Event const & event : events) {
+        out << ",\n  {\"name\": \"" << event.name << "\", \"cat\": \""
+            << event.category << "\", \"ph\": \"X\", \"pid\": 0, \"tid\": "
+            << event.track << ", \"ts\": " << to_us(event.start - epoch_)
+            << ", \"dur\": " << to_us(event.duration) << '}';
+    }
+    out << "\n]}\n";
+
+    return static_cast<bool>(out);
+}
+
+void
+Profiler::clear()
+{
+    std::lock_guard<std::mutex> lock{mutex_};
+
+    events_.clear();
+    next_event_ = 0;
+    windows_.clear();
+}
+
+std::uint32_t
+Profiler::currentTrack()
+{
+    // GPU_TRACK is never handed out
+    static std::atomic<std::uint32_t> next_track{GPU_TRACK + 1};
+    thread_local std::uint32_t const  track =
+        next_track.fetch_add(1, std::memory_order_relaxed);
+
+    return track;
+}
+
+ScopedTimer::ScopedTimer(char const * name, char const * category)
+    : name_{name},
+      category_{category},
+      active_{Profiler::instance().enabled()}
+{
+    if (active_) {
+        start_ = Profiler::Clock::now();
+    }
+}
+
+ScopedTimer::~ScopedTimer()
+{
+    if (!active_) {
+        return;
+    }
+
+    Profiler::instance().record({name_,
+                                 category_,
+                                 start_,
+                                 Profiler::Clock::now() - start_,
+                                 Profiler::currentTrack()});
+}
+
+} // namespace vortisim
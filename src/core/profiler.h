@@ -0,0 +1,126 @@
+#ifndef CORE_PROFILER_H
+#define CORE_PROFILER_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace vortisim {
+
+// Wall times of named regions, collected process-wide. Disabled by default,
+// which leaves a timer at one relaxed load. An enabled profiler keeps the
+// most recent regions for a trace and a rolling mean per name.
+class Profiler {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // Track of regions timed on the GPU rather than on a thread
+    static constexpr std::uint32_t GPU_TRACK = 0;
+
+    struct Event {
+        // Static strings, usually literals
+        char const * name{};
+        char const * category{};
+
+        Clock::time_point start{};
+        Clock::duration   duration{};
+        std::uint32_t     track{};
+    };
+
+    static Profiler &
+    instance();
+
+    Profiler(Profiler const &) = delete;
+    Profiler(Profiler &&) noexcept = delete;
+
+    ~Profiler() = default;
+
+    Profiler &
+    operator=(Profiler const &) = delete;
+    Profiler &
+    operator=(Profiler &&) noexcept = delete;
+
+    bool
+    enabled() const
+    {
+        return enabled_.load(std::memory_order_relaxed);
+    }
+
+    void
+    setEnabled(bool enabled);
+
+    void
+    record(Event const & event);
+
+    // Mean of the latest regions of that name in milliseconds, negative when
+    // there are none
+    double
+    meanMs(std::string const & name) const;
+
+    // Chrome trace event format, for chrome://tracing or Perfetto
+    bool
+    writeTrace(std::filesystem::path const & path) const;
+
+    void
+    clear();
+
+    // Small number identifying the calling thread in traces
+    static std::uint32_t
+    currentTrack();
+
+private:
+    Profiler() = default;
+
+    // Latest durations of one name in milliseconds
+    struct Window {
+        std::array<double, 64> samples{};
+        std::size_t            count{};
+        std::size_t            next{};
+    };
+
+    std::atomic<bool> enabled_{false};
+
+    mutable std::mutex mutex_{};
+
+    // Ring of the latest events, oldest at next_event_ once full
+    std::vector<Event> events_{};
+    std::size_t        next_event_{};
+
+    std::unordered_map<std::string, Window> windows_{};
+
+    Clock::time_point const epoch_{Clock::now()};
+};
+
+// Records the region from construction to destruction on the calling thread
+class ScopedTimer {
+public:
+    explicit ScopedTimer(char const * name, char const * category = "cpu");
+
+    ScopedTimer() = delete;
+    ScopedTimer(ScopedTimer const &) = delete;
+    ScopedTimer(ScopedTimer &&) noexcept = delete;
+
+    ~ScopedTimer();
+
+    ScopedTimer &
+    operator=(ScopedTimer const &) = delete;
+    ScopedTimer &
+    operator=(ScopedTimer &&) noexcept = delete;
+
+private:
+    char const *                name_;
+    char const *                category_;
+    Profiler::Clock::time_point start_{};
+    bool                        active_;
+};
+
+} // namespace vortisim
+
+#endif // CORE_PROFILER_H
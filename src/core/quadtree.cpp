@@ -0,0 +1,407 @@
+#include "core/quadtree.h"
+
+#include <algorithm>
+#include <cassert>
+#include <functional>
+#include <queue>
+#include <utility>
+
+namespace vortisim {
+
+namespace {
+
+// Deep enough for points 1e-9 apart in a unit box
+constexpr std::size_t G_MAX_DEPTH = 32;
+
+Vec2
+min(Vec2 const & a, Vec2 const & b)
+{
+    return {std::min(a.x, b.x), std::min(a.y, b.y)};
+}
+
+Vec2
+max(Vec2 const & a, Vec2 const & b)
+{
+    return {std::max(a.x, b.x), std::max(a.y, b.y)};
+}
+
+double
+box_distance2(Vec2 const & p, Vec2 const & lo, Vec2 const & hi)
+{
+    double const dx = std::max({lo.x - p.x, 0.0, p.x - hi.x});
+    double const dy = std::max({lo.y - p.y, 0.0, p.y - hi.y});
+
+    return dx * dx + dy * dy;
+}
+
+double
+segment_distance2(Vec2 const & p, Vec2 const & a, Vec2 const & b)
+{
+    Vec2 const   ab = b - a;
+    Vec2 const   ap = p - a;
+    double const l2 = dot(ab, ab);
+
+    double const t = (l2 > 0.0) ? std::clamp(dot(ap, ab) / l2, 0.0, 1.0) : 0.0;
+    Vec2 const   d = ap - t * ab;
+
+    return dot(d, d);
+}
+
+} // namespace
+
+Quadtree::Quadtree(Vec2 const & lo, Vec2 const & hi, std::size_t leaf_size)
+    : leaf_size_{leaf_size}
+{
+    assert(lo.x < hi.x && lo.y < hi.y && leaf_size_ > 0);
+
+    root_ = newNode(lo, hi, NONE);
+}
+
+std::uint32_t
+Quadtree::newNode(Vec2 const & lo, Vec2 const & hi, std::uint32_t parent)
+{
+    Node node{};
+    node.lo = lo;
+    node.hi = hi;
+    node.center = 0.5 * (lo + hi);
+    node.parent = parent;
+
+    if (!free_.empty()) {
+        std::uint32_t const index = free_.back();
+        free_.pop_back();
+        nodes_[index] = std::move(node);
+        return index;
+    }
+
+    nodes_.push_back(std::move(node));
+    return static_cast<std::uint32_t>(nodes_.size() - 1);
+}
+
+int
+Quadtree::quadrant(std::uint32_t node, Vec2 const & lo, Vec2 const & hi) const
+{
+    Node const & n = nodes_[node];
+    if (n.children[0] == NONE) {
+        return -1;
+    }
+
+    int const qx = (lo.x >= n.center.x) ? 1 : ((hi.x < n.center.x) ? 0 : -1);
+    int const qy = (lo.y >= n.center.y) ? 1 : ((hi.y < n.center.y) ? 0 : -1);
+
+    return (qx < 0 || qy < 0) ? -1 : qx + 2 * qy;
+}
+
+bool
+Quadtree::fits(std::uint32_t node, Vec2 const & lo, Vec2 const & hi) const
+{
+    Node const & n = nodes_[node];
+
+    return lo.x >= n.lo.x && lo.y >= n.lo.y && hi.x <= n.hi.x &&
+           hi.y <= n.hi.y;
+}
+
+void
+Quadtree::grow(Vec2 const & lo, Vec2 const & hi)
+{
+    std::uint32_t const old = root_;
+    Vec2 const          old_lo = nodes_[old].lo;
+    Vec2 const          old_hi = nodes_[old].hi;
+    Vec2 const          size = old_hi - old_lo;
+
+    // The old root becomes the quadrant away from the box, its corner is the
+    // center of the new root
+    bool const left = lo.x < old_lo.x || hi.x <= old_hi.x;
+    bool const down = lo.y < old_lo.y || hi.y <= old_hi.y;
+
+    Vec2 const new_lo{left ? old_lo.x - size.x : old_lo.x,
+                      down ? old_lo.y - size.y : old_lo.y};
+    Vec2 const new_hi{left ? old_hi.x : old_hi.x + size.x,
+                      down ? old_hi.y : old_hi.y + size.y};
+
+    root_ = newNode(new_lo, new_hi, NONE);
+    nodes_[root_].center = {left ? old_lo.x : old_hi.x,
+                            down ? old_lo.y : old_hi.y};
+    nodes_[root_].count = nodes_[old].count;
+    nodes_[old].parent = root_;
+
+    Vec2 const c = nodes_[root_].center;
+    int const  old_quadrant = (left ? 1 : 0) + 2 * (down ? 1 : 0);
+    for (int q = 0; q < 4; ++q) {
+        std::uint32_t child = old;
+        if (q != old_quadrant) {
+            Vec2 const q_lo{(q % 2 == 0) ? new_lo.x : c.x,
+                            (q / 2 == 0) ? new_lo.y : c.y};
+            Vec2 const q_hi{(q % 2 == 0) ? c.x : new_hi.x,
+                            (q / 2 == 0) ? c.y : new_hi.y};
+            child = newNode(q_lo, q_hi, root_);
+        }
+        nodes_[root_].children[static_cast<std::size_t>(q)] = child;
+    }
+}
+
+void
+Quadtree::place(std::uint32_t node, std::size_t id)
+{
+    std::vector<std::size_t> & items = nodes_[node].items;
+
+    items_[id].node = node;
+    items_[id].slot = static_cast<std::uint32_t>(items.size());
+    items.push_back(id);
+}
+
+void
+Quadtree::unplace(std::size_t id)
+{
+    Item &                     item = items_[id];
+    std::vector<std::size_t> & items = nodes_[item.node].items;
+
+    items[item.slot] = items.back();
+    items_[items.back()].slot = item.slot;
+    items.pop_back();
+
+    item.node = NONE;
+}
+
+void
+Quadtree::split(std::uint32_t node, std::size_t depth)
+{
+    if (depth >= G_MAX_DEPTH) {
+        return;
+    }
+
+    Vec2 const lo = nodes_[node].lo;
+    Vec2 const hi = nodes_[node].hi;
+    Vec2 const c = nodes_[node].center;
+    for (int q = 0; q < 4; ++q) {
+        Vec2 const q_lo{(q % 2 == 0) ? lo.x : c.x, (q / 2 == 0) ? lo.y : c.y};
+        Vec2 const q_hi{(q % 2 == 0) ? c.x : hi.x, (q / 2 == 0) ? c.y : hi.y};
+
+        std::uint32_t const child = newNode(q_lo, q_hi, node);
+        nodes_[node].children[static_cast<std::size_t>(q)] = child;
+    }
+
+    // Items straddling the center stay
+    std::vector<std::size_t> items = std::move(nodes_[node].items);
+    nodes_[node].items.clear();
+    for (std::size_t const id : items) {
+        Item const & item = items_[id];
+        int const    q =
+            quadrant(node, min(item.a, item.b), max(item.a, item.b));
+
+        std::uint32_t target = node;
+        if (q >= 0) {
+            target = nodes_[node].children[static_cast<std::size_t>(q)];
+            ++nodes_[target].count;
+        }
+        place(target, id);
+    }
+
+    for (std::size_t q = 0; q < 4; ++q) {
+        std::uint32_t const child = nodes_[node].children[q];
+        if (nodes_[child].items.size() > leaf_size_) {
+            split(child, depth + 1);
+        }
+    }
+}
+
+void
+Quadtree::collapse(std::uint32_t node)
+{
+    std::vector<std::uint32_t> stack;
+    for (std::uint32_t const child : nodes_[node].children) {
+        stack.push_back(child);
+    }
+    nodes_[node].children.fill(NONE);
+
+    while (!stack.empty()) {
+        std::uint32_t const n = stack.back();
+        stack.pop_back();
+
+        for (std::size_t const id : nodes_[n].items) {
+            place(node, id);
+        }
+        for (std::uint32_t const child : nodes_[n].children) {
+            if (child != NONE) {
+                stack.push_back(child);
+            }
+        }
+
+        nodes_[n] = Node{};
+        free_.push_back(n);
+    }
+}
+
+void
+Quadtree::insert(std::size_t id, Vec2 const & a, Vec2 const & b)
+{
+    assert(std::isfinite(a.x) && std::isfinite(a.y) && std::isfinite(b.x) &&
+           std::isfinite(b.y));
+
+    if (id >= items_.size()) {
+        items_.resize(id + 1);
+    }
+    assert(items_[id].node == NONE);
+
+    items_[id].a = a;
+    items_[id].b = b;
+
+    Vec2 const lo = min(a, b);
+    Vec2 const hi = max(a, b);
+    while (!fits(root_, lo, hi)) {
+        grow(lo, hi);
+    }
+
+    std::uint32_t node = root_;
+    std::size_t   depth = 0;
+    ++nodes_[node].count;
+    for (int q = quadrant(node, lo, hi); q >= 0; q = quadrant(node, lo, hi)) {
+        node = nodes_[node].children[static_cast<std::size_t>(q)];
+        ++nodes_[node].count;
+        ++depth;
+    }
+
+    place(node, id);
+
+    if (nodes_[node].children[0] == NONE &&
+        nodes_[node].items.size() > leaf_size_) {
+        split(node, depth);
+    }
+}
+
+void
+Quadtree::move(std::size_t id, Vec2 const & a, Vec2 const & b)
+{
+    assert(contains(id));
+
+    // Stays put while still inside its node and not inside one of its children
+    Item &     item = items_[id];
+    Vec2 const lo = min(a, b);
+    Vec2 const hi = max(a, b);
+    if (fits(item.node, lo, hi) && quadrant(item.node, lo, hi) < 0) {
+        item.a = a;
+        item.b = b;
+        return;
+    }
+
+    remove(id);
+    insert(id, a, b);
+}
+
+void
+Quadtree::remove(std::size_t id)
+{
+    assert(contains(id));
+
+    std::uint32_t const node = items_[id].node;
+    unplace(id);
+
+    for (std::uint32_t n = node; n != NONE; n = nodes_[n].parent) {
+        --nodes_[n].count;
+    }
+
+    // Merges the highest ancestor that dropped to half a leaf, the counts only
+    // grow towards the root
+    std::uint32_t candidate = NONE;
+    for (std::uint32_t n = node;
+         n != NONE && nodes_[n].count <= leaf_size_ / 2;
+         n = nodes_[n].parent) {
+        if (nodes_[n].children[0] != NONE) {
+            candidate = n;
+        }
+    }
+    if (candidate != NONE) {
+        collapse(candidate);
+    }
+}
+
+void
+Quadtree::clear()
+{
+    Vec2 const lo = nodes_[root_].lo;
+    Vec2 const hi = nodes_[root_].hi;
+
+    nodes_.clear();
+    free_.clear();
+    items_.clear();
+
+    root_ = newNode(lo, hi, NONE);
+}
+
+std::optional<std::size_t>
+Quadtree::nearest(Vec2 const & p, double max_distance) const
+{
+    using Entry = std::pair<double, std::uint32_t>;
+
+    // Best first over the nodes, a node box bounds the distance of its items
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<>> queue;
+    queue.emplace(box_distance2(p, nodes_[root_].lo, nodes_[root_].hi), root_);
+
+    std::optional<std::size_t> result;
+    double                     best = max_distance * max_distance;
+    while (!queue.empty()) {
+        auto const [distance, node] = queue.top();
+        queue.pop();
+
+        if (distance > best) {
+            break;
+        }
+
+        Node const & n = nodes_[node];
+        for (std::size_t const id : n.items) {
+            double const d = segment_distance2(p, items_[id].a, items_[id].b);
+            if (result ? d < best : d <= best) {
+                best = d;
+                result = id;
+            }
+        }
+
+        for (std::uint32_t const child : n.children) {
+            if (child == NONE || nodes_[child].count == 0) {
+                continue;
+            }
+
+            double const d =
+                box_distance2(p, nodes_[child].lo, nodes_[child].hi);
+            if (d <= best) {
+                queue.emplace(d, child);
+            }
+        }
+    }
+
+    return result;
+}
+
+void
+Quadtree::query(Vec2 const &               lo,
+                Vec2 const &               hi,
+                std::vector<std::size_t> & ids) const
+{
+    auto const overlaps = [&lo, &hi](Vec2 const & a, Vec2 const & b) {
+        return a.x <= hi.x && a.y <= hi.y && b.x >= lo.x && b.y >= lo.y;
+    };
+
+    std::vector<std::uint32_t> stack{root_};
+    while (!stack.empty()) {
+        Node const & n = nodes_[stack.back()];
+        stack.pop_back();
+
+        if (n.count == 0 || !overlaps(n.lo, n.hi)) {
+            continue;
+        }
+
+        for (std::size_t const id : n.items) {
+            Item const & item = items_[id];
+            if (overlaps(min(item.a, item.b), max(item.a, item.b))) {
+                ids.push_back(id);
+            }
+        }
+
+        for (std::uint32_t const child : n.children) {
+            if (child != NONE) {
+                stack.push_back(child);
+            }
+        }
+    }
+}
+
+} // namespace vortisim
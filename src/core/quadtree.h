@@ -0,0 +1,139 @@
+#ifndef CORE_QUADTREE_H
+#define CORE_QUADTREE_H
+
+#include "core/vec2.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <vector>
+
+namespace vortisim {
+
+// Dynamic quadtree over segments identified by caller-chosen indices; a point
+// is a segment of zero length. Every item lives in the smallest node whose
+// box contains it, so insertion, moves and removal only touch one path from
+// the root. The root grows to fit items outside of it and children of nodes
+// that run low on items are merged back.
+class Quadtree {
+public:
+    // Initial root box, widened on demand
+    explicit Quadtree(Vec2 const & lo = {-1.0, -1.0},
+                      Vec2 const & hi = {1.0, 1.0},
+                      std::size_t  leaf_size = 8);
+
+    void
+    insert(std::size_t id, Vec2 const & a, Vec2 const & b);
+
+    void
+    insert(std::size_t id, Vec2 const & p)
+    {
+        insert(id, p, p);
+    }
+
+    // Changes the geometry of an item, cheap while it stays in its node
+    void
+    move(std::size_t id, Vec2 const & a, Vec2 const & b);
+
+    void
+    move(std::size_t id, Vec2 const & p)
+    {
+        move(id, p, p);
+    }
+
+    void
+    remove(std::size_t id);
+
+    bool
+    contains(std::size_t id) const
+    {
+        return id < items_.size() && items_[id].node != NONE;
+    }
+
+    std::size_t
+    size() const
+    {
+        return nodes_[root_].count;
+    }
+
+    void
+    clear();
+
+    // Item closest to p no further than max_distance away
+    std::optional<std::size_t>
+    nearest(Vec2 const & p,
+            double       max_distance =
+                std::numeric_limits<double>::infinity()) const;
+
+    // Appends the items whose bounding boxes intersect the box
+    void
+    query(Vec2 const &               lo,
+          Vec2 const &               hi,
+          std::vector<std::size_t> & ids) const;
+
+private:
+    static constexpr std::uint32_t NONE =
+        std::numeric_limits<std::uint32_t>::max();
+
+    struct Item {
+        Vec2          a{};
+        Vec2          b{};
+        std::uint32_t node{NONE};
+        std::uint32_t slot{};
+    };
+
+    struct Node {
+        Vec2          lo{};
+        Vec2          hi{};
+        // Corner shared by the children, the middle unless the root grew
+        Vec2          center{};
+        std::uint32_t parent{NONE};
+        // All NONE for a leaf
+        std::array<std::uint32_t, 4> children{NONE, NONE, NONE, NONE};
+        // Items in the subtree
+        std::size_t              count{};
+        std::vector<std::size_t> items{};
+    };
+
+    std::uint32_t
+    newNode(Vec2 const & lo, Vec2 const & hi, std::uint32_t parent);
+
+    // Child quadrant containing the box entirely, or -1
+    int
+    quadrant(std::uint32_t node, Vec2 const & lo, Vec2 const & hi) const;
+
+    bool
+    fits(std::uint32_t node, Vec2 const & lo, Vec2 const & hi) const;
+
+    // Doubles the root towards the box
+    void
+    grow(Vec2 const & lo, Vec2 const & hi);
+
+    void
+    place(std::uint32_t node, std::size_t id);
+
+    void
+    unplace(std::size_t id);
+
+    void
+    split(std::uint32_t node, std::size_t depth);
+
+    // Moves the items of all descendants into the node and frees them
+    void
+    collapse(std::uint32_t node);
+
+    std::size_t leaf_size_;
+
+    std::vector<Node>          nodes_{};
+    std::vector<std::uint32_t> free_{};
+    std::uint32_t              root_{};
+
+    // Indexed by id
+    std::vector<Item> items_{};
+};
+
+} // namespace vortisim
+
+#endif // CORE_QUADTREE_H
@@ -0,0 +1,424 @@
+#include "core/repanel.h"
+
+#include "core/loads.h"
+#include "core/profiler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <iterator>
+#include <utility>
+
+namespace vortisim {
+
+namespace {
+
+constexpr double G_PI = 3.14159265358979;
+
+// Panel count of every adaptive step over that of the previous one
+constexpr double G_GROWTH = 1.5;
+// Share of the node density spread evenly along the outline
+constexpr double G_BACKGROUND = 0.5;
+// Largest ratio of the lengths of neighbouring panels
+constexpr double G_GRADING = 1.25;
+// Passes of the [1 2 1] filter over the node density
+constexpr int G_SMOOTHING = 8;
+
+// The input polyline of a body by arc length
+struct Outline {
+    std::vector<Vec2> points{};
+    // Arc length at every node, closed by the total length at the end
+    std::vector<double> arc{};
+    // Of the leading edge, the node farthest from node 0
+    double le{};
+    // Arc lengths of the corners, node 0 first
+    std::vector<double> corners{};
+
+    double
+    length() const
+    {
+        return arc.back();
+    }
+
+    Vec2
+    pointAt(double s) const
+    {
+        auto const        it = std::upper_bound(arc.begin(), arc.end(), s);
+        std::size_t const i =
+            std::min(static_cast<std::size_t>(it - arc.begin()),
+                     points.size()) -
+            1;
+
+        double const span = arc[i + 1] - arc[i];
+        double const t = span > 0.0 ? (s - arc[i]) / span : 0.0;
+        Vec2 const & a = points[i];
+        Vec2 const & b = points[(i + 1) % points.size()];
+
+        return a + t * (b - a);
+    }
+};
+
+// Nodes of a body as arc lengths along its outline, increasing from 0.
+// Fixed nodes are corners and are never removed.
+struct Layout {
+    std::vector<double> s{};
+    std::vector<bool>   fixed{};
+};
+
+Outline
+make_outline(Body const & body, double corner_angle)
+{
+    Outline outline;
+    outline.points = body.nodes;
+
+    std::size_t const n = body.nodes.size();
+    outline.arc.resize(n + 1);
+    for (std::size_t i = 0; i < n; ++i) {
+        outline.arc[i + 1] =
+            outline.arc[i] + length(body.panelEnd(i) - body.panelStart(i));
+    }
+
+    double le_distance = 0.0;
+    for (std::size_t i = 1; i < n; ++i) {
+        double const d = length(body.nodes[i] - body.nodes[0]);
+        if (d > le_distance) {
+            outline.le = outline.arc[i];
+            le_distance = d;
+        }
+    }
+
+    outline.corners.push_back(0.0);
+    for (std::size_t i = 1; i < n; ++i) {
+        Vec2 const in = body.nodes[i] - body.nodes[i - 1];
+        Vec2 const out = body.panelEnd(i) - body.nodes[i];
+
+        double const cross = in.x * out.y - in.y * out.x;
+        if (std::abs(std::atan2(cross, dot(in, out))) > corner_angle) {
+            outline.corners.push_back(outline.arc[i]);
+        }
+    }
+
+    return outline;
+}
+
+// Distance along the closed outline
+double
+arc_distance(double a, double b, double total)
+{
+    double const d = std::abs(a - b);
+    return std::min(d, total - d);
+}
+
+Layout
+cosine_layout(Outline const & outline, std::size_t panels)
+{
+    double const total = outline.length();
+
+    // Each side of the leading edge gets its share of the panels by length
+    std::size_t const n = std::max<std::size_t>(panels, 4);
+    auto const        share = static_cast<std::size_t>(
+        std::lround(static_cast<double>(n) * outline.le / total));
+    std::size_t const m1 = std::clamp<std::size_t>(share, 1, n - 1);
+    std::size_t const m2 = n - m1;
+
+    std::vector<double> spaced;
+    spaced.reserve(n);
+    for (std::size_t k = 0; k < m1; ++k) {
+        double const t =
+            G_PI * static_cast<double>(k) / static_cast<double>(m1);
+        spaced.push_back(0.5 * outline.le * (1.0 - std::cos(t)));
+    }
+    for (std::size_t k = 0; k < m2; ++k) {
+        double const t =
+            G_PI * static_cast<double>(k) / static_cast<double>(m2);
+        spaced.push_back(outline.le +
+                         0.5 * (total - outline.le) * (1.0 - std::cos(t)));
+    }
+
+    // Spaced nodes within half their spacing of a corner give way to it
+    std::vector<double> kept;
+    kept.reserve(n);
+    for (std::size_t k = 0; k < n; ++k) {
+        double const prev = spaced[(k + n - 1) % n];
+        double const next = spaced[(k + 1) % n];
+        double const h = std::min(arc_distance(spaced[k], prev, total),
+                                  arc_distance(spaced[k], next, total));
+
+        auto const near = [&spaced, k, h, total](double corner) {
+            return arc_distance(spaced[k], corner, total) < 0.5 * h;
+        };
+        if (std::none_of(
+                outline.corners.begin(), outline.corners.end(), near)) {
+            kept.push_back(spaced[k]);
+        }
+    }
+
+    Layout      layout;
+    std::size_t i = 0;
+    std::size_t j = 0;
+    while (i < kept.size() || j < outline.corners.size()) {
+        bool const corner =
+            j < outline.corners.size() &&
+            (i == kept.size() || outline.corners[j] < kept[i]);
+        layout.s.push_back(corner ? outline.corners[j++] : kept[i++]);
+        layout.fixed.push_back(corner);
+    }
+
+    return layout;
+}
+
+Body
+build_body(Outline const & outline, Layout const & layout)
+{
+    Body body;
+    body.nodes.reserve(layout.s.size());
+    for (double const s : layout.s) {
+        body.nodes.push_back(outline.pointAt(s));
+    }
+
+    // Node 0 is the trailing edge by construction, and the graded panels
+    // there would excite the odd-even mode under a trailing edge Kutta row
+    body.kutta_row = KuttaRow::OPPOSITE;
+
+    return body;
+}
+
+// Length times the jump of the surface velocity over the neighbouring
+// panels, one-sided at the trailing edge where the two surfaces meet
+void
+add_indicator(Body const &          body,
+              double const *        velocity,
+              std::vector<double> & eta)
+{
+    std::size_t const n = body.panelCount();
+    for (std::size_t i = 0; i < n; ++i) {
+        std::size_t const lo = i == 0 ? 0 : i - 1;
+        std::size_t const hi = i + 1 == n ? i : i + 1;
+        double const      jump = (velocity[hi] - velocity[lo]) /
+                            static_cast<double>(hi - lo);
+
+        double const len = length(body.panelEnd(i) - body.panelStart(i));
+        eta.push_back(len * std::abs(jump));
+    }
+}
+
+// Node density along the outline, per panel of a body, that spreads the
+// error evenly. The indicator of a panel grows with the square of its
+// length, so the density follows the square root of the indicator over the
+// length. Part of it is spread evenly, it is smoothed and neighbouring
+// panels differ by G_GRADING at most, as uneven panel lengths set off the
+// odd-even oscillation of the strengths.
+std::vector<double>
+node_density(Layout const & layout, double total, double const * eta)
+{
+    std::size_t const   n = layout.s.size();
+    std::vector<double> w(n);
+
+    double integral = 0.0;
+    for (std::size_t i = 0; i < n; ++i) {
+        double const h = (i + 1 == n ? total : layout.s[i + 1]) - layout.s[i];
+        w[i] = std::sqrt(eta[i]) / h;
+        integral += w[i] * h;
+    }
+    for (double & wi : w) {
+        wi += G_BACKGROUND * integral / total;
+    }
+
+    std::vector<double> smooth(n);
+    for (int pass = 0; pass < G_SMOOTHING; ++pass) {
+        for (std::size_t i = 0; i < n; ++i) {
+            smooth[i] =
+                0.25 * (w[(i + n - 1) % n] + 2.0 * w[i] + w[(i + 1) % n]);
+        }
+        w.swap(smooth);
+    }
+
+    // Twice around the closed outline in both directions
+    for (std::size_t i = 1; i < 2 * n; ++i) {
+        double & wi = w[i % n];
+        wi = std::max(wi, w[(i - 1) % n] / G_GRADING);
+    }
+    for (std::size_t i = 2 * n - 1; i-- > 0;) {
+        double & wi = w[i % n];
+        wi = std::max(wi, w[(i + 1) % n] / G_GRADING);
+    }
+
+    return w;
+}
+
+double
+density_integral(Layout const &              layout,
+                 double                      total,
+                 std::vector<double> const & w,
+                 std::size_t                 begin,
+                 std::size_t                 end)
+{
+    double integral = 0.0;
+    for (std::size_t i = begin; i < end; ++i) {
+        double const next = i + 1 == w.size() ? total : layout.s[i + 1];
+        integral += w[i] * (next - layout.s[i]);
+    }
+
+    return integral;
+}
+
+// New nodes holding equal parts of the density integral between every two
+// fixed nodes, about panels in total
+Layout
+redistribute(Layout const &              layout,
+             double                      total,
+             std::vector<double> const & w,
+             std::size_t                 panels)
+{
+    std::size_t const n = layout.s.size();
+    double const      integral = density_integral(layout, total, w, 0, n);
+
+    Layout next;
+    next.s.reserve(panels + n);
+    next.fixed.reserve(panels + n);
+
+    std::size_t begin = 0;
+    while (begin < n) {
+        std::size_t end = begin + 1;
+        while (end < n && !layout.fixed[end]) {
+            ++end;
+        }
+
+        double const part = density_integral(layout, total, w, begin, end);
+        auto const   count = std::max<std::size_t>(
+            static_cast<std::size_t>(std::lround(
+                static_cast<double>(panels) * part / integral)),
+            1);
+
+        next.s.push_back(layout.s[begin]);
+        next.fixed.push_back(layout.fixed[begin]);
+
+        // Walks the old panels of the run while placing the new nodes
+        std::size_t i = begin;
+        double      below = 0.0;
+        for (std::size_t k = 1; k < count; ++k) {
+            double const target =
+                part * static_cast<double>(k) / static_cast<double>(count);
+            double h = (i + 1 == n ? total : layout.s[i + 1]) - layout.s[i];
+            while (i + 1 < end && below + w[i] * h < target) {
+                below += w[i] * h;
+                ++i;
+                h = (i + 1 == n ? total : layout.s[i + 1]) - layout.s[i];
+            }
+            next.s.push_back(layout.s[i] +
+                             std::min((target - below) / w[i], h));
+            next.fixed.push_back(false);
+        }
+
+        begin = end;
+    }
+
+    return next;
+}
+
+} // namespace
+
+Scene
+repanel_cosine(Scene const & scene, RepanelOptions const & options)
+{
+    Scene result;
+    result.bodies.reserve(scene.bodies.size());
+    for (Body const & body : scene.bodies) {
+        Outline const outline = make_outline(body, options.corner_angle);
+        result.bodies.push_back(
+            build_body(outline, cosine_layout(outline, options.panels)));
+    }
+
+    return result;
+}
+
+AdaptResult
+adapt_scene(Scene const &        scene,
+            Vec2 const &         vinf,
+            AdaptOptions const & options)
+{
+    ScopedTimer const timer{"adapt scene"};
+
+    std::vector<Outline> outlines;
+    std::vector<Layout>  layouts;
+    for (Body const & body : scene.bodies) {
+        outlines.push_back(make_outline(body, options.initial.corner_angle));
+        layouts.push_back(
+            cosine_layout(outlines.back(), options.initial.panels));
+    }
+
+    AdaptResult result;
+    double      cl_prev = 0.0;
+    for (int iteration = 0;; ++iteration) {
+        result.scene.bodies.clear();
+        for (std::size_t k = 0; k < outlines.size(); ++k) {
+            result.scene.bodies.push_back(
+                build_body(outlines[k], layouts[k]));
+        }
+        result.solution = solve(result.scene, vinf, options.solver);
+
+        Surface const surface = compute_surface(result.scene,
+                                                result.solution,
+                                                vinf,
+                                                options.solver.quadrature,
+                                                options.solver.pool);
+        double const  cl =
+            compute_loads(result.scene, result.solution, surface, vinf).cl;
+
+        AdaptStep step{result.scene.panelCount(), cl};
+        if (iteration > 0) {
+            step.error = std::abs(cl - cl_prev);
+        }
+        result.steps.push_back(step);
+        cl_prev = cl;
+
+        // A single small change may be a coincidence of the layouts
+        result.converged = iteration > 1 && step.error <= options.tolerance &&
+                           result.steps.end()[-2].error <= options.tolerance;
+        if (result.converged) {
+            break;
+        }
+        if (iteration + 1 >= options.max_iterations ||
+            step.panels >= options.max_panels) {
+            break;
+        }
+
+        // Every body gets its share of the next, larger panel count by the
+        // integral of its density, so the panels go where the error is
+        // largest in the whole scene
+        std::size_t const panels = std::min(
+            options.max_panels,
+            static_cast<std::size_t>(G_GROWTH *
+                                     static_cast<double>(step.panels)));
+
+        std::vector<std::vector<double>> density;
+        std::vector<double>              weight;
+        double                           sum = 0.0;
+        for (std::size_t k = 0; k < layouts.size(); ++k) {
+            std::vector<double> eta;
+            add_indicator(result.scene.bodies[k],
+                          surface.velocity.data() +
+                              result.scene.panelOffset(k),
+                          eta);
+
+            double const total = outlines[k].length();
+            density.push_back(node_density(layouts[k], total, eta.data()));
+            weight.push_back(density_integral(
+                layouts[k], total, density.back(), 0, eta.size()));
+            sum += weight.back();
+        }
+
+        for (std::size_t k = 0; k < layouts.size(); ++k) {
+            auto const share = static_cast<std::size_t>(
+                static_cast<double>(panels) * weight[k] / sum);
+            layouts[k] = redistribute(layouts[k],
+                                      outlines[k].length(),
+                                      density[k],
+                                      std::max<std::size_t>(share, 3));
+        }
+    }
+
+    return result;
+}
+
+} // namespace vortisim
@@ -0,0 +1,78 @@
+#ifndef CORE_REPANEL_H
+#define CORE_REPANEL_H
+
+#include "core/scene.h"
+#include "core/solver.h"
+#include "core/vec2.h"
+
+#include <cstddef>
+#include <vector>
+
+namespace vortisim {
+
+struct RepanelOptions {
+    // Panels of every body
+    std::size_t panels{40};
+    // Nodes where the outline turns by more than this, in radians, are
+    // corners and stay nodes
+    double corner_angle{0.5};
+};
+
+// Redistributes the nodes of every body along its outline, the polyline
+// through its nodes, with cosine spacing clustered at the trailing edge
+// node 0 and at the leading edge, the node farthest from it. Corners are
+// kept, so polygons keep their shape exactly while smooth runs of nodes are
+// resampled, and a body may end up with a few more panels than asked for.
+// The new bodies take their Kutta condition on KuttaRow::OPPOSITE, the row
+// linear panels use whatever the setting. Expects a scene that passes
+// validate_scene.
+Scene
+repanel_cosine(Scene const & scene, RepanelOptions const & options = {});
+
+struct AdaptOptions {
+    // Starting distribution
+    RepanelOptions initial{};
+
+    // Estimated absolute error of the lift coefficient to stop at
+    double      tolerance{1e-3};
+    // Solves, the first one included
+    int         max_iterations{8};
+    std::size_t max_panels{4000};
+
+    SolverOptions solver{};
+};
+
+// One solve of the adaptive loop
+struct AdaptStep {
+    std::size_t panels{};
+    double      cl{};
+    // Change of cl from the previous step, negative for the first one
+    double error{-1.0};
+};
+
+struct AdaptResult {
+    Scene                  scene{};
+    Solution               solution{};
+    std::vector<AdaptStep> steps{};
+    bool                   converged{false};
+};
+
+// Starts from repanel_cosine and solves repeatedly, each time with about
+// half again as many panels, redistributed along the outline so that every
+// panel carries an even share of the error indicator. This refines where
+// the indicator is high and coarsens where it is low, while the panel
+// length changes smoothly, as abrupt changes set off the odd-even
+// oscillation of constant strength panels. The indicator of a panel is its
+// length times the jump of the surface velocity across it, the local error
+// of approximating the vorticity as piecewise constant; the surface
+// velocity rather than the strength is used, as it does not pick up the
+// oscillation. Stops once cl changed by less than the tolerance twice in a
+// row. New nodes lie on the input outline and corners are kept.
+AdaptResult
+adapt_scene(Scene const &        scene,
+            Vec2 const &         vinf,
+            AdaptOptions const & options = {});
+
+} // namespace vortisim
+
+#endif // CORE_REPANEL_H
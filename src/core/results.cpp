@@ -0,0 +1,112 @@
+#include "core/results.h"
+
+#include "core/loads.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+namespace vortisim {
+
+namespace {
+
+bool
+little_endian_host()
+{
+    std::uint16_t const probe = 1;
+    unsigned char       first = 0;
+    std::memcpy(&first, &probe, 1);
+
+    return first == 1;
+}
+
+// Values are stored little-endian; a big-endian host swaps the bytes of
+// every value on the way out
+template<typename T>
+void
+write_values(std::ostream & out, T const * values, std::size_t count)
+{
+    std::vector<char> bytes(count * sizeof(T));
+    std::memcpy(bytes.data(), values, bytes.size());
+
+    if (!little_endian_host()) {
+        for (auto it = bytes.begin(); it != bytes.end(); it += sizeof(T)) {
+            std::reverse(it, it + sizeof(T));
+        }
+    }
+
+    out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+}
+
+template<typename T>
+void
+write_column(std::ostream & out, std::vector<T> const & column)
+{
+    write_values(out, column.data(), column.size());
+}
+
+template<typename T>
+void
+write_value(std::ostream & out, T const & value)
+{
+    write_values(out, &value, 1);
+}
+
+} // namespace
+
+bool
+write_results(std::filesystem::path const & path,
+              Scene const &                 scene,
+              Solution const &              solution,
+              Vec2 const &                  vinf,
+              Quadrature                    quadrature,
+              ThreadPool *                  pool)
+{
+    assert(solution.strengths.size() == scene.panelCount());
+
+    Surface const surface =
+        compute_surface(scene, solution, vinf, quadrature, pool);
+    Loads const loads = compute_loads(scene, solution, surface, vinf);
+
+    std::vector<std::uint64_t> body_starts{0};
+    for (Body const & body : scene.bodies) {
+        body_starts.push_back(body_starts.back() + body.panelCount());
+    }
+
+    ResultsHeader header{};
+    header.n_panels = solution.strengths.size();
+    header.n_bodies = scene.bodies.size();
+    header.formulation = static_cast<std::uint32_t>(solution.formulation);
+    header.vinf_x = vinf.x;
+    header.vinf_y = vinf.y;
+    header.cl = loads.cl;
+    header.cm = loads.cm;
+
+    std::ofstream out{path, std::ios::binary | std::ios::trunc};
+
+    // Field by field, each in file byte order
+    out.write(header.magic, sizeof(header.magic));
+    write_value(out, header.version);
+    write_value(out, header.n_columns);
+    write_value(out, header.n_panels);
+    write_value(out, header.n_bodies);
+    write_value(out, header.formulation);
+    write_value(out, header.reserved);
+    write_value(out, header.vinf_x);
+    write_value(out, header.vinf_y);
+    write_value(out, header.cl);
+    write_value(out, header.cm);
+
+    write_column(out, body_starts);
+    write_column(out, surface.x);
+    write_column(out, surface.y);
+    write_column(out, solution.strengths);
+    write_column(out, surface.velocity);
+    write_column(out, surface.cp);
+
+    return static_cast<bool>(out);
+}
+
+} // namespace vortisim
@@ -0,0 +1,60 @@
+#ifndef CORE_RESULTS_H
+#define CORE_RESULTS_H
+
+#include "core/panel.h"
+#include "core/scene.h"
+#include "core/solver.h"
+#include "core/threadpool.h"
+#include "core/vec2.h"
+
+#include <cstdint>
+#include <filesystem>
+
+namespace vortisim {
+
+// Layout of a results file, all little-endian whatever the host order, and
+// 8 byte aligned so that every column can be used in place from a memory
+// mapping:
+//   char     magic[8]          "VSRESLT"
+//   uint32   version           2
+//   uint32   n_columns         5
+//   uint64   n_panels, n_bodies
+//   uint32   formulation       0 constant, 1 linear (vortisim::Formulation)
+//   uint32   reserved          0
+//   float64  vinf_x, vinf_y, cl, cm
+//   uint64   body_starts[n_bodies + 1]
+//   float64  x[n_panels], y[n_panels]     control points
+//   float64  strength[n_panels]           per panel, or at the start node
+//                                         of every panel when linear
+//   float64  velocity[n_panels]           tangential surface velocity
+//   float64  cp[n_panels]
+// Later versions only append columns; readers skip the ones they do not
+// know by n_columns. Version 1 files have no formulation and reserved
+// fields and always hold constant strengths.
+struct ResultsHeader {
+    char          magic[8]{'V', 'S', 'R', 'E', 'S', 'L', 'T', '\0'};
+    std::uint32_t version{2};
+    std::uint32_t n_columns{5};
+    std::uint64_t n_panels{};
+    std::uint64_t n_bodies{};
+    std::uint32_t formulation{};
+    std::uint32_t reserved{};
+    double        vinf_x{};
+    double        vinf_y{};
+    double        cl{};
+    double        cm{};
+};
+
+// Computes the surface pressure and the loads of a solved scene and writes
+// them column after column. Returns false when the file cannot be written.
+bool
+write_results(std::filesystem::path const & path,
+              Scene const &                 scene,
+              Solution const &              solution,
+              Vec2 const &                  vinf,
+              Quadrature                    quadrature = Quadrature::ANALYTIC,
+              ThreadPool *                  pool = nullptr);
+
+} // namespace vortisim
+
+#endif // CORE_RESULTS_H
@@ -0,0 +1,41 @@
+#ifndef CORE_SCENE_H
+#define CORE_SCENE_H
+
+#include "core/body.h"
+
+#include <cstddef>
+#include <vector>
+
+namespace vortisim {
+
+// Independent closed bodies solved together, e.g. a wing with its flap. The
+// unknowns are the panels of every body in order, the row of the
+// Body::kuttaPanel of each body holds its own Kutta condition.
+struct Scene {
+    std::vector<Body> bodies{};
+
+    std::size_t
+    panelCount() const
+    {
+        std::size_t n_panels = 0;
+        for (Body const & body : bodies) {
+            n_panels += body.panelCount();
+        }
+        return n_panels;
+    }
+
+    // Index of the first panel of body k in the scene ordering
+    std::size_t
+    panelOffset(std::size_t k) const
+    {
+        std::size_t offset = 0;
+        for (std::size_t i = 0; i < k; ++i) {
+            offset += bodies[i].panelCount();
+        }
+        return offset;
+    }
+};
+
+} // namespace vortisim
+
+#endif // CORE_SCENE_H
@@ -0,0 +1,249 @@
+#include "core/solver.h"
+
+#include "core/assembly.h"
+#include "core/profiler.h"
+
+#include <cassert>
+#include <cmath>
+
+namespace vortisim {
+
+namespace {
+
+bool
+use_iterative(PanelArrays const & panels, SolverOptions const & options)
+{
+    // The sampled quadrature and the linear sheet have no multipole form,
+    // they stay dense
+    return options.quadrature == Quadrature::ANALYTIC &&
+           options.formulation == Formulation::CONSTANT &&
+           (options.mode == SolverMode::ITERATIVE ||
+            (options.mode == SolverMode::AUTO &&
+             panels.size() >= options.iterative_threshold));
+}
+
+// Relative to the right-hand side, or absolute for a zero one, e.g. a body
+// at rest in a zero freestream
+double
+relative_residual(double r_norm, double b_norm)
+{
+    return (b_norm > 0.0) ? r_norm / b_norm : r_norm;
+}
+
+// Float factors refined against the double matrix, or against residuals
+// assembled block by block
+MixedSolver
+make_mixed_solver(PanelArrays const & panels, SolverOptions const & options)
+{
+    if (options.low_memory) {
+        return MixedSolver{panels,
+                           assemble_influence<float>(panels,
+                                                     options.quadrature,
+                                                     options.pool,
+                                                     options.formulation),
+                           options.quadrature,
+                           options.pool,
+                           options.formulation};
+    }
+
+    return MixedSolver{panels,
+                       assemble_influence(panels,
+                                          options.quadrature,
+                                          options.pool,
+                                          options.formulation),
+                       options.quadrature,
+                       options.pool,
+                       options.formulation};
+}
+
+Solution
+solve_panels(PanelArrays const &     panels,
+             Eigen::VectorXd const & b,
+             SolverOptions const &   options)
+{
+    ScopedTimer const timer{"solve"};
+
+    bool const iterative = use_iterative(panels, options);
+
+    Solution        solution{};
+    Eigen::VectorXd x;
+
+    solution.formulation = options.formulation;
+
+    if (iterative) {
+        GmresResult const result = solve_iterative(
+            panels, b, x, options.iterative, options.pool);
+
+        solution.mode = SolverMode::ITERATIVE;
+        solution.iterations = result.iterations;
+        solution.residual = result.residual;
+    } else if (options.mode == SolverMode::MIXED) {
+        MixedSolver const      mixed = make_mixed_solver(panels, options);
+        RefinementResult const result = mixed.solve(b, x, options.refinement);
+
+        solution.mode = SolverMode::MIXED;
+        solution.iterations = result.steps;
+        solution.residual = result.residual;
+    } else {
+        Eigen::MatrixXd const a = assemble_influence(
+            panels, options.quadrature, options.pool, options.formulation);
+
+        x = a.fullPivHouseholderQr().solve(b);
+
+        solution.mode = SolverMode::DENSE;
+        solution.residual = relative_residual((b - a * x).norm(), b.norm());
+    }
+
+    solution.strengths.assign(x.data(), x.data() + x.size());
+
+    return solution;
+}
+
+} // namespace
+
+Eigen::MatrixXd
+assemble_influence(Body const & body,
+                   Quadrature   quadrature,
+                   ThreadPool * pool,
+                   Formulation  formulation)
+{
+    return assemble_influence(
+        make_panel_arrays(body, formulation), quadrature, pool, formulation);
+}
+
+Eigen::VectorXd
+assemble_rhs(Body const & body, Vec2 const & vinf, Formulation formulation)
+{
+    std::size_t const n_panels = body.panelCount();
+    assert(n_panels > 1);
+
+    Eigen::VectorXd b(n_panels);
+    for (std::size_t i = 0; i < n_panels; ++i) {
+        b(i) = -dot(body.panelNormal(i), vinf);
+    }
+
+    // Kutta condition
+    b(body.kuttaPanel(formulation)) = 0.0;
+
+    return b;
+}
+
+Eigen::VectorXd
+assemble_rhs(Scene const & scene, Vec2 const & vinf, Formulation formulation)
+{
+    Eigen::VectorXd b(scene.panelCount());
+
+    Eigen::Index offset = 0;
+    for (Body const & body : scene.bodies) {
+        auto const n_panels = static_cast<Eigen::Index>(body.panelCount());
+        b.segment(offset, n_panels) = assemble_rhs(body, vinf, formulation);
+        offset += n_panels;
+    }
+
+    return b;
+}
+
+Solution
+solve(Body const & body, Vec2 const & vinf, SolverOptions const & options)
+{
+    return solve_panels(make_panel_arrays(body, options.formulation),
+                        assemble_rhs(body, vinf, options.formulation),
+                        options);
+}
+
+Solution
+solve(Scene const & scene, Vec2 const & vinf, SolverOptions const & options)
+{
+    assert(!scene.bodies.empty());
+
+    return solve_panels(make_panel_arrays(scene, options.formulation),
+                        assemble_rhs(scene, vinf, options.formulation),
+                        options);
+}
+
+std::vector<Solution>
+solve_sweep(Scene const &             scene,
+            std::vector<Vec2> const & freestreams,
+            SolverOptions const &     options)
+{
+    assert(!scene.bodies.empty());
+
+    PanelArrays const panels = make_panel_arrays(scene, options.formulation);
+    auto const        n = static_cast<Eigen::Index>(panels.size());
+
+    // Right-hand sides of the unit freestreams along x and y
+    Eigen::MatrixX2d b(n, 2);
+    b.col(0) = assemble_rhs(scene, {1.0, 0.0}, options.formulation);
+    b.col(1) = assemble_rhs(scene, {0.0, 1.0}, options.formulation);
+
+    Eigen::MatrixX2d x(n, 2);
+    SolverMode       mode = SolverMode::DENSE;
+    int              iterations = 0;
+
+    // Dense: residual columns, the residual of a combination is the same
+    // combination. Iterative and mixed: residual norms of the columns.
+    Eigen::MatrixX2d r(n, 2);
+    Eigen::Vector2d  r_norms;
+
+    if (use_iterative(panels, options)) {
+        mode = SolverMode::ITERATIVE;
+
+        BlockJacobi const preconditioner{
+            panels, options.iterative.block_size, options.pool};
+        for (Eigen::Index c = 0; c < 2; ++c) {
+            Eigen::VectorXd   column;
+            GmresResult const result = solve_iterative(panels,
+                                                       preconditioner,
+                                                       b.col(c),
+                                                       column,
+                                                       options.iterative,
+                                                       options.pool);
+
+            x.col(c) = column;
+            iterations += result.iterations;
+            r_norms(c) = result.residual * b.col(c).norm();
+        }
+    } else if (options.mode == SolverMode::MIXED) {
+        mode = SolverMode::MIXED;
+
+        MixedSolver const mixed = make_mixed_solver(panels, options);
+        for (Eigen::Index c = 0; c < 2; ++c) {
+            Eigen::VectorXd        column;
+            RefinementResult const result =
+                mixed.solve(b.col(c), column, options.refinement);
+
+            x.col(c) = column;
+            iterations += result.steps;
+            r_norms(c) = result.residual * b.col(c).norm();
+        }
+    } else {
+        Eigen::MatrixXd const a = assemble_influence(
+            panels, options.quadrature, options.pool, options.formulation);
+
+        x = a.fullPivHouseholderQr().solve(b);
+        r = b - a * x;
+    }
+
+    std::vector<Solution> solutions(freestreams.size());
+    for (std::size_t k = 0; k < freestreams.size(); ++k) {
+        Eigen::Vector2d const v{freestreams[k].x, freestreams[k].y};
+        Eigen::VectorXd const strengths = x * v;
+        double const          b_norm = (b * v).norm();
+
+        Solution & solution = solutions[k];
+        solution.strengths.assign(
+            strengths.data(), strengths.data() + strengths.size());
+        solution.formulation = options.formulation;
+        solution.mode = mode;
+        solution.iterations = iterations;
+        solution.residual = relative_residual(
+            (mode == SolverMode::DENSE)
+                ? (r * v).norm()
+                : std::abs(v(0)) * r_norms(0) + std::abs(v(1)) * r_norms(1),
+            b_norm);
+    }
+
+    return solutions;
+}
+
+} // namespace vortisim
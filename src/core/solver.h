@@ -0,0 +1,109 @@
+#ifndef CORE_SOLVER_H
+#define CORE_SOLVER_H
+
+#include "core/body.h"
+#include "core/iterative.h"
+#include "core/mixed.h"
+#include "core/panel.h"
+#include "core/scene.h"
+#include "core/threadpool.h"
+#include "core/vec2.h"
+
+#include <Eigen/Dense>
+#include <vector>
+
+namespace vortisim {
+
+enum class SolverMode
+{
+    // Dense below iterative_threshold panels, iterative from there on
+    AUTO,
+    // Full influence matrix and QR factorization; O(N^2) memory
+    DENSE,
+    // GMRES on a treecode product, analytic quadrature only; O(N) memory
+    ITERATIVE,
+    // Float LU refined to double accuracy against the double matrix, or in
+    // half its memory with SolverOptions::low_memory. Never chosen by AUTO.
+    MIXED
+};
+
+struct SolverOptions {
+    Quadrature quadrature{Quadrature::ANALYTIC};
+    // LINEAR has no multipole form and is never solved iteratively
+    Formulation formulation{Formulation::CONSTANT};
+
+    // Assembly runs on the calling thread when unset
+    ThreadPool * pool{nullptr};
+
+    SolverMode       mode{SolverMode::AUTO};
+    std::size_t      iterative_threshold{2000};
+    IterativeOptions iterative{};
+
+    // MIXED only
+    RefinementOptions refinement{};
+    // Drops the double matrix and assembles the residual of every refinement
+    // step block by block, at about the cost of one assembly each
+    bool low_memory{false};
+};
+
+struct Solution {
+    // Vortex sheet strength per unit length, one per panel of the solved body,
+    // or of every body in scene order. With the linear formulation the one
+    // of panel i is the strength at its start node, and the sheet runs
+    // linearly to that of the next panel around the body.
+    std::vector<double> strengths{};
+    Formulation         formulation{Formulation::CONSTANT};
+
+    // Path that produced the strengths
+    SolverMode mode{SolverMode::DENSE};
+    // GMRES iterations, or refinement steps of the mixed path; zero for the
+    // dense path
+    int iterations{};
+    // Relative residual |b - A x| / |b|
+    double residual{};
+};
+
+// Normal velocity influence of every panel on every control point. The row
+// of Body::kuttaPanel holds the Kutta condition instead of a flow tangency
+// condition.
+Eigen::MatrixXd
+assemble_influence(Body const & body,
+                   Quadrature   quadrature = Quadrature::ANALYTIC,
+                   ThreadPool * pool = nullptr,
+                   Formulation  formulation = Formulation::CONSTANT);
+
+Eigen::VectorXd
+assemble_rhs(Body const & body,
+             Vec2 const & vinf,
+             Formulation  formulation = Formulation::CONSTANT);
+
+Eigen::VectorXd
+assemble_rhs(Scene const & scene,
+             Vec2 const &  vinf,
+             Formulation   formulation = Formulation::CONSTANT);
+
+Solution
+solve(Body const &          body,
+      Vec2 const &          vinf,
+      SolverOptions const & options = {});
+
+// Solves all bodies together, each with its own Kutta condition
+Solution
+solve(Scene const &         scene,
+      Vec2 const &          vinf,
+      SolverOptions const & options = {});
+
+// Solves the scene for many freestreams at the cost of about one solve. The
+// right-hand side is linear in the freestream, so only the two unit
+// freestreams are solved, as one two-column block on a single
+// factorization, and every solution is combined from them. The iterative
+// path runs GMRES, and the mixed path its refinement, once per unit
+// freestream and reports a bound on the residual.
+std::vector<Solution>
+solve_sweep(Scene const &             scene,
+            std::vector<Vec2> const & freestreams,
+            SolverOptions const &     options = {});
+
+} // namespace vortisim
+
+#endif // CORE_SOLVER_H
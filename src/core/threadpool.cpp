@@ -0,0 +1,117 @@
+#include "core/threadpool.h"
+
+#include <algorithm>
+
+namespace vortisim {
+
+ThreadPool::ThreadPool(unsigned n_threads)
+{
+    unsigned const n_workers = std::max(1U, n_threads) - 1;
+
+    workers_.reserve(n_workers);
+    for (unsigned i = 0; i < n_workers; ++i) {
+        workers_.emplace_back([this]() { work(); });
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock{mutex_};
+        stop_ = true;
+    }
+    start_cv_.notify_all();
+
+    for (std::thread & t : workers_) {
+        t.join();
+    }
+}
+
+unsigned
+ThreadPool::size() const
+{
+    return static_cast<unsigned>(workers_.size()) + 1;
+}
+
+void
+ThreadPool::parallelFor(std::size_t n, std::size_t chunk, Range const & fn)
+{
+    if (n == 0) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> submit{submit_mutex_};
+
+    {
+        std::lock_guard<std::mutex> lock{mutex_};
+        job_ = &fn;
+        n_ = n;
+        chunk_ = std::max<std::size_t>(1, chunk);
+        next_ = 0;
+        active_ = workers_.size();
+        ++generation_;
+    }
+    start_cv_.notify_all();
+
+    runChunks();
+
+    // Every worker has to have seen this loop before the next one starts
+    std::unique_lock<std::mutex> lock{mutex_};
+    done_cv_.wait(lock, [this]() { return active_ == 0; });
+    job_ = nullptr;
+}
+
+void
+ThreadPool::work()
+{
+    std::uint64_t seen = 0;
+
+    std::unique_lock<std::mutex> lock{mutex_};
+    for (;;) {
+        start_cv_.wait(lock,
+                       [this, seen]() { return stop_ || generation_ != seen; });
+        if (stop_) {
+            return;
+        }
+        seen = generation_;
+
+        lock.unlock();
+        runChunks();
+        lock.lock();
+
+        if (--active_ == 0) {
+            done_cv_.notify_one();
+        }
+    }
+}
+
+void
+ThreadPool::runChunks()
+{
+    Range const &     fn = *job_;
+    std::size_t const n = n_;
+    std::size_t const chunk = chunk_;
+
+    for (std::size_t begin = next_.fetch_add(chunk); begin < n;
+         begin = next_.fetch_add(chunk)) {
+        fn(begin, std::min(begin + chunk, n));
+    }
+}
+
+void
+parallel_for(ThreadPool *              pool,
+             std::size_t               n,
+             std::size_t               chunk,
+             ThreadPool::Range const & fn)
+{
+    if (pool == nullptr || pool->size() == 1) {
+        if (n > 0) {
+            fn(0, n);
+        }
+        return;
+    }
+
+    pool->parallelFor(n, chunk, fn);
+}
+
+} // namespace vortisim
@@ -0,0 +1,76 @@
+#ifndef CORE_THREADPOOL_H
+#define CORE_THREADPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace vortisim {
+
+// Fixed set of worker threads running one data-parallel loop at a time. The
+// calling thread takes part in the loop, so a pool of size 1 has no workers.
+class ThreadPool {
+public:
+    using Range = std::function<void(std::size_t, std::size_t)>;
+
+    explicit ThreadPool(
+        unsigned n_threads = std::thread::hardware_concurrency());
+
+    ThreadPool(ThreadPool const &) = delete;
+    ThreadPool(ThreadPool &&) noexcept = delete;
+
+    ~ThreadPool();
+
+    ThreadPool &
+    operator=(ThreadPool const &) = delete;
+    ThreadPool &
+    operator=(ThreadPool &&) noexcept = delete;
+
+    // Number of threads taking part in a loop, including the caller
+    unsigned
+    size() const;
+
+    // Calls fn(begin, end) for consecutive chunks of [0, n) and returns once
+    // all of them are done. Loops submitted from several threads are run one
+    // after the other; fn must not submit to the same pool.
+    void
+    parallelFor(std::size_t n, std::size_t chunk, Range const & fn);
+
+private:
+    void
+    work();
+
+    void
+    runChunks();
+
+    std::vector<std::thread> workers_{};
+
+    std::mutex              submit_mutex_{};
+    std::mutex              mutex_{};
+    std::condition_variable start_cv_{};
+    std::condition_variable done_cv_{};
+
+    Range const *            job_{};
+    std::size_t              n_{};
+    std::size_t              chunk_{};
+    std::atomic<std::size_t> next_{};
+    std::uint64_t            generation_{};
+    std::size_t              active_{};
+    bool                     stop_{false};
+};
+
+// Runs fn over [0, n) on the pool, or inline when there is none
+void
+parallel_for(ThreadPool *              pool,
+             std::size_t               n,
+             std::size_t               chunk,
+             ThreadPool::Range const & fn);
+
+} // namespace vortisim
+
+#endif // CORE_THREADPOOL_H
@@ -0,0 +1,164 @@
+#include "core/tracer.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+namespace vortisim {
+
+namespace {
+
+template<typename Velocity>
+Vec2
+rk4_step(Velocity const & velocity, Vec2 const & p, Vec2 const & k1, double h)
+{
+    Vec2 const k2 = velocity(p + (0.5 * h) * k1);
+    Vec2 const k3 = velocity(p + (0.5 * h) * k2);
+    Vec2 const k4 = velocity(p + h * k3);
+
+    return p + (h / 6.0) * (k1 + 2.0 * k2 + 2.0 * k3 + k4);
+}
+
+bool
+finite(Vec2 const & v)
+{
+    return std::isfinite(v.x) && std::isfinite(v.y);
+}
+
+} // namespace
+
+ParticleTracer::ParticleTracer(FlowField const &     field,
+                               TracerOptions const & options)
+    : field_{field}, options_{options}
+{
+    assert(options_.min_step > 0.0 && options_.max_step >= options_.min_step);
+}
+
+void
+ParticleTracer::add(Vec2 const & p)
+{
+    x_.push_back(p.x);
+    y_.push_back(p.y);
+    step_.push_back(options_.max_step);
+    active_.push_back(1);
+}
+
+void
+ParticleTracer::clear()
+{
+    x_.clear();
+    y_.clear();
+    step_.clear();
+    active_.clear();
+}
+
+void
+ParticleTracer::advance(double dt, ThreadPool * pool)
+{
+    parallel_for(pool,
+                 size(),
+                 options_.chunk,
+                 [this, dt](std::size_t begin, std::size_t end) {
+                     for (std::size_t i = begin; i < end; ++i) {
+                         if (active_[i] != 0) {
+                             advanceParticle(i, dt);
+                         }
+                     }
+                 });
+}
+
+void
+ParticleTracer::advanceParticle(std::size_t i, double dt)
+{
+    auto velocity = [this](Vec2 const & p) { return field_.velocity(p); };
+
+    Vec2   p{x_[i], y_[i]};
+    double h = step_[i];
+    double t = 0.0;
+
+    for (std::size_t steps = 0; t < dt; ++steps) {
+        if (steps == options_.max_steps) {
+            active_[i] = 0;
+            break;
+        }
+
+        double const step = std::min(h, dt - t);
+
+        // One full step against two half steps sharing the first stage
+        Vec2 const k1 = velocity(p);
+        Vec2 const full = rk4_step(velocity, p, k1, step);
+        Vec2 const mid = rk4_step(velocity, p, k1, 0.5 * step);
+        Vec2 const two = rk4_step(velocity, mid, velocity(mid), 0.5 * step);
+
+        if (!finite(two) || !finite(full)) {
+            active_[i] = 0;
+            break;
+        }
+
+        // Both are fourth order; the difference estimates the error of the
+        // half steps times 15
+        double const error = length(two - full) / 15.0;
+
+        if (error <= options_.tolerance || step <= options_.min_step) {
+            // Local extrapolation
+            p = two + (1.0 / 15.0) * (two - full);
+            t += step;
+        }
+
+        constexpr double safety = 0.9;
+        constexpr double max_growth = 2.0;
+        constexpr double max_shrink = 0.2;
+        double const     factor =
+            (error > 0.0)
+                    ? std::clamp(safety * std::pow(options_.tolerance / error,
+                                                   0.2),
+                                 max_shrink,
+                                 max_growth)
+                    : max_growth;
+
+        // A step cut short by the end of the interval says little about the
+        // step the particle could take
+        if (step == h || factor < 1.0) {
+            h = std::clamp(
+                step * factor, options_.min_step, options_.max_step);
+        }
+    }
+
+    x_[i] = p.x;
+    y_[i] = p.y;
+    step_[i] = h;
+}
+
+ParticlePaths
+trace_paths(FlowField const &         field,
+            std::vector<Vec2> const & seeds,
+            double                    dt,
+            std::size_t               n_samples,
+            TracerOptions const &     options,
+            ThreadPool *              pool)
+{
+    ParticleTracer tracer{field, options};
+    for (Vec2 const & p : seeds) {
+        tracer.add(p);
+    }
+
+    ParticlePaths paths{};
+    paths.samples = n_samples + 1;
+    paths.x.resize(seeds.size() * paths.samples);
+    paths.y.resize(seeds.size() * paths.samples);
+
+    for (std::size_t s = 0; s < paths.samples; ++s) {
+        if (s > 0) {
+            tracer.advance(dt, pool);
+        }
+
+        for (std::size_t k = 0; k < seeds.size(); ++k) {
+            paths.x[k * paths.samples + s] = tracer.x()[k];
+            paths.y[k * paths.samples + s] = tracer.y()[k];
+        }
+    }
+
+    return paths;
+}
+
+} // namespace vortisim
@@ -0,0 +1,104 @@
+#ifndef CORE_TRACER_H
+#define CORE_TRACER_H
+
+#include "core/flowfield.h"
+#include "core/threadpool.h"
+#include "core/vec2.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace vortisim {
+
+struct TracerOptions {
+    // Position error allowed per step
+    double tolerance{1e-6};
+    double min_step{1e-5};
+    double max_step{0.05};
+
+    // Steps a particle may take within one advance before it is stopped,
+    // e.g. when it is trapped near a stagnation point
+    std::size_t max_steps{1000};
+
+    // Particles per parallel task
+    std::size_t chunk{1024};
+};
+
+// Massless particles advected through a flow field with classic RK4. Every
+// particle adapts its own step by step doubling, so particles near a body
+// take small steps while those in the free stream move in a few large ones.
+// State is kept as structure of arrays and advanced in parallel chunks.
+class ParticleTracer {
+public:
+    explicit ParticleTracer(FlowField const &     field,
+                            TracerOptions const & options = {});
+
+    void
+    add(Vec2 const & p);
+
+    void
+    clear();
+
+    std::size_t
+    size() const
+    {
+        return x_.size();
+    }
+
+    std::vector<double> const &
+    x() const
+    {
+        return x_;
+    }
+
+    std::vector<double> const &
+    y() const
+    {
+        return y_;
+    }
+
+    // False once a particle ran out of steps or hit a singular velocity
+    bool
+    active(std::size_t i) const
+    {
+        return active_[i] != 0;
+    }
+
+    // Moves every active particle dt further along its path
+    void
+    advance(double dt, ThreadPool * pool = nullptr);
+
+private:
+    void
+    advanceParticle(std::size_t i, double dt);
+
+    FlowField const & field_;
+    TracerOptions     options_;
+
+    std::vector<double>       x_{};
+    std::vector<double>       y_{};
+    std::vector<double>       step_{};
+    std::vector<std::uint8_t> active_{};
+};
+
+// Positions of every seed at n_samples + 1 times spaced dt apart, starting
+// with the seed itself. Path k takes up [k * samples, (k + 1) * samples) of
+// x and y, with samples = n_samples + 1.
+struct ParticlePaths {
+    std::size_t         samples{};
+    std::vector<double> x{};
+    std::vector<double> y{};
+};
+
+ParticlePaths
+trace_paths(FlowField const &         field,
+            std::vector<Vec2> const & seeds,
+            double                    dt,
+            std::size_t               n_samples,
+            TracerOptions const &     options = {},
+            ThreadPool *              pool = nullptr);
+
+} // namespace vortisim
+
+#endif // CORE_TRACER_H
@@ -0,0 +1,325 @@
+#include "core/treecode.h"
+
+#include "core/panel.h"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <limits>
+#include <numeric>
+
+namespace vortisim {
+
+namespace {
+
+constexpr double G_PI = 3.14159265358979;
+constexpr double G_TAU = 2.0 * G_PI;
+
+} // namespace
+
+VortexTree::VortexTree(PanelArrays const & panels, TreeOptions const & options)
+    : options_{options}
+{
+    std::size_t const n_panels = panels.size();
+
+    std::vector<Complex> midpoints(n_panels);
+    for (std::size_t i = 0; i < n_panels; ++i) {
+        midpoints[i] = {panels.xc[i], panels.yc[i]};
+    }
+
+    order_.resize(n_panels);
+    std::iota(order_.begin(), order_.end(), 0);
+
+    build(midpoints);
+
+    p1_.resize(n_panels);
+    p2_.resize(n_panels);
+    for (std::size_t s = 0; s < n_panels; ++s) {
+        std::size_t const i = order_[s];
+        p1_[s] = {panels.x1[i], panels.y1[i]};
+        p2_[s] = {panels.x2[i], panels.y2[i]};
+    }
+
+    init();
+}
+
+VortexTree::VortexTree(std::vector<Vec2> const & particles,
+                       double                    core,
+                       TreeOptions const &       options)
+    : options_{options},
+      core_{core}
+{
+    assert(core_ >= 0.0);
+
+    std::size_t const n_particles = particles.size();
+
+    std::vector<Complex> positions(n_particles);
+    for (std::size_t i = 0; i < n_particles; ++i) {
+        positions[i] = {particles[i].x, particles[i].y};
+    }
+
+    order_.resize(n_particles);
+    std::iota(order_.begin(), order_.end(), 0);
+
+    build(positions);
+
+    // Particles are panels of zero length
+    p1_.resize(n_particles);
+    for (std::size_t s = 0; s < n_particles; ++s) {
+        p1_[s] = particles[order_[s]];
+    }
+    p2_ = p1_;
+
+    init();
+}
+
+void
+VortexTree::init()
+{
+    assert(options_.order > 0);
+
+    auto const order = static_cast<std::size_t>(options_.order);
+
+    strengths_.assign(order_.size(), 0.0);
+
+    binomial_.assign(order * order, 0.0);
+    for (std::size_t k = 0; k < order; ++k) {
+        binomial_[k * order] = 1.0;
+        for (std::size_t l = 1; l <= k; ++l) {
+            binomial_[k * order + l] = binomial_[(k - 1) * order + l - 1] +
+                                       binomial_[(k - 1) * order + l];
+        }
+    }
+
+    computeIntegrals();
+
+    moments_.assign(nodes_.size() * order, Complex{});
+}
+
+void
+VortexTree::build(std::vector<Complex> const & midpoints)
+{
+    nodes_.clear();
+    nodes_.push_back({{}, 0.0, 0, order_.size(), 0, 0});
+
+    // Breadth first, so children always come after their parent
+    for (std::size_t i = 0; i < nodes_.size(); ++i) {
+        std::size_t const begin = nodes_[i].begin;
+        std::size_t const end = nodes_[i].end;
+
+        double x_min = std::numeric_limits<double>::max();
+        double y_min = x_min;
+        double x_max = std::numeric_limits<double>::lowest();
+        double y_max = x_max;
+        for (std::size_t s = begin; s < end; ++s) {
+            Complex const & m = midpoints[order_[s]];
+            x_min = std::min(x_min, m.real());
+            x_max = std::max(x_max, m.real());
+            y_min = std::min(y_min, m.imag());
+            y_max = std::max(y_max, m.imag());
+        }
+
+        constexpr double half = 0.5;
+        Complex const    center{half * (x_min + x_max), half * (y_min + y_max)};
+        nodes_[i].center = center;
+
+        bool const degenerate = x_min == x_max && y_min == y_max;
+        if (end - begin <= options_.leaf_size || degenerate) {
+            continue;
+        }
+
+        // Split into quadrants around the box center
+        auto const first = order_.begin() + static_cast<std::ptrdiff_t>(begin);
+        auto const last = order_.begin() + static_cast<std::ptrdiff_t>(end);
+
+        auto const is_left = [&midpoints, center](std::size_t p) {
+            return midpoints[p].real() < center.real();
+        };
+        auto const is_below = [&midpoints, center](std::size_t p) {
+            return midpoints[p].imag() < center.imag();
+        };
+
+        auto const mid = std::partition(first, last, is_left);
+        std::array<decltype(mid), 5> const bounds{
+            first,
+            std::partition(first, mid, is_below),
+            mid,
+            std::partition(mid, last, is_below),
+            last};
+
+        auto const first_child = static_cast<std::uint32_t>(nodes_.size());
+        for (std::size_t q = 0; q + 1 < bounds.size(); ++q) {
+            if (bounds[q] == bounds[q + 1]) {
+                continue;
+            }
+
+            nodes_.push_back(
+                {{},
+                 0.0,
+                 static_cast<std::size_t>(bounds[q] - order_.begin()),
+                 static_cast<std::size_t>(bounds[q + 1] - order_.begin()),
+                 0,
+                 0});
+        }
+
+        nodes_[i].first_child = first_child;
+        nodes_[i].n_children =
+            static_cast<std::uint32_t>(nodes_.size()) - first_child;
+    }
+}
+
+void
+VortexTree::computeIntegrals()
+{
+    auto const order = static_cast<std::size_t>(options_.order);
+
+    integrals_.assign(order_.size() * order, Complex{});
+
+    std::vector<Complex> a_pow(order);
+    std::vector<Complex> q_pow(order);
+
+    for (Node & node : nodes_) {
+        // Cell radius covering every panel endpoint
+        for (std::size_t s = node.begin; s < node.end; ++s) {
+            Complex const z1{p1_[s].x, p1_[s].y};
+            Complex const z2{p2_[s].x, p2_[s].y};
+            node.radius = std::max({node.radius,
+                                    std::abs(z1 - node.center),
+                                    std::abs(z2 - node.center)});
+        }
+
+        if (node.n_children > 0) {
+            continue;
+        }
+
+        // Integral of (z - c)^k along the panel, expanded about its midpoint
+        // z = c + a + s * e with s in [-h, h]; odd powers of s vanish.
+        for (std::size_t s = node.begin; s < node.end; ++s) {
+            Complex const z1{p1_[s].x, p1_[s].y};
+            Complex const z2{p2_[s].x, p2_[s].y};
+            Complex const diff = z2 - z1;
+            double const  h = 0.5 * std::abs(diff);
+            Complex const a = 0.5 * (z1 + z2) - node.center;
+            Complex const q = 0.5 * diff;
+
+            a_pow[0] = 1.0;
+            q_pow[0] = 1.0;
+            for (std::size_t k = 1; k < order; ++k) {
+                a_pow[k] = a_pow[k - 1] * a;
+                q_pow[k] = q_pow[k - 1] * q;
+            }
+
+            // A particle is a unit circulation at a single point
+            Complex * out = &integrals_[s * order];
+            if (core_ >= 0.0) {
+                std::copy(a_pow.begin(), a_pow.end(), out);
+                continue;
+            }
+
+            for (std::size_t k = 0; k < order; ++k) {
+                Complex sum{};
+                for (std::size_t l = 0; l <= k; l += 2) {
+                    sum += binomial_[k * order + l] * a_pow[k - l] * q_pow[l] /
+                           static_cast<double>(l + 1);
+                }
+                out[k] = 2.0 * h * sum;
+            }
+        }
+    }
+}
+
+void
+VortexTree::setStrengths(double const * strengths)
+{
+    auto const order = static_cast<std::size_t>(options_.order);
+
+    for (std::size_t s = 0; s < order_.size(); ++s) {
+        strengths_[s] = strengths[order_[s]];
+    }
+
+    std::vector<Complex> d_pow(order);
+
+    // Upward pass; children always come after their parent
+    for (std::size_t i = nodes_.size(); i-- > 0;) {
+        Node const & node = nodes_[i];
+        Complex *    m = &moments_[i * order];
+        std::fill(m, m + order, Complex{});
+
+        if (node.n_children == 0) {
+            for (std::size_t s = node.begin; s < node.end; ++s) {
+                Complex const * integral = &integrals_[s * order];
+                for (std::size_t k = 0; k < order; ++k) {
+                    m[k] += strengths_[s] * integral[k];
+                }
+            }
+            continue;
+        }
+
+        // Translate the child expansions to this cell's center
+        for (std::uint32_t c = 0; c < node.n_children; ++c) {
+            std::size_t const child = node.first_child + c;
+            Complex const *   mc = &moments_[child * order];
+            Complex const     d = nodes_[child].center - node.center;
+
+            d_pow[0] = 1.0;
+            for (std::size_t k = 1; k < order; ++k) {
+                d_pow[k] = d_pow[k - 1] * d;
+            }
+
+            for (std::size_t k = 0; k < order; ++k) {
+                for (std::size_t l = 0; l <= k; ++l) {
+                    m[k] += binomial_[k * order + l] * mc[l] * d_pow[k - l];
+                }
+            }
+        }
+    }
+}
+
+Vec2
+VortexTree::velocity(Vec2 const & p) const
+{
+    auto const    order = static_cast<std::size_t>(options_.order);
+    Complex const z{p.x, p.y};
+
+    // Conjugate velocity times 2 pi i from the far field
+    Complex far{};
+    Vec2    near{};
+
+    constexpr std::size_t                max_stack = 512;
+    std::array<std::uint32_t, max_stack> stack{};
+    std::size_t                          top = 0;
+    stack[top++] = 0;
+
+    while (top > 0) {
+        Node const &  node = nodes_[stack[--top]];
+        Complex const dz = z - node.center;
+
+        if (node.radius < options_.theta * std::abs(dz)) {
+            Complex const   inv = 1.0 / dz;
+            Complex         pw = inv;
+            Complex const * m = &moments_[(&node - nodes_.data()) * order];
+            for (std::size_t k = 0; k < order; ++k) {
+                far += m[k] * pw;
+                pw *= inv;
+            }
+        } else if (node.n_children == 0 && core_ >= 0.0) {
+            for (std::size_t s = node.begin; s < node.end; ++s) {
+                near += strengths_[s] * particle_velocity(p1_[s], p, core_);
+            }
+        } else if (node.n_children == 0) {
+            for (std::size_t s = node.begin; s < node.end; ++s) {
+                near += strengths_[s] * panel_velocity(p1_[s], p2_[s], p);
+            }
+        } else {
+            assert(top + node.n_children <= max_stack);
+            for (std::uint32_t c = 0; c < node.n_children; ++c) {
+                stack[top++] = node.first_child + c;
+            }
+        }
+    }
+
+    // u - iv = far / (2 pi i)
+    return near + (1.0 / G_TAU) * Vec2{far.imag(), far.real()};
+}
+
+} // namespace vortisim
@@ -0,0 +1,105 @@
+#ifndef CORE_TREECODE_H
+#define CORE_TREECODE_H
+
+#include "core/assembly.h"
+#include "core/threadpool.h"
+#include "core/vec2.h"
+
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace vortisim {
+
+struct TreeOptions {
+    // Number of multipole terms
+    int order{20};
+    // Opening angle: a cell is expanded when its radius is below theta times
+    // the distance to the target
+    double theta{0.5};
+    // Maximum number of panels in a leaf
+    std::size_t leaf_size{32};
+};
+
+// Barnes-Hut treecode for the velocity of a set of constant-strength vortex
+// panels or of vortex particles. Cells far from a target are replaced by a
+// complex multipole expansion of the exact panel integrals, nearby leaves are
+// summed with the closed-form panel kernel or the regularized particle
+// kernel. Storage is O(N * order).
+class VortexTree {
+public:
+    explicit VortexTree(PanelArrays const & panels,
+                        TreeOptions const & options = {});
+
+    // Vortex particles with the given core radius
+    VortexTree(std::vector<Vec2> const & particles,
+               double                    core,
+               TreeOptions const &       options = {});
+
+    // Sets the strength per unit length of every panel, or the circulation of
+    // every particle, in input order, and updates the multipole moments
+    void
+    setStrengths(double const * strengths);
+
+    // Velocity induced at p by all panels
+    Vec2
+    velocity(Vec2 const & p) const;
+
+    std::size_t
+    size() const
+    {
+        return order_.size();
+    }
+
+private:
+    using Complex = std::complex<double>;
+
+    struct Node {
+        Complex     center{};
+        double      radius{};
+        std::size_t begin{};
+        std::size_t end{};
+        // Children are stored consecutively; a leaf has none
+        std::uint32_t first_child{};
+        std::uint32_t n_children{};
+    };
+
+    void
+    build(std::vector<Complex> const & midpoints);
+
+    // Shared by both constructors once p1_ and p2_ are known
+    void
+    init();
+
+    void
+    computeIntegrals();
+
+    TreeOptions options_;
+
+    // Particle core radius, negative for panels
+    double core_{-1.0};
+
+    std::vector<Node> nodes_{};
+
+    // Panel index of every slot of the tree ordering
+    std::vector<std::size_t> order_{};
+
+    // Endpoints and strengths in tree order
+    std::vector<Vec2>   p1_{};
+    std::vector<Vec2>   p2_{};
+    std::vector<double> strengths_{};
+
+    // Integral of (z - leaf center)^k over every panel, order_ terms each
+    std::vector<Complex> integrals_{};
+
+    // Multipole moments, order_ terms per node
+    std::vector<Complex> moments_{};
+
+    // Binomial coefficients for moment translation
+    std::vector<double> binomial_{};
+};
+
+} // namespace vortisim
+
+#endif // CORE_TREECODE_H
@@ -0,0 +1,254 @@
+#include "core/unsteady.h"
+
+#include "core/profiler.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <optional>
+#include <utility>
+
+namespace vortisim {
+
+namespace {
+
+// Relative step of the central difference for the pitch rate
+constexpr double G_RATE_STEP = 1e-6;
+
+// Counter-clockwise rotation by the angle with the given cosine and sine
+Vec2
+rotate(Vec2 const & v, double c, double s)
+{
+    return {c * v.x - s * v.y, s * v.x + c * v.y};
+}
+
+} // namespace
+
+UnsteadySolver::UnsteadySolver(Scene                   scene,
+                               Motion                  motion,
+                               UnsteadyOptions const & options,
+                               ThreadPool *            pool)
+    : scene_{std::move(scene)},
+      motion_{std::move(motion)},
+      options_{options},
+      pool_{pool}
+{
+    assert(options_.dt > 0.0 && options_.core >= 0.0);
+
+    factorize();
+    updatePose(motion_.pitch(0.0));
+
+    // Starts from rest
+    solution_.strengths.assign(panels_.size(), 0.0);
+    circulations_.assign(scene_.bodies.size(), 0.0);
+}
+
+void
+UnsteadySolver::setScene(Scene scene)
+{
+    assert(scene.bodies.size() == scene_.bodies.size());
+
+    scene_ = std::move(scene);
+
+    factorize();
+    updatePose(motion_.pitch(time()));
+
+    solution_.strengths.resize(panels_.size(), 0.0);
+}
+
+void
+UnsteadySolver::factorize()
+{
+    panels_ = make_panel_arrays(scene_);
+
+    std::size_t const n = panels_.size();
+    std::size_t const m = panels_.bodyCount();
+
+    // New particles leave along the bisector of the trailing edge
+    double const speed = length(motion_.freestream(0.0));
+    double const offset =
+        options_.shed_offset * options_.dt * ((speed > 0.0) ? speed : 1.0);
+
+    shed_.resize(m);
+    for (std::size_t k = 0; k < m; ++k) {
+        std::vector<Vec2> const & nodes = scene_.bodies[k].nodes;
+
+        Vec2 const lower = nodes[0] - nodes[1];
+        Vec2 const upper = nodes[0] - nodes.back();
+        Vec2 const bisector =
+            (1.0 / length(lower)) * lower + (1.0 / length(upper)) * upper;
+
+        shed_[k] = nodes[0] + (offset / length(bisector)) * bisector;
+    }
+
+    auto const size = static_cast<Eigen::Index>(n + m);
+    auto const n_rows = static_cast<Eigen::Index>(n);
+
+    Eigen::MatrixXd a = Eigen::MatrixXd::Zero(size, size);
+    a.topLeftCorner(n_rows, n_rows) =
+        assemble_influence(panels_, options_.quadrature, pool_);
+
+    for (std::size_t k = 0; k < m; ++k) {
+        auto const col = static_cast<Eigen::Index>(n + k);
+
+        // Normal velocity of the new particle at every control point
+        for (std::size_t i = 0; i < n; ++i) {
+            Vec2 const v = particle_velocity(
+                shed_[k], {panels_.xc[i], panels_.yc[i]}, options_.core);
+            a(static_cast<Eigen::Index>(i), col) =
+                v.x * panels_.nx[i] + v.y * panels_.ny[i];
+        }
+
+        // Kelvin: bound plus shed circulation equals the previous bound one
+        for (std::size_t j = panels_.body_starts[k];
+             j < panels_.body_starts[k + 1];
+             ++j) {
+            a(col, static_cast<Eigen::Index>(j)) = panels_.len[j];
+        }
+        a(col, col) = 1.0;
+    }
+
+    // The Kutta rows only involve the panels
+    for (std::size_t k = 0; k < m; ++k) {
+        a.row(static_cast<Eigen::Index>(panels_.kuttaRow(k)))
+            .tail(static_cast<Eigen::Index>(m))
+            .setZero();
+    }
+
+    lu_.compute(a);
+}
+
+void
+UnsteadySolver::updatePose(double angle)
+{
+    double const c = std::cos(angle);
+    double const s = std::sin(angle);
+
+    posed_ = scene_;
+    for (Body & body : posed_.bodies) {
+        for (Vec2 & node : body.nodes) {
+            node = motion_.pivot + rotate(node - motion_.pivot, c, s);
+        }
+    }
+}
+
+void
+UnsteadySolver::step()
+{
+    ScopedTimer const timer{"unsteady step"};
+
+    double const t = static_cast<double>(steps_ + 1) * options_.dt;
+    double const dt = options_.dt;
+
+    double const angle = motion_.pitch(t);
+    double const h = G_RATE_STEP * std::max(1.0, std::abs(t));
+    double const rate =
+        (motion_.pitch(t + h) - motion_.pitch(t - h)) / (2.0 * h);
+    Vec2 const vinf = motion_.freestream(t);
+    Vec2 const pivot = motion_.pivot;
+
+    updatePose(angle);
+    PanelArrays const posed = make_panel_arrays(posed_);
+
+    std::size_t const n = posed.size();
+    std::size_t const m = posed.bodyCount();
+
+    std::optional<VortexTree> wake_tree;
+    if (wake_.size() > 0) {
+        wake_tree.emplace(wake_.positions, options_.core, options_.tree);
+        wake_tree->setStrengths(wake_.circulations.data());
+    }
+
+    // Flow relative to the moving control points, the Kutta rows stay zero
+    Eigen::VectorXd b =
+        Eigen::VectorXd::Zero(static_cast<Eigen::Index>(n + m));
+    parallel_for(
+        pool_, n, options_.chunk, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t i = begin; i < end; ++i) {
+                Vec2 const p{posed.xc[i], posed.yc[i]};
+                Vec2 const r = p - pivot;
+
+                Vec2 v = vinf - rate * Vec2{-r.y, r.x};
+                if (wake_tree) {
+                    v += wake_tree->velocity(p);
+                }
+
+                b(static_cast<Eigen::Index>(i)) =
+                    -(v.x * posed.nx[i] + v.y * posed.ny[i]);
+            }
+        });
+    for (std::size_t k = 0; k < m; ++k) {
+        b(static_cast<Eigen::Index>(posed.kuttaRow(k))) = 0.0;
+        b(static_cast<Eigen::Index>(n + k)) = circulations_[k];
+    }
+
+    Eigen::VectorXd const x = lu_.solve(b);
+
+    solution_.strengths.assign(x.data(), x.data() + n);
+    for (std::size_t k = 0; k < m; ++k) {
+        double bound = 0.0;
+        for (std::size_t j = posed.body_starts[k]; j < posed.body_starts[k + 1];
+             ++j) {
+            bound += x(static_cast<Eigen::Index>(j)) * posed.len[j];
+        }
+        circulations_[k] = bound;
+    }
+
+    // Shed particles join the wake at their place in the fixed frame
+    std::size_t const n_old = wake_.size();
+    double const      c = std::cos(angle);
+    double const      s = std::sin(angle);
+    for (std::size_t k = 0; k < m; ++k) {
+        wake_.positions.push_back(pivot + rotate(shed_[k] - pivot, c, s));
+        wake_.circulations.push_back(x(static_cast<Eigen::Index>(n + k)));
+    }
+
+    std::optional<VortexTree> body_tree;
+    if (options_.quadrature == Quadrature::ANALYTIC) {
+        body_tree.emplace(posed, options_.tree);
+        body_tree->setStrengths(solution_.strengths.data());
+    }
+
+    // Forward Euler with the velocities of the new bound vorticity; the old
+    // particles act through the tree, the new ones directly
+    std::size_t const n_wake = wake_.size();
+    std::vector<Vec2> velocities(n_wake);
+    parallel_for(
+        pool_, n_wake, options_.chunk, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t i = begin; i < end; ++i) {
+                Vec2 const & p = wake_.positions[i];
+
+                Vec2 v = vinf;
+                if (body_tree) {
+                    v += body_tree->velocity(p);
+                } else {
+                    for (std::size_t j = 0; j < n; ++j) {
+                        v += solution_.strengths[j] *
+                             panel_velocity({posed.x1[j], posed.y1[j]},
+                                            {posed.x2[j], posed.y2[j]},
+                                            p,
+                                            options_.quadrature);
+                    }
+                }
+
+                if (wake_tree) {
+                    v += wake_tree->velocity(p);
+                }
+                for (std::size_t j = n_old; j < n_wake; ++j) {
+                    v += wake_.circulations[j] *
+                         particle_velocity(
+                             wake_.positions[j], p, options_.core);
+                }
+
+                velocities[i] = v;
+            }
+        });
+
+    for (std::size_t i = 0; i < n_wake; ++i) {
+        wake_.positions[i] += dt * velocities[i];
+    }
+
+    ++steps_;
+}
+
+} // namespace vortisim
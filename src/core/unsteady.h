@@ -0,0 +1,154 @@
+#ifndef CORE_UNSTEADY_H
+#define CORE_UNSTEADY_H
+
+#include "core/assembly.h"
+#include "core/panel.h"
+#include "core/scene.h"
+#include "core/solver.h"
+#include "core/threadpool.h"
+#include "core/treecode.h"
+#include "core/vec2.h"
+
+#include <Eigen/Dense>
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+namespace vortisim {
+
+// Rigid motion of a scene in the fixed frame: the bodies rotate by pitch(t),
+// counter-clockwise positive, about the pivot while the freestream may change
+// over time, e.g. for gusts. A constant freestream is an impulsive start.
+struct Motion {
+    std::function<Vec2(double)>   freestream{[](double /*t*/) {
+        return Vec2{1.0, 0.0};
+    }};
+    std::function<double(double)> pitch{[](double /*t*/) { return 0.0; }};
+    Vec2                          pivot{};
+};
+
+struct UnsteadyOptions {
+    double dt{0.01};
+
+    // Core radius of the wake particles
+    double core{0.02};
+
+    // Distance of a new particle behind the trailing edge, as a fraction of
+    // the distance the initial freestream covers in one step
+    double shed_offset{0.3};
+
+    Quadrature quadrature{Quadrature::ANALYTIC};
+
+    // Expansions of the wake and, for analytic quadrature, of the panels
+    // acting on the wake
+    TreeOptions tree{};
+
+    // Particles per parallel task
+    std::size_t chunk{256};
+};
+
+// Free vortex particles in the fixed frame. Every step appends one particle
+// per body; both arrays grow geometrically, so appending stays amortized
+// O(1) and the positions remain contiguous for the treecode.
+struct Wake {
+    std::vector<Vec2>   positions{};
+    std::vector<double> circulations{};
+
+    std::size_t
+    size() const
+    {
+        return positions.size();
+    }
+};
+
+// Time-stepping panel method with a free vortex wake. Every step each body
+// sheds a particle from its trailing edge whose circulation balances the
+// change of the bound circulation (Kelvin), the bodies keep their Kutta
+// conditions and the wake is convected with the local velocity.
+//
+// The panel system is written in the body frame. The new particle of every
+// body sits at a fixed offset from its trailing edge, so the matrix,
+// extended by the particle columns and the Kelvin rows, only depends on the
+// geometry: rigid bodies factorize it once and only the right-hand side
+// changes per step. Wake velocities come from a particle treecode, which
+// keeps a step at O((N + M) log N) for N particles and M panels.
+class UnsteadySolver {
+public:
+    UnsteadySolver(Scene                   scene,
+                   Motion                  motion = {},
+                   UnsteadyOptions const & options = {},
+                   ThreadPool *            pool = nullptr);
+
+    // Replaces the geometry while keeping the wake and bound circulations,
+    // e.g. for deforming bodies. Refactorizes the system.
+    void
+    setScene(Scene scene);
+
+    // Advances by one time step
+    void
+    step();
+
+    double
+    time() const
+    {
+        return static_cast<double>(steps_) * options_.dt;
+    }
+
+    // Bodies at time() in the fixed frame
+    Scene const &
+    scene() const
+    {
+        return posed_;
+    }
+
+    // Panel strengths at time(), in scene order
+    Solution const &
+    solution() const
+    {
+        return solution_;
+    }
+
+    Wake const &
+    wake() const
+    {
+        return wake_;
+    }
+
+    // Bound circulation of body k at time()
+    double
+    circulation(std::size_t k) const
+    {
+        return circulations_[k];
+    }
+
+private:
+    void
+    factorize();
+
+    // Places the body frame scene in the fixed frame at the given pitch
+    void
+    updatePose(double angle);
+
+    Scene           scene_;
+    Motion          motion_;
+    UnsteadyOptions options_;
+    ThreadPool *    pool_;
+
+    // Body frame panels and the new particle of every body
+    PanelArrays       panels_{};
+    std::vector<Vec2> shed_{};
+
+    // Panel system extended by one particle column and one Kelvin row per
+    // body
+    Eigen::PartialPivLU<Eigen::MatrixXd> lu_{};
+
+    std::size_t         steps_{};
+    Scene               posed_{};
+    Solution            solution_{};
+    std::vector<double> circulations_{};
+    Wake                wake_{};
+};
+
+} // namespace vortisim
+
+#endif // CORE_UNSTEADY_H
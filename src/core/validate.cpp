@@ -0,0 +1,227 @@
+#include "core/validate.h"
+
+#include <algorithm>
+#include <iterator>
+#include <limits>
+#include <set>
+
+namespace vortisim {
+
+namespace {
+
+// Twice the signed area of the triangle, positive counter-clockwise
+double
+orient(Vec2 const & a, Vec2 const & b, Vec2 const & c)
+{
+    return (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+}
+
+// Whether p, collinear with a and b, lies on the segment between them
+bool
+on_segment(Vec2 const & a, Vec2 const & b, Vec2 const & p)
+{
+    return std::min(a.x, b.x) <= p.x && p.x <= std::max(a.x, b.x) &&
+           std::min(a.y, b.y) <= p.y && p.y <= std::max(a.y, b.y);
+}
+
+bool
+lexicographic_less(Vec2 const & a, Vec2 const & b)
+{
+    return a.x < b.x || (a.x == b.x && a.y < b.y);
+}
+
+// Endpoint of a segment reached by the sweep
+struct Event {
+    Vec2        point{};
+    std::size_t segment{};
+    bool        left{};
+};
+
+} // namespace
+
+bool
+segments_cross(Segment const & s, Segment const & t)
+{
+    if ((s.a == t.a && s.b == t.b) || (s.a == t.b && s.b == t.a)) {
+        return true;
+    }
+
+    // With one shared endpoint the rest only meets when both leave it in
+    // the same direction
+    for (auto const & [p, s_other] : {std::pair{s.a, s.b}, {s.b, s.a}}) {
+        for (auto const & [q, t_other] : {std::pair{t.a, t.b}, {t.b, t.a}}) {
+            if (p == q) {
+                return orient(p, s_other, t_other) == 0.0 &&
+                       dot(s_other - p, t_other - p) > 0.0;
+            }
+        }
+    }
+
+    double const o1 = orient(s.a, s.b, t.a);
+    double const o2 = orient(s.a, s.b, t.b);
+    double const o3 = orient(t.a, t.b, s.a);
+    double const o4 = orient(t.a, t.b, s.b);
+
+    bool const proper = ((o1 > 0.0 && o2 < 0.0) || (o1 < 0.0 && o2 > 0.0)) &&
+                        ((o3 > 0.0 && o4 < 0.0) || (o3 < 0.0 && o4 > 0.0));
+
+    return proper || (o1 == 0.0 && on_segment(s.a, s.b, t.a)) ||
+           (o2 == 0.0 && on_segment(s.a, s.b, t.b)) ||
+           (o3 == 0.0 && on_segment(t.a, t.b, s.a)) ||
+           (o4 == 0.0 && on_segment(t.a, t.b, s.b));
+}
+
+std::optional<std::pair<std::size_t, std::size_t>>
+find_crossing(std::vector<Segment> const & segments)
+{
+    // Every segment from its lexicographically smaller endpoint
+    std::vector<Segment> oriented(segments.size());
+    std::vector<Event>   events;
+    events.reserve(2 * segments.size());
+
+    for (std::size_t i = 0; i < segments.size(); ++i) {
+        Segment const & s = segments[i];
+        if (s.a == s.b) {
+            continue;
+        }
+
+        oriented[i] = lexicographic_less(s.a, s.b) ? s : Segment{s.b, s.a};
+        events.push_back({oriented[i].a, i, true});
+        events.push_back({oriented[i].b, i, false});
+    }
+
+    // At a common point segments are removed before others are inserted, so
+    // that segments meeting end to end are never compared there
+    auto const earlier = [](Event const & e, Event const & f) {
+        if (e.point != f.point) {
+            return lexicographic_less(e.point, f.point);
+        }
+        return !e.left && f.left;
+    };
+    std::sort(events.begin(), events.end(), earlier);
+
+    // Sweep position; the status is ordered by height at it, then by
+    // direction beyond it, which only stays consistent until the first
+    // crossing
+    Vec2 sweep{};
+
+    auto height = [&oriented, &sweep](std::size_t i) {
+        Segment const & s = oriented[i];
+        if (s.a.x == s.b.x) {
+            return std::clamp(sweep.y, s.a.y, s.b.y);
+        }
+        return s.a.y + (s.b.y - s.a.y) * (sweep.x - s.a.x) / (s.b.x - s.a.x);
+    };
+
+    auto slope = [&oriented](std::size_t i) {
+        Segment const & s = oriented[i];
+        if (s.a.x == s.b.x) {
+            return std::numeric_limits<double>::infinity();
+        }
+        return (s.b.y - s.a.y) / (s.b.x - s.a.x);
+    };
+
+    auto below = [&height, &slope](std::size_t i, std::size_t j) {
+        double const yi = height(i);
+        double const yj = height(j);
+        if (yi != yj) {
+            return yi < yj;
+        }
+
+        double const si = slope(i);
+        double const sj = slope(j);
+        if (si != sj) {
+            return si < sj;
+        }
+
+        return i < j;
+    };
+
+    using Status = std::set<std::size_t, decltype(below)>;
+    Status                        status{below};
+    std::vector<Status::iterator> where(segments.size());
+
+    auto crossing = [&oriented](Status::iterator lower,
+                                Status::iterator upper)
+        -> std::optional<std::pair<std::size_t, std::size_t>> {
+        if (!segments_cross(oriented[*lower], oriented[*upper])) {
+            return std::nullopt;
+        }
+        return std::minmax(*lower, *upper);
+    };
+
+    for (Event const & event : events) {
+        sweep = event.point;
+
+        std::optional<std::pair<std::size_t, std::size_t>> found;
+        if (event.left) {
+            auto const it = status.insert(event.segment).first;
+            where[event.segment] = it;
+
+            if (it != status.begin()) {
+                found = crossing(std::prev(it), it);
+            }
+            if (!found && std::next(it) != status.end()) {
+                found = crossing(it, std::next(it));
+            }
+        } else {
+            // The neighbours of a removed segment become adjacent
+            auto const after = status.erase(where[event.segment]);
+            if (after != status.begin() && after != status.end()) {
+                found = crossing(std::prev(after), after);
+            }
+        }
+
+        if (found) {
+            return found;
+        }
+    }
+
+    return std::nullopt;
+}
+
+std::optional<GeometryError>
+validate_scene(Scene const & scene)
+{
+    std::vector<Segment>     segments;
+    std::vector<std::size_t> offsets;
+    segments.reserve(scene.panelCount());
+
+    for (std::size_t k = 0; k < scene.bodies.size(); ++k) {
+        Body const & body = scene.bodies[k];
+        if (body.nodes.size() < 3) {
+            return GeometryError{GeometryIssue::TOO_FEW_NODES, k};
+        }
+
+        offsets.push_back(segments.size());
+        for (std::size_t i = 0; i < body.panelCount(); ++i) {
+            Segment const s{body.panelStart(i), body.panelEnd(i)};
+            if (s.a == s.b) {
+                return GeometryError{GeometryIssue::DEGENERATE_PANEL, k, i};
+            }
+            segments.push_back(s);
+        }
+    }
+
+    std::optional<std::pair<std::size_t, std::size_t>> const pair =
+        find_crossing(segments);
+    if (!pair) {
+        return std::nullopt;
+    }
+
+    // Body and panel of a scene-wide panel index
+    auto locate = [&offsets](std::size_t i) {
+        auto const body = static_cast<std::size_t>(
+            std::upper_bound(offsets.begin(), offsets.end(), i) -
+            offsets.begin() - 1);
+        return std::pair{body, i - offsets[body]};
+    };
+
+    auto const [body, panel] = locate(pair->first);
+    auto const [other_body, other_panel] = locate(pair->second);
+
+    return GeometryError{
+        GeometryIssue::CROSSING, body, panel, other_body, other_panel};
+}
+
+} // namespace vortisim
@@ -0,0 +1,59 @@
+#ifndef CORE_VALIDATE_H
+#define CORE_VALIDATE_H
+
+#include "core/scene.h"
+#include "core/vec2.h"
+
+#include <cstddef>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace vortisim {
+
+struct Segment {
+    Vec2 a{};
+    Vec2 b{};
+};
+
+// True when the segments meet anywhere but in a single shared endpoint, the
+// way consecutive panels and bodies touching at a node do. Touching and
+// collinear overlap count as crossing.
+bool
+segments_cross(Segment const & s, Segment const & t);
+
+// A crossing pair of segments, lower index first, found by a Shamos-Hoey
+// sweep in O(n log n). Segments of zero length are skipped.
+std::optional<std::pair<std::size_t, std::size_t>>
+find_crossing(std::vector<Segment> const & segments);
+
+enum class GeometryIssue
+{
+    // Fewer than three nodes
+    TOO_FEW_NODES,
+    // Panel of zero length, e.g. a repeated node
+    DEGENERATE_PANEL,
+    // Two panels of the scene cross, within one body or between two
+    CROSSING
+};
+
+struct GeometryError {
+    GeometryIssue issue{GeometryIssue::CROSSING};
+
+    std::size_t body{};
+    std::size_t panel{};
+
+    // Second panel of a crossing
+    std::size_t other_body{};
+    std::size_t other_panel{};
+};
+
+// Checks the scene before any assembly: an ill-posed outline makes the
+// influence matrix singular, and the dense solve then spends seconds on
+// garbage. O(n log n) in the panel count.
+std::optional<GeometryError>
+validate_scene(Scene const & scene);
+
+} // namespace vortisim
+
+#endif // CORE_VALIDATE_H
@@ -0,0 +1,73 @@
+#ifndef CORE_VEC2_H
+#define CORE_VEC2_H
+
+#include <cmath>
+
+namespace vortisim {
+
+struct Vec2 {
+    double x{};
+    double y{};
+};
+
+inline Vec2
+operator+(Vec2 const & a, Vec2 const & b)
+{
+    return {a.x + b.x, a.y + b.y};
+}
+
+inline Vec2
+operator-(Vec2 const & a, Vec2 const & b)
+{
+    return {a.x - b.x, a.y - b.y};
+}
+
+inline Vec2
+operator*(double s, Vec2 const & v)
+{
+    return {s * v.x, s * v.y};
+}
+
+inline Vec2 &
+operator+=(Vec2 & a, Vec2 const & b)
+{
+    a.x += b.x;
+    a.y += b.y;
+    return a;
+}
+
+inline bool
+operator==(Vec2 const & a, Vec2 const & b)
+{
+    return a.x == b.x && a.y == b.y;
+}
+
+inline bool
+operator!=(Vec2 const & a, Vec2 const & b)
+{
+    return !(a == b);
+}
+
+inline double
+dot(Vec2 const & a, Vec2 const & b)
+{
+    return a.x * b.x + a.y * b.y;
+}
+
+inline double
+length(Vec2 const & v)
+{
+    return std::hypot(v.x, v.y);
+}
+
+// Clockwise rotation by 90 degrees, i.e. the right-hand side normal of a
+// direction. Outward for counter-clockwise outlines.
+inline Vec2
+right_normal(Vec2 const & v)
+{
+    return {v.y, -v.x};
+}
+
+} // namespace vortisim
+
+#endif // CORE_VEC2_H
@@ -1,17 +1,47 @@
 #include "displaywidget.h"
 
+#include "core/flowfield.h"
+#include "core/loads.h"
+#include "core/profiler.h"
+#include "core/solver.h"
+#include "core/tracer.h"
+#include "core/validate.h"
+#include "fieldclusters.h"
 #include "overloaded.hh"
 
-#include <Eigen/Dense>
+#include <QFontDatabase>
+#include <QOpenGLFramebufferObject>
 #include <QOpenGLTexture>
+#include <QPainter>
+#include <algorithm>
+#include <array>
+#include <cmath>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
+#include <iomanip>
 #include <iostream>
 #include <memory>
-#include <queue>
+#include <sstream>
 
 namespace {
 
+// Panel evaluations per texel and frame of the field cache, above which a
+// changed field is first rendered at lower resolution
+constexpr double G_FIELD_BUDGET = 1 << 25;
+
+// Each level halves the resolution of the field cache
+constexpr int G_MAX_FIELD_LEVEL = 3;
+
+constexpr float G_MIN_ZOOM = 0.01F;
+constexpr float G_MAX_ZOOM = 1000.0F;
+
+constexpr std::array<GLfloat, 4> G_EDIT_COLOR{1.0F, 1.0F, 1.0F, 1.0F};
+constexpr std::array<GLfloat, 4> G_CROSSING_COLOR{1.0F, 0.25F, 0.25F, 1.0F};
+
+// Initial capacity of the editor buffers, in points and edges
+constexpr std::size_t G_INITIAL_POINTS = 256;
+constexpr std::size_t G_INITIAL_EDGES = 256;
+
 template<typename T>
 class BindOperation {
     T & target_;
@@ -37,37 +67,115 @@ public:
     operator=(BindOperation &&) noexcept = delete;
 };
 
+// Doubles the capacity of a bound buffer, in elements, until count fits.
+// True when it was reallocated and has to be filled again.
+bool
+growBuffer(QOpenGLBuffer & buffer,
+           std::size_t &   capacity,
+           std::size_t     count,
+           std::size_t     element_size)
+{
+    if (count <= capacity) {
+        return false;
+    }
+
+    while (capacity < count) {
+        capacity *= 2;
+    }
+    buffer.allocate(static_cast<int>(capacity * element_size));
+
+    return true;
+}
+
 } // namespace
 
 DisplayWidget::DisplayWidget(QWidget * parent)
     : QOpenGLWidget(parent),
-      proj_{glm::ortho(-1.0F, 1.0F, -1.0F, 1.0F, -1.0F, 1.0F)}
+      proj_{glm::ortho(-1.0F, 1.0F, -1.0F, 1.0F, -1.0F, 1.0F)},
+      async_solver_{&solver_pool_, [this] {
+                        // Called on the solver thread
+                        QMetaObject::invokeMethod(
+                            this,
+                            [this] { publishSolution(); },
+                            Qt::QueuedConnection);
+                    }}
 {
     setMouseTracking(true);
+    setFocusPolicy(Qt::StrongFocus);
+
+    connect(&step_timer_, &QTimer::timeout, this, [this] {
+        makeCurrent();
+        stepUnsteady();
+        doneCurrent();
+        update();
+    });
+
+    // Cheap enough to stay on, the overlay and trace dump read it
+    vortisim::Profiler::instance().setEnabled(true);
 
-    constexpr int max_points = 512;
-    constexpr int max_lines = max_points / 2;
-    points_.reserve(max_points);
-    lines_.reserve(max_lines);
+    constexpr int profile_ms = 250;
+    profile_timer_.setInterval(profile_ms);
+    connect(&profile_timer_, &QTimer::timeout, this, [this] { update(); });
+}
+
+DisplayWidget::~DisplayWidget()
+{
+    makeCurrent();
+    freePanelBuffers();
+    field_cache_.reset();
+    field_image_.reset();
+    field_timer_.destroy();
+    editor_timer_.destroy();
+    doneCurrent();
 }
 
 void
 DisplayWidget::initFlowField()
 {
-    // Shader program setup
+    // Shader program setup. All programs draw the canvas square of
+    // field_vao_, so they share the attribute location.
     field_prog_.create();
     field_prog_.addShaderFromSourceFile(QOpenGLShader::Vertex,
                                         ":/shaders/arrows.v.glsl");
     field_prog_.addShaderFromSourceFile(QOpenGLShader::Fragment,
-                                        ":/shaders/arrows.f.glsl");
+                                        ":/shaders/field.f.glsl");
+    field_prog_.bindAttributeLocation("in_position", 0);
     field_prog_.link();
-    field_mvp_location_ = field_prog_.uniformLocation("mvp");
+
+    arrow_prog_.create();
+    arrow_prog_.addShaderFromSourceFile(QOpenGLShader::Vertex,
+                                        ":/shaders/arrows.v.glsl");
+    arrow_prog_.addShaderFromSourceFile(QOpenGLShader::Fragment,
+                                        ":/shaders/arrows.f.glsl");
+    arrow_prog_.bindAttributeLocation("in_position", 0);
+    arrow_prog_.link();
+    arrow_viewport_location_ = arrow_prog_.uniformLocation("viewport");
+    field_cache_location_ = arrow_prog_.uniformLocation("field_cache");
+
+    composite_prog_.create();
+    composite_prog_.addShaderFromSourceFile(QOpenGLShader::Vertex,
+                                            ":/shaders/arrows.v.glsl");
+    composite_prog_.addShaderFromSourceFile(QOpenGLShader::Fragment,
+                                            ":/shaders/composite.f.glsl");
+    composite_prog_.bindAttributeLocation("in_position", 0);
+    composite_prog_.link();
+    composite_viewport_location_ = composite_prog_.uniformLocation("viewport");
+
     field_inverse_mvp_location_ = field_prog_.uniformLocation("inverse_mvp");
     viewport_location_ = field_prog_.uniformLocation("viewport");
     lines_location_ = field_prog_.uniformLocation("lines");
     strengths_location_ = field_prog_.uniformLocation("strengths");
     n_lines_location_ = field_prog_.uniformLocation("n_lines");
     vinf_location_ = field_prog_.uniformLocation("vinf");
+    quadrature_location_ = field_prog_.uniformLocation("quadrature");
+    formulation_location_ = field_prog_.uniformLocation("formulation");
+
+    // Panels live in texture buffers, which hold far more than the uniform
+    // arrays could
+    glGetIntegerv(GL_MAX_TEXTURE_BUFFER_SIZE, &max_panels_);
+    initPanelBuffer(line_buffer_, GL_RGBA32F, 4);
+    initPanelBuffer(strength_buffer_, GL_RG32F, 2);
+    initPanelBuffer(cluster_buffer_, GL_RGBA32F, 4);
 
     // VAO and VBO setup
     field_vao_.create();
@@ -97,15 +205,257 @@ DisplayWidget::initFlowField()
 
         std::array<GLfloat, 2> tmp{vinf_.x, vinf_.y};
         glUniform2fv(vinf_location_, 1, tmp.data());
+        glUniform1i(quadrature_location_, static_cast<GLint>(quadrature_));
+        glUniform1i(formulation_location_,
+                    static_cast<GLint>(vortisim::Formulation::CONSTANT));
+
+        // Texture units of the panel buffers
+        glUniform1i(lines_location_, 0);
+        glUniform1i(strengths_location_, 1);
+        glUniform1i(field_prog_.uniformLocation("clusters"), 4);
+    }
+
+    {
+        BindOperation prog{arrow_prog_};
+
+        glUniform1i(field_cache_location_, 2);
+    }
+
+    {
+        BindOperation prog{composite_prog_};
+
+        glUniform1i(composite_prog_.uniformLocation("field_image"), 3);
+    }
+
+    // The square of every pass spans the whole window; the field shader maps
+    // pixels back to the world through inverse_mvp
+    Mat4 const identity{1.0F};
+    for (QOpenGLShaderProgram * program :
+         {&field_prog_, &arrow_prog_, &composite_prog_}) {
+        BindOperation prog{*program};
+
+        glUniformMatrix4fv(program->uniformLocation("mvp"),
+                           1,
+                           GL_FALSE,
+                           glm::value_ptr(identity));
     }
 }
 
 void
-DisplayWidget::initEditor()
+DisplayWidget::setFieldResolution(float scale)
+{
+    constexpr float min_scale = 0.125F;
+    field_scale_ = std::clamp(scale, min_scale, 1.0F);
+    invalidateField();
+    update();
+}
+
+void
+DisplayWidget::setView(Vec2 const & center, float zoom)
+{
+    center_ = center;
+    zoom_ = std::clamp(zoom, G_MIN_ZOOM, G_MAX_ZOOM);
+    modelview_ = glm::scale(Mat4{1.0F}, Vec3{zoom_, zoom_, 1.0F}) *
+                 glm::translate(Mat4{1.0F}, Vec3{-center_, 0.0F});
+
+    invalidateField();
+    update();
+}
+
+void
+DisplayWidget::invalidateField()
 {
-    constexpr int max_points{256};
-    constexpr int max_line_points{2 * max_points};
+    // Coarsest level whose cost fits one frame; the far-field clusters are
+    // not counted, so large scenes refine faster than budgeted
+    double const texels = static_cast<double>(field_scale_ * field_scale_) *
+                          width_ * height_;
+    // Two strengths per panel; nothing is uploaded before initializeGL
+    std::size_t const n_panels =
+        strength_buffer_.shadow.empty()
+            ? 0
+            : strength_buffer_.shadow.size() / strength_buffer_.components;
+    double const cost =
+        texels * static_cast<double>(std::max<std::size_t>(1, n_panels));
+
+    field_level_ = 0;
+    while (field_level_ < G_MAX_FIELD_LEVEL &&
+           cost / static_cast<double>(1 << (2 * field_level_)) >
+               G_FIELD_BUDGET) {
+        ++field_level_;
+    }
+
+    field_dirty_ = true;
+}
+
+void
+DisplayWidget::renderFieldCache(Mat4 const & inverse_mvp)
+{
+    // Recreated on every level of a refinement, which is cheap next to the
+    // pass itself
+    float const scale = field_scale_ / static_cast<float>(1 << field_level_);
+    QSize const size{std::max(1, static_cast<int>(scale * width_)),
+                     std::max(1, static_cast<int>(scale * height_))};
+
+    if (!field_cache_ || field_cache_->size() != size) {
+        field_cache_ = std::make_unique<QOpenGLFramebufferObject>(
+            size,
+            QOpenGLFramebufferObject::NoAttachment,
+            GL_TEXTURE_2D,
+            GL_RG32F);
+
+        // Sampled at window resolution, interpolate between texels
+        glBindTexture(GL_TEXTURE_2D, field_cache_->texture());
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+
+    field_cache_->bind();
+    glViewport(0, 0, size.width(), size.height());
+
+    {
+        BindOperation prog{field_prog_};
+
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_BUFFER, line_buffer_.texture);
+        glActiveTexture(GL_TEXTURE1);
+        glBindTexture(GL_TEXTURE_BUFFER, strength_buffer_.texture);
+        glActiveTexture(GL_TEXTURE4);
+        glBindTexture(GL_TEXTURE_BUFFER, cluster_buffer_.texture);
+        glActiveTexture(GL_TEXTURE0);
+
+        glUniform4f(viewport_location_, 0, 0, size.width(), size.height());
+        glUniformMatrix4fv(field_inverse_mvp_location_,
+                           1,
+                           GL_FALSE,
+                           glm::value_ptr(inverse_mvp));
+
+        {
+            BindOperation vao{field_vao_};
+
+            glDrawArrays(GL_TRIANGLE_FAN, 0, 4);
+        }
+    }
+
+    glBindFramebuffer(GL_FRAMEBUFFER, defaultFramebufferObject());
+    glViewport(0, 0, width_, height_);
+}
+
+void
+DisplayWidget::renderFieldImage()
+{
+    // The default framebuffer is multisampled, so the image is drawn rather
+    // than blitted onto it
+    QSize const size{std::max(1, width_), std::max(1, height_)};
+    if (!field_image_ || field_image_->size() != size) {
+        field_image_ = std::make_unique<QOpenGLFramebufferObject>(
+            size,
+            QOpenGLFramebufferObject::NoAttachment,
+            GL_TEXTURE_2D,
+            GL_RGBA8);
+    }
+
+    field_image_->bind();
+    glClear(GL_COLOR_BUFFER_BIT);
+
+    {
+        BindOperation prog{arrow_prog_};
+
+        glActiveTexture(GL_TEXTURE2);
+        glBindTexture(GL_TEXTURE_2D, field_cache_->texture());
+        glActiveTexture(GL_TEXTURE0);
+
+        {
+            BindOperation vao{field_vao_};
+
+            glDrawArrays(GL_TRIANGLE_FAN, 0, 4);
+        }
+    }
+
+    glBindFramebuffer(GL_FRAMEBUFFER, defaultFramebufferObject());
+}
+
+void
+DisplayWidget::freePanelBuffers()
+{
+    for (PanelBuffer * target :
+         {&line_buffer_, &strength_buffer_, &cluster_buffer_}) {
+        glDeleteTextures(1, &target->texture);
+        glDeleteBuffers(1, &target->buffer);
+        *target = PanelBuffer{};
+    }
+}
+
+void
+DisplayWidget::initPanelBuffer(PanelBuffer & target,
+                               GLenum        format,
+                               std::size_t   components)
+{
+    target.format = format;
+    target.components = components;
+
+    glGenBuffers(1, &target.buffer);
+    glGenTextures(1, &target.texture);
+}
+
+void
+DisplayWidget::uploadPanelBuffer(PanelBuffer &                target,
+                                 std::vector<GLfloat> const & data)
+{
+    glBindBuffer(GL_TEXTURE_BUFFER, target.buffer);
+
+    std::size_t const n_texels = data.size() / target.components;
+    if (n_texels > target.capacity) {
+        // Grow geometrically and upload everything
+        target.capacity = std::max(2 * target.capacity, n_texels);
+        glBufferData(GL_TEXTURE_BUFFER,
+                     static_cast<GLsizeiptr>(target.capacity *
+                                             target.components *
+                                             sizeof(GLfloat)),
+                     nullptr,
+                     GL_DYNAMIC_DRAW);
+        glBufferSubData(GL_TEXTURE_BUFFER,
+                        0,
+                        static_cast<GLsizeiptr>(data.size() * sizeof(GLfloat)),
+                        data.data());
+
+        glBindTexture(GL_TEXTURE_BUFFER, target.texture);
+        glTexBuffer(GL_TEXTURE_BUFFER, target.format, target.buffer);
+        glBindTexture(GL_TEXTURE_BUFFER, 0);
+    } else {
+        // Upload every run of values that differ from the previous contents
+        std::size_t const n_old = target.shadow.size();
+        std::size_t       i = 0;
+        while (i < data.size()) {
+            if (i < n_old && target.shadow[i] == data[i]) {
+                ++i;
+                continue;
+            }
+
+            std::size_t const begin = i;
+            while (i < data.size() &&
+                   (i >= n_old || target.shadow[i] != data[i])) {
+                ++i;
+            }
+
+            glBufferSubData(
+                GL_TEXTURE_BUFFER,
+                static_cast<GLintptr>(begin * sizeof(GLfloat)),
+                static_cast<GLsizeiptr>((i - begin) * sizeof(GLfloat)),
+                data.data() + begin);
+        }
+    }
 
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+
+    target.shadow = data;
+}
+
+void
+DisplayWidget::initEditor()
+{
     // Shader program setup
     edit_prog_.create();
     edit_prog_.addShaderFromSourceFile(QOpenGLShader::Vertex,
@@ -114,20 +464,27 @@ DisplayWidget::initEditor()
                                        ":/shaders/default.f.glsl");
     edit_prog_.link();
     edit_mvp_location_ = edit_prog_.uniformLocation("mvp");
+    edit_color_location_ = edit_prog_.uniformLocation("color");
 
     // VAO and VBO setup
     point_vao_.create();
     line_vao_.create();
     guide_vao_.create();
+    trace_vao_.create();
+    wake_vao_.create();
 
     point_vbo_.create();
-    line_vbo_.create();
+    edge_ibo_.create();
     guide_vbo_.create();
+    trace_vbo_.create();
+    wake_vbo_.create();
 
     // Editor program
     {
         BindOperation prog{edit_prog_};
 
+        glUniform4fv(edit_color_location_, 1, G_EDIT_COLOR.data());
+
         // Points
         {
             BindOperation vao{point_vao_};
@@ -135,8 +492,10 @@ DisplayWidget::initEditor()
             {
                 BindOperation vbo{point_vbo_};
 
+                point_capacity_ = G_INITIAL_POINTS;
                 point_vbo_.setUsagePattern(QOpenGLBuffer::DynamicDraw);
-                point_vbo_.allocate(max_points * sizeof(Vec3));
+                point_vbo_.allocate(
+                    static_cast<int>(point_capacity_ * sizeof(Vec3)));
                 edit_prog_.setAttributeBuffer("in_position", GL_FLOAT, 0, 3);
                 edit_prog_.enableAttributeArray("in_position");
                 glVertexAttribPointer(
@@ -149,15 +508,21 @@ DisplayWidget::initEditor()
             }
         }
 
-        // Lines
+        // Lines, the points indexed by edge
         {
             BindOperation vao{line_vao_};
 
+            // The element array binding is part of the VAO, so it stays
+            // bound
+            edge_capacity_ = G_INITIAL_EDGES;
+            edge_ibo_.bind();
+            edge_ibo_.setUsagePattern(QOpenGLBuffer::DynamicDraw);
+            edge_ibo_.allocate(
+                static_cast<int>(2 * edge_capacity_ * sizeof(Index)));
+
             {
-                BindOperation vbo{line_vbo_};
+                BindOperation vbo{point_vbo_};
 
-                line_vbo_.setUsagePattern(QOpenGLBuffer::DynamicDraw);
-                line_vbo_.allocate(max_line_points * sizeof(Vec3));
                 edit_prog_.setAttributeBuffer("in_position", GL_FLOAT, 0, 3);
                 edit_prog_.enableAttributeArray("in_position");
                 glVertexAttribPointer(
@@ -190,6 +555,46 @@ DisplayWidget::initEditor()
                     nullptr);
             }
         }
+
+        // Streamlines, sized on every trace
+        {
+            BindOperation vao{trace_vao_};
+
+            {
+                BindOperation vbo{trace_vbo_};
+
+                trace_vbo_.setUsagePattern(QOpenGLBuffer::DynamicDraw);
+                edit_prog_.setAttributeBuffer("in_position", GL_FLOAT, 0, 3);
+                edit_prog_.enableAttributeArray("in_position");
+                glVertexAttribPointer(
+                    edit_prog_.attributeLocation("in_position"),
+                    3,
+                    GL_FLOAT,
+                    GL_FALSE,
+                    0,
+                    nullptr);
+            }
+        }
+
+        // Wake particles, sized on every step
+        {
+            BindOperation vao{wake_vao_};
+
+            {
+                BindOperation vbo{wake_vbo_};
+
+                wake_vbo_.setUsagePattern(QOpenGLBuffer::StreamDraw);
+                edit_prog_.setAttributeBuffer("in_position", GL_FLOAT, 0, 3);
+                edit_prog_.enableAttributeArray("in_position");
+                glVertexAttribPointer(
+                    edit_prog_.attributeLocation("in_position"),
+                    3,
+                    GL_FLOAT,
+                    GL_FALSE,
+                    0,
+                    nullptr);
+            }
+        }
     }
 }
 
@@ -198,15 +603,27 @@ DisplayWidget::initializeGL()
 {
     initializeOpenGLFunctions();
 
-    // Set up OpenGL state
+    setGLState();
+
+    initEditor();
+    initFlowField();
+
+    if (!field_timer_.create() || !editor_timer_.create()) {
+        std::cerr << "No timer queries, GPU times are not measured\n";
+    }
+}
+
+void
+DisplayWidget::setGLState()
+{
     glClearColor(0.0F, 0.0F, 0.0F, 1.0F);
     glFrontFace(GL_CW);
     glEnable(GL_CULL_FACE);
     glEnable(GL_DEPTH);
     glEnable(GL_PROGRAM_POINT_SIZE);
-
-    initEditor();
-    initFlowField();
+    glDisable(GL_BLEND);
+    glDisable(GL_SCISSOR_TEST);
+    glViewport(0, 0, width_, height_);
 }
 
 void
@@ -218,37 +635,70 @@ DisplayWidget::resizeGL(int w, int h)
     glViewport(0, 0, w, h);
 
     {
-        BindOperation prog{field_prog_};
+        BindOperation prog{arrow_prog_};
 
-        glUniform4f(viewport_location_, 0, 0, w, h);
+        glUniform4f(arrow_viewport_location_, 0, 0, w, h);
     }
+
+    {
+        BindOperation prog{composite_prog_};
+
+        glUniform4f(composite_viewport_location_, 0, 0, w, h);
+    }
+
+    invalidateField();
 }
 
 void
 DisplayWidget::paintGL()
 {
+    vortisim::ScopedTimer const timer{"frame", "gui"};
+
+    // Queries of earlier frames
+    field_timer_.collect();
+    editor_timer_.collect();
+
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
     Mat4 const mvp = proj_ * modelview_;
     Mat4 const inverse_mvp = glm::inverse(mvp);
 
     if (has_polygon_) {
-        BindOperation prog{field_prog_};
+        field_timer_.begin();
 
-        glUniformMatrix4fv(
-            field_mvp_location_, 1, GL_FALSE, glm::value_ptr(mvp));
-        glUniformMatrix4fv(field_inverse_mvp_location_,
-                           1,
-                           GL_FALSE,
-                           glm::value_ptr(inverse_mvp));
+        // The panels are only summed up and the arrows drawn when the
+        // solution or view changed, coarse levels first
+        if (field_dirty_) {
+            renderFieldCache(inverse_mvp);
+            renderFieldImage();
+
+            if (field_level_ > 0) {
+                --field_level_;
+                update();
+            } else {
+                field_dirty_ = false;
+            }
+        }
 
         {
-            BindOperation vao{field_vao_};
+            BindOperation prog{composite_prog_};
 
-            glDrawArrays(GL_TRIANGLE_FAN, 0, 4);
+            glActiveTexture(GL_TEXTURE3);
+            glBindTexture(GL_TEXTURE_2D, field_image_->texture());
+            glActiveTexture(GL_TEXTURE0);
+
+            {
+                BindOperation vao{field_vao_};
+
+                glDrawArrays(GL_TRIANGLE_FAN, 0, 4);
+            }
         }
+
+        field_timer_.end();
     }
 
+    editor_timer_.begin();
+
     // Editor program
     {
         BindOperation prog{edit_prog_};
@@ -271,7 +721,37 @@ DisplayWidget::paintGL()
         {
             BindOperation vao{line_vao_};
 
-            glDrawArrays(GL_LINES, 0, 2 * lines_.size());
+            glDrawElements(GL_LINES,
+                           static_cast<GLsizei>(mesh_.origins().size()),
+                           GL_UNSIGNED_INT,
+                           nullptr);
+
+            if (crossed_edge_) {
+                std::uintptr_t const offset =
+                    2 * *crossed_edge_ * sizeof(Index);
+
+                glUniform4fv(edit_color_location_, 1, G_CROSSING_COLOR.data());
+                glDrawElements(GL_LINES,
+                               2,
+                               GL_UNSIGNED_INT,
+                               reinterpret_cast<void const *>(offset));
+                glUniform4fv(edit_color_location_, 1, G_EDIT_COLOR.data());
+            }
+        }
+
+        if (show_traces_ && !trace_counts_.empty()) {
+            BindOperation vao{trace_vao_};
+
+            glMultiDrawArrays(GL_LINE_STRIP,
+                              trace_firsts_.data(),
+                              trace_counts_.data(),
+                              static_cast<GLsizei>(trace_counts_.size()));
+        }
+
+        if (unsteady_ && wake_count_ > 0) {
+            BindOperation vao{wake_vao_};
+
+            glDrawArrays(GL_POINTS, 0, wake_count_);
         }
 
         std::visit(Overloaded{[](std::monostate const & /*unused*/) {},
@@ -287,14 +767,75 @@ DisplayWidget::paintGL()
                                           sizeof(Vec3), &res, sizeof(Vec3));
                                   }
 
+                                  std::array<GLfloat, 4> const & color =
+                                      crossed_edge_ ? G_CROSSING_COLOR
+                                                    : G_EDIT_COLOR;
+                                  glUniform4fv(
+                                      edit_color_location_, 1, color.data());
+
                                   {
                                       BindOperation vao{guide_vao_};
 
                                       glDrawArrays(GL_LINES, 0, 2);
                                   }
+
+                                  glUniform4fv(edit_color_location_,
+                                               1,
+                                               G_EDIT_COLOR.data());
                               }},
                    prev_point_);
     }
+
+    editor_timer_.end();
+
+    if (show_profile_) {
+        drawProfile();
+    }
+}
+
+void
+DisplayWidget::drawProfile()
+{
+    constexpr int margin = 8;
+
+    // Widget regions, then those of the solver and the GPU passes
+    constexpr std::array<char const *, 9> names{"frame",
+                                                "async solve",
+                                                "assembly",
+                                                "factorization",
+                                                "solve",
+                                                "upload",
+                                                "unsteady step",
+                                                "field pass",
+                                                "editor pass"};
+
+    vortisim::Profiler const & profiler = vortisim::Profiler::instance();
+
+    std::ostringstream text;
+    text << std::fixed << std::setprecision(2);
+    for (char const * name : names) {
+        double const ms = profiler.meanMs(name);
+
+        text << std::left << std::setw(14) << name << std::right;
+        if (ms < 0.0) {
+            text << std::setw(9) << '-' << '\n';
+        } else {
+            text << std::setw(9) << ms << " ms\n";
+        }
+    }
+
+    {
+        QPainter painter{this};
+
+        painter.setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+        painter.setPen(Qt::white);
+        painter.drawText(rect().adjusted(margin, margin, -margin, -margin),
+                         Qt::AlignTop | Qt::AlignLeft,
+                         QString::fromStdString(text.str()));
+    }
+
+    // QPainter leaves its own state behind
+    setGLState();
 }
 
 void
@@ -305,16 +846,43 @@ DisplayWidget::mousePressEvent(QMouseEvent * event)
     // NOLINTNEXTLINE
     switch (event->button()) {
         case Qt::LeftButton: {
-            // @TODO: Lines from pairs of points and drawing with GL_LINE
-            // instead Looping for closed polygon detection (relational
-            // point<->line?) Line intersection checking CGAL for tesselation?
-            // Repeat timer for continuous drawing?
+            // @TODO: CGAL for tesselation? Repeat timer for continuous
+            // drawing?
 
-            addPoint();
+            if (!startDrag()) {
+                addPoint();
+            }
+        } break;
+
+        case Qt::MiddleButton: {
+            pan_origin_ = mouse_pos_;
         } break;
 
         case Qt::RightButton: {
-            prev_point_.emplace<std::monostate>();
+            if (!std::holds_alternative<std::monostate>(prev_point_)) {
+                prev_point_.emplace<std::monostate>();
+                crossed_edge_.reset();
+                break;
+            }
+
+            // Reports the solved panel under the cursor, with the strengths
+            // at both of its ends where they differ
+            Vec3 const unproj =
+                glm::unProject(mouse_pos_, modelview_, proj_, viewport_);
+            std::optional<std::size_t> const panel = getSolvedPanel(unproj);
+            if (!panel) {
+                break;
+            }
+
+            std::vector<GLfloat> const & strengths = strength_buffer_.shadow;
+            std::size_t const first = *panel * strength_buffer_.components;
+            if (first + 1 < strengths.size()) {
+                std::cout << "Panel " << *panel << ": " << strengths[first];
+                if (strengths[first + 1] != strengths[first]) {
+                    std::cout << " to " << strengths[first + 1];
+                }
+                std::cout << '\n';
+            }
         } break;
 
         default: break;
@@ -326,44 +894,293 @@ DisplayWidget::mousePressEvent(QMouseEvent * event)
 void
 DisplayWidget::mouseMoveEvent(QMouseEvent * event)
 {
-    if (!std::holds_alternative<std::monostate>(prev_point_)) {
+    if (pan_origin_) {
+        Vec3 const res{event->x(), height_ - event->y(), 0.0F};
+        Vec3 const from =
+            glm::unProject(*pan_origin_, modelview_, proj_, viewport_);
+        Vec3 const to = glm::unProject(res, modelview_, proj_, viewport_);
+
+        // The world point under the cursor stays there
+        pan_origin_ = res;
+        mouse_pos_ = res;
+        setView(center_ - Vec2{to - from}, zoom_);
+    } else if (drag_vertex_) {
         Vec3 res{event->x(), height_ - event->y(), 0.0F};
 
         if (glm::length(mouse_pos_ - res) > mouse_threshold_) {
             mouse_pos_ = std::move(res);
+            dragNode();
+            update();
+        }
+    } else if (!std::holds_alternative<std::monostate>(prev_point_)) {
+        Vec3 res{event->x(), height_ - event->y(), 0.0F};
+
+        if (glm::length(mouse_pos_ - res) > mouse_threshold_) {
+            mouse_pos_ = std::move(res);
+
+            // Highlights the edge the next line would cross
+            Vec3 const unproj =
+                glm::unProject(mouse_pos_, modelview_, proj_, viewport_);
+            crossed_edge_ = findCrossing(*lineStart(), unproj);
             update();
         }
     }
 }
 
-DisplayWidget::Vec3 const *
+void
+DisplayWidget::mouseReleaseEvent(QMouseEvent * event)
+{
+    if (event->button() == Qt::LeftButton) {
+        drag_vertex_.reset();
+        crossed_edge_.reset();
+    } else if (event->button() == Qt::MiddleButton) {
+        pan_origin_.reset();
+    }
+}
+
+void
+DisplayWidget::wheelEvent(QWheelEvent * event)
+{
+    constexpr float notch = 120.0F;
+    constexpr float step = 1.25F;
+
+    // Zooms about the world point under the cursor
+    Vec3 const cursor{event->x(), height_ - event->y(), 0.0F};
+    Vec3 const anchor = glm::unProject(cursor, modelview_, proj_, viewport_);
+    float const zoom = std::clamp(
+        zoom_ * std::pow(step, static_cast<float>(event->angleDelta().y()) /
+                                   notch),
+        G_MIN_ZOOM,
+        G_MAX_ZOOM);
+
+    Vec2 const a{anchor.x, anchor.y};
+    setView(a - (zoom_ / zoom) * (a - center_), zoom);
+
+    event->accept();
+}
+
+void
+DisplayWidget::keyPressEvent(QKeyEvent * event)
+{
+    // NOLINTNEXTLINE
+    switch (event->key()) {
+        case Qt::Key_Q: {
+            // Toggle between exact and sampled panel influences
+            quadrature_ = (quadrature_ == vortisim::Quadrature::ANALYTIC)
+                              ? vortisim::Quadrature::RIEMANN
+                              : vortisim::Quadrature::ANALYTIC;
+
+            // The shader follows once the new strengths are published
+            if (has_polygon_) {
+                solveFlow();
+            }
+        } break;
+
+        case Qt::Key_L: {
+            // Toggle between constant and linear panel strengths
+            formulation_ = (formulation_ == vortisim::Formulation::CONSTANT)
+                               ? vortisim::Formulation::LINEAR
+                               : vortisim::Formulation::CONSTANT;
+
+            if (has_polygon_) {
+                solveFlow();
+            }
+        } break;
+
+        case Qt::Key_S: {
+            show_traces_ = !show_traces_;
+
+            if (show_traces_ && has_polygon_) {
+                traceStreamlines(solver_->solve({vinf_.x, vinf_.y}));
+            }
+        } break;
+
+        case Qt::Key_P: {
+            if (has_polygon_) {
+                printPolar();
+            }
+        } break;
+
+        case Qt::Key_D: {
+            print_solution_ = !print_solution_;
+        } break;
+
+        case Qt::Key_A: {
+            adaptive_ = !adaptive_;
+
+            if (has_polygon_) {
+                solveFlow();
+            }
+        } break;
+
+        case Qt::Key_T: {
+            show_profile_ = !show_profile_;
+
+            if (show_profile_) {
+                profile_timer_.start();
+            } else {
+                profile_timer_.stop();
+            }
+        } break;
+
+        case Qt::Key_J: {
+            std::string const path = "vortisim-trace.json";
+            if (vortisim::Profiler::instance().writeTrace(path)) {
+                std::cout << "Trace written to " << path << '\n';
+            } else {
+                std::cerr << path << ": cannot write\n";
+            }
+        } break;
+
+        case Qt::Key_U: {
+            if (unsteady_) {
+                stopUnsteady();
+                uploadSolution(solver_->solve({vinf_.x, vinf_.y}));
+            } else if (has_polygon_ && requested_ == published_) {
+                startUnsteady();
+            }
+        } break;
+
+        case Qt::Key_BracketLeft: {
+            setFieldResolution(0.5F * field_scale_);
+        } break;
+
+        case Qt::Key_BracketRight: {
+            setFieldResolution(2.0F * field_scale_);
+        } break;
+
+        case Qt::Key_0: {
+            setView({0.0F, 0.0F}, 1.0F);
+        } break;
+
+        default: QOpenGLWidget::keyPressEvent(event); return;
+    }
+
+    update();
+}
+
+float
+DisplayWidget::pickRadius() const
+{
+    Vec3 const origin =
+        glm::unProject(mouse_pos_, modelview_, proj_, viewport_);
+    Vec3 const dx = glm::unProject(mouse_pos_ + Vec3{threshold_, 0.0F, 0.0F},
+                                   modelview_,
+                                   proj_,
+                                   viewport_);
+    Vec3 const dy = glm::unProject(mouse_pos_ + Vec3{0.0F, threshold_, 0.0F},
+                                   modelview_,
+                                   proj_,
+                                   viewport_);
+
+    return std::max(glm::length(dx - origin), glm::length(dy - origin));
+}
+
+std::optional<DisplayWidget::Index>
 DisplayWidget::getNearbyPoint(Vec3 const & v) const
 {
-    // @TODO: Quadtree
     Vec3 const * prev = std::get_if<Vec3>(&prev_point_);
 
-    if (prev == nullptr && points_.empty()) {
-        return nullptr;
+    std::optional<std::size_t> closest =
+        point_index_.nearest({v.x, v.y}, pickRadius());
+
+    Vec3 const * closest_point = closest ? &points_[*closest] : nullptr;
+    if (prev != nullptr &&
+        (closest_point == nullptr ||
+         glm::length(v - *prev) < glm::length(v - *closest_point))) {
+        closest = points_.size();
+        closest_point = prev;
     }
 
-    // Sort points by proximity to target
-    auto ref_cmp = [v](Vec3CRef a, Vec3CRef b) {
-        return glm::length(v - a.get()) > glm::length(v - b.get());
-    };
-    std::priority_queue<Vec3CRef, std::vector<Vec3CRef>, decltype(ref_cmp)> hits(
-        ref_cmp);
+    if (!closest) {
+        return std::nullopt;
+    }
 
-    for (Vec3 const & p : points_) {
-        hits.push(p);
+    Vec3 const reproj =
+        glm::project(*closest_point, modelview_, proj_, viewport_);
+    if (glm::length(mouse_pos_ - reproj) >= threshold_) {
+        return std::nullopt;
     }
-    if (prev != nullptr) {
-        hits.push(*prev);
+
+    return static_cast<Index>(*closest);
+}
+
+std::optional<std::size_t>
+DisplayWidget::getNearbyLine(Vec3 const & v) const
+{
+    return line_index_.nearest({v.x, v.y}, pickRadius());
+}
+
+std::optional<std::size_t>
+DisplayWidget::getSolvedPanel(Vec3 const & v) const
+{
+    std::vector<GLfloat> const & lines = line_buffer_.shadow;
+    if (lines.empty()) {
+        return std::nullopt;
     }
 
-    Vec3 const & closest = hits.top();
-    Vec3 const   reproj = glm::project(closest, modelview_, proj_, viewport_);
+    std::size_t const n_panels = lines.size() / line_buffer_.components;
+
+    std::optional<std::size_t> nearest;
+    float                      best = pickRadius();
+    for (std::size_t k = 0; k < n_panels; ++k) {
+        GLfloat const * line = &lines[k * line_buffer_.components];
+
+        Vec2 const  a{line[0], line[1]};
+        Vec2 const  ab = Vec2{line[2], line[3]} - a;
+        Vec2 const  ap = Vec2{v.x, v.y} - a;
+        float const l2 = glm::dot(ab, ab);
 
-    return (glm::length(mouse_pos_ - reproj) < threshold_) ? &closest : nullptr;
+        float const t =
+            (l2 > 0.0F) ? std::clamp(glm::dot(ap, ab) / l2, 0.0F, 1.0F) : 0.0F;
+        float const d = glm::length(ap - t * ab);
+        if (d < best) {
+            best = d;
+            nearest = k;
+        }
+    }
+
+    return nearest;
+}
+
+std::optional<DisplayWidget::Vec3>
+DisplayWidget::lineStart() const
+{
+    if (Index const * prev = std::get_if<Index>(&prev_point_)) {
+        return points_[*prev];
+    }
+    if (Vec3 const * prev = std::get_if<Vec3>(&prev_point_)) {
+        return *prev;
+    }
+
+    return std::nullopt;
+}
+
+std::optional<std::size_t>
+DisplayWidget::findCrossing(Vec3 const &               a,
+                            Vec3 const &               b,
+                            std::optional<std::size_t> self) const
+{
+    std::vector<std::size_t> edges;
+    line_index_.query({std::min(a.x, b.x), std::min(a.y, b.y)},
+                      {std::max(a.x, b.x), std::max(a.y, b.y)},
+                      edges);
+
+    vortisim::Segment const line{{a.x, a.y}, {b.x, b.y}};
+    for (std::size_t const edge : edges) {
+        if (edge == self) {
+            continue;
+        }
+
+        auto const   h = static_cast<Index>(2 * edge);
+        Vec3 const & p = points_[mesh_.origin(h)];
+        Vec3 const & q = points_[mesh_.target(h)];
+        if (vortisim::segments_cross(line, {{p.x, p.y}, {q.x, q.y}})) {
+            return edge;
+        }
+    }
+
+    return std::nullopt;
 }
 
 void
@@ -371,20 +1188,30 @@ DisplayWidget::addPoint()
 {
     Vec3 unproj = glm::unProject(mouse_pos_, modelview_, proj_, viewport_);
 
-    auto close_shape = [this](Vec3 const & a, Vec3 const & b) {
-        addLine(a, b);
+    auto close_shape = [this](Index a, Index b) {
+        Index const h = addLine(a, b);
         prev_point_.emplace<std::monostate>();
-        addPolygon(b);
+        addPolygon(h);
+    };
+
+    // Refuses a line across an existing edge and highlights that edge
+    auto crosses = [this](Vec3 const & a, Vec3 const & b) {
+        crossed_edge_ = findCrossing(a, b);
+        if (crossed_edge_) {
+            std::cerr << "Line would cross line " << *crossed_edge_ << '\n';
+        }
+        return crossed_edge_.has_value();
     };
 
     bool const point_added = std::visit(
         Overloaded{// There is no previous point
                    [this, &unproj](std::monostate & /*unused*/) mutable {
-                       Vec3 const * maybe_nearby = getNearbyPoint(unproj);
-                       if (maybe_nearby != nullptr) {
+                       std::optional<Index> const maybe_nearby =
+                           getNearbyPoint(unproj);
+                       if (maybe_nearby) {
                            // Point to add is on already existing line
                            // New line from an old line
-                           prev_point_.emplace<Vec3CRef>(*maybe_nearby);
+                           prev_point_.emplace<Index>(*maybe_nearby);
                            return false;
                        }
 
@@ -394,14 +1221,16 @@ DisplayWidget::addPoint()
                        return true;
                    },
                    // Previous point is part of an already existing line
-                   [this, &unproj, &close_shape](Vec3CRef & prev_ref) mutable {
+                   [this, &unproj, &close_shape, &crosses](
+                       Index & prev) mutable {
                        assert(!points_.empty());
 
-                       Vec3 const & prev = prev_ref.get();
-
-                       Vec3 const * maybe_nearby = getNearbyPoint(unproj);
-                       if (maybe_nearby != nullptr) {
-                           if (maybe_nearby != &prev) {
+                       std::optional<Index> const maybe_nearby =
+                           getNearbyPoint(unproj);
+                       if (maybe_nearby) {
+                           if (*maybe_nearby != prev &&
+                               !crosses(points_[prev],
+                                        points_[*maybe_nearby])) {
                                // Point to add is on already existing line
                                close_shape(prev, *maybe_nearby);
                            }
@@ -409,21 +1238,27 @@ DisplayWidget::addPoint()
                            return false;
                        }
 
+                       if (crosses(points_[prev], unproj)) {
+                           return false;
+                       }
+
                        // Point to add is novel
                        // Old -> New
-                       Vec3 const & b = points_.emplace_back(std::move(unproj));
+                       Index const b = addVertex(unproj);
                        addLine(prev, b);
-                       prev_point_.emplace<Vec3CRef>(b);
+                       prev_point_.emplace<Index>(b);
                        return true;
                    },
                    // Previous point is beginning of new line
-                   [this, &unproj, &close_shape](Vec3 & prev) mutable {
-                       Vec3 const * maybe_nearby = getNearbyPoint(unproj);
-                       if (maybe_nearby != nullptr) {
-                           if (maybe_nearby != &prev) {
+                   [this, &unproj, &close_shape, &crosses](
+                       Vec3 & prev) mutable {
+                       std::optional<Index> const maybe_nearby =
+                           getNearbyPoint(unproj);
+                       if (maybe_nearby) {
+                           if (*maybe_nearby != points_.size() &&
+                               !crosses(prev, points_[*maybe_nearby])) {
                                // Point to add is on already existing line
-                               Vec3 const & a =
-                                   points_.emplace_back(std::move(prev));
+                               Index const a = addVertex(prev);
                                close_shape(a, *maybe_nearby);
                                return true;
                            }
@@ -431,12 +1266,16 @@ DisplayWidget::addPoint()
                            return false;
                        }
 
+                       if (crosses(prev, unproj)) {
+                           return false;
+                       }
+
                        // Point to add is novel
                        // New -> New
-                       Vec3 const & a = points_.emplace_back(std::move(prev));
-                       Vec3 const & b = points_.emplace_back(std::move(unproj));
+                       Index const a = addVertex(prev);
+                       Index const b = addVertex(unproj);
                        addLine(a, b);
-                       prev_point_.emplace<Vec3CRef>(b);
+                       prev_point_.emplace<Index>(b);
                        return true;
                    }},
         prev_point_);
@@ -446,169 +1285,477 @@ DisplayWidget::addPoint()
     }
 }
 
-void
-DisplayWidget::addLine(Vec3 const & a, Vec3 const & b)
+DisplayWidget::Index
+DisplayWidget::addVertex(Vec3 const & p)
 {
-    // @TODO: Add to unordered maps for indexing
+    points_.push_back(p);
 
-    std::size_t const size = lines_.size();
-    lines_.emplace_back(std::piecewise_construct,
-                        std::forward_as_tuple(a),
-                        std::forward_as_tuple(b));
+    return mesh_.addVertex();
+}
+
+DisplayWidget::Index
+DisplayWidget::addLine(Index a, Index b)
+{
+    Index const       h = mesh_.addEdge(a, b);
+    std::size_t const edge = h / 2;
+    line_index_.insert(
+        edge, {points_[a].x, points_[a].y}, {points_[b].x, points_[b].y});
 
+    // The new element pair, or all of them after the array grew
+    std::vector<Index> const & origins = mesh_.origins();
     {
-        BindOperation vbo{line_vbo_};
+        BindOperation vao{line_vao_};
 
-        line_vbo_.write(
-            static_cast<int>(2 * size * sizeof(Vec3)), &a, sizeof(Vec3));
-        line_vbo_.write(
-            static_cast<int>((2 * size + 1) * sizeof(Vec3)), &b, sizeof(Vec3));
+        edge_ibo_.bind();
+        std::size_t begin = 2 * edge;
+        if (growBuffer(
+                edge_ibo_, edge_capacity_, edge + 1, 2 * sizeof(Index))) {
+            begin = 0;
+        }
+        edge_ibo_.write(static_cast<int>(begin * sizeof(Index)),
+                        origins.data() + begin,
+                        static_cast<int>((origins.size() - begin) *
+                                         sizeof(Index)));
     }
+
+    return h;
 }
 
-double
-DisplayWidget::integrate(Vec3 const & p1,
-                         Vec3 const & diff,
-                         Vec2 const & n,
-                         Vec3 const & p)
+void
+DisplayWidget::addPolygon(Index h)
 {
-    constexpr int    integrator_steps = 30;
-    constexpr double slice = 1.0 / static_cast<double>(integrator_steps);
-    auto             delta = diff / static_cast<float>(integrator_steps);
+    // Every closed loop is a separate body with its own Kutta condition
+    if (mesh_.closeLoop(h) == vortisim::HalfEdgeMesh::NONE) {
+        return;
+    }
+
+    solveFlow();
+}
+
+void
+DisplayWidget::solveFlow()
+{
+    stopUnsteady();
+
+    // Node k of a body is the start of half-edge k of its loop, so the
+    // trailing edge is the vertex the loop was closed on
+    std::vector<Index> const & half_edges = mesh_.loopHalfEdges();
 
-    double ans = 0.0;
-    for (int i = 0; i < integrator_steps; ++i) {
-        Vec3 const current_pos = p1 + static_cast<float>(i) * delta;
+    vortisim::Scene scene{};
+    for (std::size_t loop = 0; loop < mesh_.loopCount(); ++loop) {
+        std::size_t const begin = mesh_.loopBegin(loop);
+        std::size_t const end = mesh_.loopEnds()[loop];
 
-        Vec3 const  r = p - current_pos;
-        float const denom = glm::dot(r, r);
+        vortisim::Body & body = scene.bodies.emplace_back();
+        body.nodes.reserve(end - begin);
+        for (std::size_t k = begin; k < end; ++k) {
+            Vec3 const & p1 = points_[mesh_.origin(half_edges[k])];
 
-        Vec2 grad{current_pos.y - p.y, p.x - current_pos.x}; // NOLINT
-        grad /= denom;
+            body.nodes.push_back({p1.x, p1.y});
+        }
+    }
 
-        ans += glm::dot(grad, n);
+    std::optional<vortisim::AdaptOptions> adapt;
+    if (adaptive_) {
+        adapt.emplace();
     }
 
-    return ans * slice;
+    // Supersedes a solve still in flight
+    requested_ = async_solver_.submit(std::move(scene),
+                                      {vinf_.x, vinf_.y},
+                                      quadrature_,
+                                      formulation_,
+                                      std::move(adapt));
 }
 
 void
-DisplayWidget::addPolygon(Vec3 const & p)
+DisplayWidget::publishSolution()
 {
-    assert(lines_.size() > 1);
+    std::optional<vortisim::AsyncSolver::Result> result =
+        async_solver_.take();
+    if (!result) {
+        return;
+    }
 
-    // @TODO:
-    // Keep finished polygons separate in order to facilitate multiple
-    // Kutta conditions
+    makeCurrent();
 
-    // @TODO: Walk polygon to find closed loop
-    (void)p;
+    published_ = result->generation;
+    solver_ = std::move(result->solver);
+    solver_->setPool(&pool_);
 
-    // Assume closed polygon with lines in order
-    std::vector<Vec3> centers;
-    for (Line3 const & l : lines_) {
-        Vec3 const & p1 = l.first;
-        Vec3 const & p2 = l.second;
+    {
+        BindOperation prog{field_prog_};
+
+        glUniform1i(quadrature_location_,
+                    static_cast<GLint>(result->quadrature));
+    }
 
-        constexpr float half = 0.5F;
-        centers.emplace_back(half * (p1 + p2));
+    // Printing dominates the solve of large polygons, so it is opt-in
+    if (print_solution_ && !result->adapt_steps.empty()) {
+        std::cout << "panels cl error\n";
+        for (vortisim::AdaptStep const & step : result->adapt_steps) {
+            std::cout << step.panels << ' ' << step.cl << ' ' << step.error
+                      << '\n';
+        }
     }
 
-    // Anderson p. 387
+    vortisim::Solution const & solution = result->solution;
+    if (print_solution_) {
+        for (double const s : solution.strengths) {
+            std::cout << s << '\n';
+        }
 
-    constexpr Mat3 const ccw_rotation(Vec3(0.0F, -1.0F, 0.0F),
-                                      Vec3(1.0F, 0.0F, 0.0F),
-                                      Vec3(0.0F, 0.0F, 1.0F));
+        vortisim::Vec2 const  vinf{vinf_.x, vinf_.y};
+        vortisim::Loads const loads =
+            vortisim::compute_loads(solver_->scene(), solution, vinf);
+        std::cout << "cl " << loads.cl << " cm " << loads.cm << '\n';
+    }
 
-    std::size_t const n_lines = lines_.size();
-    Eigen::MatrixXd   a = Eigen::MatrixXd::Zero(n_lines, n_lines);
-    Eigen::MatrixXd   b(n_lines, 1);
-    // For all line midpoints
-    for (std::size_t i = 0; i < n_lines - 1; ++i) {
-        Line3 const & l = lines_[i];
+    uploadSolution(solution);
+    has_polygon_ = true;
+
+    doneCurrent();
+    update();
+}
 
-        Vec3 const & p1 = l.first;
-        Vec3 const & p2 = l.second;
+void
+DisplayWidget::uploadSolution(vortisim::Solution const & solution)
+{
+    // CPU side of the texture buffer updates, the copies run later
+    vortisim::ScopedTimer const timer{"upload", "gui"};
+
+    // Panels of the solved scene, which leaves out the lines of an
+    // unfinished polygon or of polygons closed after the snapshot, and which
+    // differ from the drawn edges when repaneled
+    std::size_t n_lines = solution.strengths.size();
+    if (n_lines > static_cast<std::size_t>(max_panels_)) {
+        std::cerr << "Field display limited to " << max_panels_
+                  << " panels\n";
+        n_lines = static_cast<std::size_t>(max_panels_);
+    }
 
-        Vec3 const diff = p2 - p1;
+    std::vector<GLfloat> line_data;
+    line_data.reserve(4 * n_lines);
 
-        Vec3 const n = ccw_rotation * glm::normalize(diff);
-        b(i) = glm::dot(n, Vec3(vinf_, 0.0F));
+    for (vortisim::Body const & body : solver_->scene().bodies) {
+        for (std::size_t i = 0;
+             i < body.panelCount() && line_data.size() < 4 * n_lines;
+             ++i) {
+            vortisim::Vec2 const & p1 = body.panelStart(i);
+            vortisim::Vec2 const & p2 = body.panelEnd(i);
 
-        for (std::size_t j = 0; j < n_lines; ++j) {
-            auto & c = centers[j];
+            line_data.push_back(static_cast<GLfloat>(p1.x));
+            line_data.push_back(static_cast<GLfloat>(p1.y));
 
-            if (i == j) {
-                a(i, j) = 0.0F;
-            } else {
-                // Integrate over every line
-                a(i, j) = integrate(p1, diff, n, c);
-            }
+            line_data.push_back(static_cast<GLfloat>(p2.x));
+            line_data.push_back(static_cast<GLfloat>(p2.y));
         }
     }
-    constexpr double pi = 3.14159265358979;
-    constexpr double tau = 2.0 * pi;
-    a /= tau;
 
-    // Replace last panel strength with Kutta condition
-    a(n_lines - 1, 0) = 1.0;
-    a(n_lines - 1, n_lines - 1) = 1.0;
-    b(n_lines - 1, 0) = 0;
+    // Strengths at both ends of every panel; a constant panel has the same
+    // at both, a linear one takes the end from the next panel of its body
+    std::vector<GLfloat> strength_data;
+    strength_data.reserve(2 * n_lines);
+
+    std::size_t offset = 0;
+    for (vortisim::Body const & body : solver_->scene().bodies) {
+        std::size_t const n_panels = body.panelCount();
+        for (std::size_t i = 0;
+             i < n_panels && strength_data.size() < 2 * n_lines;
+             ++i) {
+            std::size_t const end =
+                (solution.formulation == vortisim::Formulation::LINEAR)
+                    ? offset + (i + 1) % n_panels
+                    : offset + i;
+
+            strength_data.push_back(
+                static_cast<GLfloat>(solution.strengths[offset + i]));
+            strength_data.push_back(
+                static_cast<GLfloat>(solution.strengths[end]));
+        }
+        offset += n_panels;
+    }
 
-    Eigen::MatrixXd x = a.fullPivHouseholderQr().solve(b);
+    uploadPanelBuffer(line_buffer_, line_data);
+    uploadPanelBuffer(strength_buffer_, strength_data);
+    uploadPanelBuffer(cluster_buffer_,
+                      field_clusters(line_data, strength_data));
 
-    auto vorticity = x.col(0);
+    // Streamlines of the steady solution only
+    if (show_traces_ && !unsteady_) {
+        traceStreamlines(solution);
+    }
 
-    std::cout << vorticity << '\n';
+    {
+        BindOperation prog{field_prog_};
 
-    std::vector<GLfloat> line_data;
-    line_data.reserve(2 * n_lines);
+        glUniform1i(n_lines_location_, static_cast<GLint>(n_lines));
+        glUniform1i(formulation_location_,
+                    static_cast<GLint>(solution.formulation));
+    }
+
+    invalidateField();
+}
 
-    for (Line3 const & l : lines_) {
-        Vec3 const & p1 = l.first;
-        Vec3 const & p2 = l.second;
+void
+DisplayWidget::traceStreamlines(vortisim::Solution const & solution)
+{
+    constexpr std::size_t n_seeds = 48;
+    constexpr std::size_t n_samples = 150;
+    constexpr std::size_t grid_size = 256;
+
+    // Fractions of the view height: the seed margin, and the distance a
+    // particle at freestream speed covers per sample
+    constexpr double margin = 0.025;
+    constexpr double step = 0.01;
+
+    // The field is interpolated inside the view and seeds start on its
+    // upstream edge
+    Vec3 const lo = glm::unProject(
+        Vec3{0.0F, 0.0F, 0.0F}, modelview_, proj_, viewport_);
+    Vec3 const hi = glm::unProject(
+        Vec3{width_, height_, 0.0F}, modelview_, proj_, viewport_);
+    double const height = hi.y - lo.y;
+    double const dt = step * height;
+
+    vortisim::FlowField field{solver_->scene(), solution, {vinf_.x, vinf_.y}};
+    field.sample({lo.x, lo.y}, {hi.x, hi.y}, grid_size, grid_size, &pool_);
+
+    std::vector<vortisim::Vec2> seeds(n_seeds);
+    for (std::size_t k = 0; k < n_seeds; ++k) {
+        seeds[k] = {lo.x,
+                    lo.y + margin * height +
+                        ((1.0 - 2.0 * margin) * height) *
+                            static_cast<double>(k) /
+                            static_cast<double>(n_seeds - 1)};
+    }
 
-        line_data.push_back(p1.x);
-        line_data.push_back(p1.y);
+    vortisim::ParticlePaths const paths =
+        vortisim::trace_paths(field, seeds, dt, n_samples, {}, &pool_);
 
-        line_data.push_back(p2.x);
-        line_data.push_back(p2.y);
+    std::vector<Vec3> vertices(paths.x.size());
+    for (std::size_t i = 0; i < vertices.size(); ++i) {
+        vertices[i] = {static_cast<float>(paths.x[i]),
+                       static_cast<float>(paths.y[i]),
+                       0.0F};
     }
 
-    std::vector<GLfloat> strength_data(n_lines);
-    for (std::size_t i = 0; i < n_lines; ++i) {
-        strength_data[i] = vorticity(i);
+    trace_firsts_.resize(n_seeds);
+    trace_counts_.assign(n_seeds, static_cast<GLsizei>(paths.samples));
+    for (std::size_t k = 0; k < n_seeds; ++k) {
+        trace_firsts_[k] = static_cast<GLint>(k * paths.samples);
     }
 
     {
-        BindOperation prog{field_prog_};
+        BindOperation vbo{trace_vbo_};
 
-        glUniform4fv(lines_location_, n_lines, line_data.data());
-        glUniform1fv(strengths_location_, n_lines, strength_data.data());
-        glUniform1i(n_lines_location_, n_lines);
+        trace_vbo_.allocate(vertices.data(),
+                            static_cast<int>(vertices.size() * sizeof(Vec3)));
     }
+}
 
-    has_polygon_ = true;
+void
+DisplayWidget::printPolar() const
+{
+    constexpr int    first_degrees = -10;
+    constexpr int    last_degrees = 15;
+    constexpr double radians = 3.14159265358979 / 180.0;
+
+    std::cout << "alpha cl cm\n";
+    for (int degrees = first_degrees; degrees <= last_degrees; ++degrees) {
+        double const         alpha = radians * degrees;
+        vortisim::Vec2 const vinf{std::cos(alpha), std::sin(alpha)};
+
+        vortisim::Loads const loads = vortisim::compute_loads(
+            solver_->scene(), solver_->solve(vinf), vinf);
+
+        std::cout << degrees << ' ' << loads.cl << ' ' << loads.cm << '\n';
+    }
+}
+
+void
+DisplayWidget::startUnsteady()
+{
+    constexpr int frame_ms = 16;
+
+    vortisim::Motion motion{};
+    motion.freestream = [vinf = vinf_](double /*t*/) {
+        return vortisim::Vec2{vinf.x, vinf.y};
+    };
+
+    vortisim::UnsteadyOptions options{};
+    options.quadrature = quadrature_;
+
+    unsteady_ = std::make_unique<vortisim::UnsteadySolver>(
+        solver_->scene(), std::move(motion), options, &pool_);
+    wake_count_ = 0;
+
+    step_timer_.start(frame_ms);
+}
+
+void
+DisplayWidget::stopUnsteady()
+{
+    if (!unsteady_) {
+        return;
+    }
+
+    step_timer_.stop();
+    unsteady_.reset();
+    wake_count_ = 0;
+}
+
+void
+DisplayWidget::stepUnsteady()
+{
+    assert(unsteady_);
+
+    unsteady_->step();
+
+    // The arrows show the bound vorticity, the wake is drawn as points
+    uploadSolution(unsteady_->solution());
+
+    vortisim::Wake const & wake = unsteady_->wake();
+    std::vector<Vec3>      vertices(wake.size());
+    for (std::size_t i = 0; i < wake.size(); ++i) {
+        vertices[i] = {static_cast<float>(wake.positions[i].x),
+                       static_cast<float>(wake.positions[i].y),
+                       0.0F};
+    }
+    wake_count_ = static_cast<GLsizei>(vertices.size());
+
+    {
+        BindOperation vbo{wake_vbo_};
+
+        wake_vbo_.allocate(vertices.data(),
+                           static_cast<int>(vertices.size() * sizeof(Vec3)));
+    }
+}
+
+bool
+DisplayWidget::startDrag()
+{
+    // Vertices of a finished polygon are grabbed instead of starting a line.
+    // Drags edit solver_, which a solve in flight would replace.
+    if (!has_polygon_ || requested_ != published_ ||
+        !std::holds_alternative<std::monostate>(prev_point_)) {
+        return false;
+    }
+
+    Vec3 const unproj =
+        glm::unProject(mouse_pos_, modelview_, proj_, viewport_);
+    std::optional<Index> const maybe_nearby = getNearbyPoint(unproj);
+    if (!maybe_nearby) {
+        return false;
+    }
+
+    // Only vertices on a loop of the solver scene
+    for (Index h = mesh_.firstOut(*maybe_nearby);
+         h != vortisim::HalfEdgeMesh::NONE;
+         h = mesh_.nextOut(h)) {
+        if (mesh_.panel(h) != vortisim::HalfEdgeMesh::NONE) {
+            if (unsteady_) {
+                stopUnsteady();
+                uploadSolution(solver_->solve({vinf_.x, vinf_.y}));
+            }
+            drag_vertex_ = *maybe_nearby;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void
+DisplayWidget::dragNode()
+{
+    assert(drag_vertex_ && solver_);
+
+    Index const v = *drag_vertex_;
+
+    Vec3 const unproj =
+        glm::unProject(mouse_pos_, modelview_, proj_, viewport_);
+
+    // The edges refer to the vertex by index, moving it moves all of them.
+    // A move that makes one of them cross another edge is refused.
+    Vec3 &     point = points_[v];
+    Vec3 const from = point;
+    point = {unproj.x, unproj.y, point.z};
+
+    for (Index h = mesh_.firstOut(v); h != vortisim::HalfEdgeMesh::NONE;
+         h = mesh_.nextOut(h)) {
+        crossed_edge_ =
+            findCrossing(point, points_[mesh_.target(h)], std::size_t{h / 2});
+        if (crossed_edge_) {
+            point = from;
+            return;
+        }
+    }
+
+    {
+        BindOperation vbo{point_vbo_};
+
+        point_vbo_.write(
+            static_cast<int>(v * sizeof(Vec3)), &point, sizeof(Vec3));
+    }
+
+    point_index_.move(v, {point.x, point.y});
+
+    // Every loop through the vertex has a node there
+    for (Index h = mesh_.firstOut(v); h != vortisim::HalfEdgeMesh::NONE;
+         h = mesh_.nextOut(h)) {
+        Vec3 const & end = points_[mesh_.target(h)];
+        line_index_.move(h / 2, {point.x, point.y}, {end.x, end.y});
+
+        Index const panel = mesh_.panel(h);
+        if (panel != vortisim::HalfEdgeMesh::NONE && !adaptive_) {
+            std::size_t const loop = mesh_.loopOf(panel);
+            solver_->moveNode(
+                loop, panel - mesh_.loopBegin(loop), {point.x, point.y});
+        }
+    }
+
+    if (adaptive_) {
+        solveFlow();
+        return;
+    }
+
+    uploadSolution(solver_->solve({vinf_.x, vinf_.y}));
 }
 
 void
 DisplayWidget::updatePoints()
 {
+    std::size_t const first = point_index_.size();
+    Vec3 const *      prev = std::get_if<Vec3>(&prev_point_);
+
     {
         BindOperation vbo{point_vbo_};
 
-        if (!points_.empty()) {
+        // Everything again after the buffer grew
+        std::size_t begin = first;
+        if (growBuffer(point_vbo_,
+                       point_capacity_,
+                       points_.size() + 1,
+                       sizeof(Vec3))) {
+            begin = 0;
+        }
+
+        if (begin < points_.size()) {
             point_vbo_.write(
-                static_cast<int>((points_.size() - 1) * sizeof(Vec3)),
-                &points_.back(),
-                sizeof(Vec3));
+                static_cast<int>(begin * sizeof(Vec3)),
+                points_.data() + begin,
+                static_cast<int>((points_.size() - begin) * sizeof(Vec3)));
         }
 
-        Vec3 const * prev = std::get_if<Vec3>(&prev_point_);
         if (prev != nullptr) {
             point_vbo_.write(static_cast<int>(points_.size() * sizeof(Vec3)),
                              prev,
                              sizeof(Vec3));
         }
     }
+
+    for (std::size_t i = first; i < points_.size(); ++i) {
+        point_index_.insert(i, {points_[i].x, points_[i].y});
+    }
 }
@@ -1,18 +1,35 @@
 #ifndef DISPLAYWIDGET_H
 #define DISPLAYWIDGET_H
 
+#include "core/assembly.h"
+#include "core/asyncsolver.h"
+#include "core/halfedge.h"
+#include "core/incremental.h"
+#include "core/panel.h"
+#include "core/quadtree.h"
+#include "core/threadpool.h"
+#include "core/unsteady.h"
+#include "gputimer.h"
+
+#include <QKeyEvent>
 #include <QMouseEvent>
 #include <QOpenGLBuffer>
-#include <QOpenGLFunctions>
+#include <QOpenGLExtraFunctions>
+#include <QOpenGLFramebufferObject>
 #include <QOpenGLShaderProgram>
 #include <QOpenGLVertexArrayObject>
 #include <QOpenGLWidget>
+#include <QTimer>
+#include <QWheelEvent>
+#include <cstdint>
 #include <glm/glm.hpp>
 #include <memory>
+#include <optional>
 #include <variant>
 #include <vector>
 
-class DisplayWidget final : public QOpenGLWidget, protected QOpenGLFunctions {
+class DisplayWidget final : public QOpenGLWidget,
+                            protected QOpenGLExtraFunctions {
     Q_OBJECT
 
 public:
@@ -22,13 +39,32 @@ public:
     using Vec2 = glm::vec2;
     using Vec3 = glm::vec3;
     using Vec4 = glm::vec4;
-    using Vec3CRef = std::reference_wrapper<Vec3 const>;
 
-    using Line3 = std::pair<Vec3CRef, Vec3CRef>;
-    using Line3Ref = std::reference_wrapper<Line3 const>;
+    // Vertex or half-edge of mesh_; vertices index points_ as well
+    using Index = vortisim::HalfEdgeMesh::Index;
 
     explicit DisplayWidget(QWidget * parent);
 
+    DisplayWidget(DisplayWidget const &) = delete;
+    DisplayWidget(DisplayWidget &&) noexcept = delete;
+
+    ~DisplayWidget() final;
+
+    DisplayWidget &
+    operator=(DisplayWidget const &) = delete;
+    DisplayWidget &
+    operator=(DisplayWidget &&) noexcept = delete;
+
+    // Resolution of the cached velocity field relative to the widget, from
+    // 1/8 up to 1
+    void
+    setFieldResolution(float scale);
+
+    // World point at the center of the window and magnification of the
+    // unit box
+    void
+    setView(Vec2 const & center, float zoom);
+
 protected:
     void
     initializeGL() final;
@@ -45,74 +81,276 @@ protected:
     void
     mouseMoveEvent(QMouseEvent * event) final;
 
+    void
+    mouseReleaseEvent(QMouseEvent * event) final;
+
+    void
+    keyPressEvent(QKeyEvent * event) final;
+
+    void
+    wheelEvent(QWheelEvent * event) final;
+
     QOpenGLContext * context_{};
 
 private:
+    // Texture buffer with a CPU copy of its contents, so that only texels
+    // that changed are uploaded again
+    struct PanelBuffer {
+        GLuint               buffer{};
+        GLuint               texture{};
+        GLenum               format{};
+        std::size_t          components{};
+        std::size_t          capacity{};
+        std::vector<GLfloat> shadow{};
+    };
+
+    void
+    initPanelBuffer(PanelBuffer & target,
+                    GLenum        format,
+                    std::size_t   components);
+
+    void
+    uploadPanelBuffer(PanelBuffer & target, std::vector<GLfloat> const & data);
+
     void
     initFlowField();
 
+    void
+    freePanelBuffers();
+
+    // Schedules a progressive redraw of the field, starting at the
+    // resolution level that fits the frame budget
+    void
+    invalidateField();
+
+    // Evaluates the velocity of every panel once per texel of the field
+    // cache, at the resolution of field_level_
+    void
+    renderFieldCache(Mat4 const & inverse_mvp);
+
+    // Draws the arrows of the field cache into field_image_
+    void
+    renderFieldImage();
+
     void
     initEditor();
 
     void
     addPoint();
 
+    Index
+    addVertex(Vec3 const & p);
+
+    // Half-edge from a to b
+    Index
+    addLine(Index a, Index b);
+
+    // Closes the loop ending with half-edge h and solves, unless the
+    // drawing has no path back
     void
-    addLine(Vec3 const & a, Vec3 const & b);
+    addPolygon(Index h);
 
+    // Hands a snapshot of the closed polygons to async_solver_
     void
-    addPolygon(Vec3 const & p);
+    solveFlow();
 
-    Vec3 const *
+    // Takes over the latest solve of async_solver_, on the GUI thread
+    void
+    publishSolution();
+
+    void
+    uploadSolution(vortisim::Solution const & solution);
+
+    // Streamlines from the upstream edge of the view as line strips
+    void
+    traceStreamlines(vortisim::Solution const & solution);
+
+    // Lift and moment over a range of angles of attack, printed to stdout.
+    // Every angle reuses the factorization of solver_.
+    void
+    printPolar() const;
+
+    // Impulsive start of the freestream, stepped by step_timer_
+    void
+    startUnsteady();
+
+    void
+    stopUnsteady();
+
+    void
+    stepUnsteady();
+
+    bool
+    startDrag();
+
+    void
+    dragNode();
+
+    // World distance covered by threshold_ pixels in either direction
+    float
+    pickRadius() const;
+
+    // The pending start of a line counts as vertex points_.size(), its slot
+    // in point_vbo_
+    std::optional<Index>
     getNearbyPoint(Vec3 const & v) const;
 
+    // Start of the line being drawn
+    std::optional<Vec3>
+    lineStart() const;
+
+    // Edge that a line from a to b would cross other than edge self, found
+    // among the edges whose boxes overlap its own
+    std::optional<std::size_t>
+    findCrossing(Vec3 const &               a,
+                 Vec3 const &               b,
+                 std::optional<std::size_t> self = std::nullopt) const;
+
+    std::optional<std::size_t>
+    getNearbyLine(Vec3 const & v) const;
+
+    // Panel of the last uploaded solution within the pick radius of v, by
+    // its place in line_buffer_ and strength_buffer_, which follow the
+    // solved scene rather than the drawn edges
+    std::optional<std::size_t>
+    getSolvedPanel(Vec3 const & v) const;
+
+    // Uploads the points added since the last call
     void
     updatePoints();
 
-    static double
-    integrate(Vec3 const & p1,
-              Vec3 const & diff,
-              Vec2 const & n,
-              Vec3 const & p);
+    // State every pass relies on, also restored after QPainter
+    void
+    setGLState();
+
+    // Rolling means of the timed regions in the top left corner
+    void
+    drawProfile();
 
     QOpenGLShaderProgram edit_prog_;
     QOpenGLShaderProgram field_prog_;
+    QOpenGLShaderProgram arrow_prog_;
+    QOpenGLShaderProgram composite_prog_;
 
     QOpenGLBuffer point_vbo_{QOpenGLBuffer::VertexBuffer};
-    QOpenGLBuffer line_vbo_{QOpenGLBuffer::VertexBuffer};
+    QOpenGLBuffer edge_ibo_{QOpenGLBuffer::IndexBuffer};
     QOpenGLBuffer guide_vbo_{QOpenGLBuffer::VertexBuffer};
+    QOpenGLBuffer trace_vbo_{QOpenGLBuffer::VertexBuffer};
+    QOpenGLBuffer wake_vbo_{QOpenGLBuffer::VertexBuffer};
     QOpenGLBuffer field_vbo_{QOpenGLBuffer::VertexBuffer};
 
     QOpenGLVertexArrayObject point_vao_{};
     QOpenGLVertexArrayObject line_vao_{};
     QOpenGLVertexArrayObject guide_vao_{};
+    QOpenGLVertexArrayObject trace_vao_{};
+    QOpenGLVertexArrayObject wake_vao_{};
     QOpenGLVertexArrayObject field_vao_{};
 
-    std::variant<std::monostate, Vec3CRef, Vec3> prev_point_{};
-    std::vector<Vec3>                            points_{};
-    std::vector<Line3>                           lines_{};
-
-    std::unordered_map<Vec3 *, Line3 *> p2l_{};
-    std::unordered_map<Line3 *, Vec3 *> l2p_{};
+    PanelBuffer line_buffer_{};
+    PanelBuffer strength_buffer_{};
+    PanelBuffer cluster_buffer_{};
+    GLint       max_panels_{};
+
+    // Velocity field rendered by field_prog_ and sampled by arrow_prog_,
+    // whose arrows in field_image_ are copied to the screen every frame.
+    // Both are only redrawn when the solution or view changed, so the cost
+    // of a frame does not depend on the panel count.
+    std::unique_ptr<QOpenGLFramebufferObject> field_cache_{};
+    std::unique_ptr<QOpenGLFramebufferObject> field_image_{};
+    float                                     field_scale_{0.5F};
+    bool                                      field_dirty_{true};
+    int                                       field_level_{};
+
+    // Start of the line being drawn: none, a vertex, or a new point that is
+    // only added with the line
+    std::variant<std::monostate, Index, Vec3> prev_point_{};
+
+    // Vertex positions and the edges and closed loops between them. The
+    // lines are drawn from point_vbo_ through edge_ibo_, which holds
+    // mesh_.origins(); both grow by doubling.
+    std::vector<Vec3>      points_{};
+    vortisim::HalfEdgeMesh mesh_{};
+    std::size_t            point_capacity_{};
+    std::size_t            edge_capacity_{};
+
+    // First vertex and vertex count of every streamline in trace_vbo_
+    std::vector<GLint>   trace_firsts_{};
+    std::vector<GLsizei> trace_counts_{};
+    bool                 show_traces_{false};
+
+    // Spatial indices of the vertices and edges of mesh_ by index
+    vortisim::Quadtree point_index_{};
+    vortisim::Quadtree line_index_{};
+
+    // Edge that the line under the cursor or the last rejected edit would
+    // cross, drawn highlighted. Lines and drags that cross another edge are
+    // refused, so every closed loop is a simple polygon.
+    std::optional<std::size_t> crossed_edge_{};
 
     Mat4 proj_;
     Mat4 modelview_{1.0F};
     Vec4 viewport_{};
 
+    // View of modelview_, panned with the middle button from pan_origin_
+    Vec2                center_{0.0F, 0.0F};
+    float               zoom_{1.0F};
+    std::optional<Vec3> pan_origin_{};
+
     Vec3 mouse_pos_{};
 
     Vec2 const vinf_{1.0F, 0.0F};
 
+    vortisim::Quadrature  quadrature_{vortisim::Quadrature::ANALYTIC};
+    vortisim::Formulation formulation_{vortisim::Formulation::CONSTANT};
+    vortisim::ThreadPool  pool_{};
+
+    // Assembly and factorization of new polygons off the GUI thread; the
+    // field keeps showing the previous solution meanwhile. The solver has a
+    // pool of its own, loops on a shared one would wait for each other.
+    vortisim::ThreadPool  solver_pool_{};
+    vortisim::AsyncSolver async_solver_;
+    std::uint64_t         requested_{};
+    std::uint64_t         published_{};
+
+    // Factorized system of the last published solve, follows dragged
+    // vertices
+    std::unique_ptr<vortisim::IncrementalSolver> solver_{};
+    std::optional<Index>                         drag_vertex_{};
+
+    // Strengths and loads of every solve on stdout, toggled by D
+    bool print_solution_{false};
+
+    // Polygons repaneled by adapt_scene before solving, toggled by A. The
+    // panels then no longer follow the drawn edges, so drags solve anew.
+    bool adaptive_{false};
+
+    // Time-stepping run of the polygons and its shed particles in wake_vbo_
+    std::unique_ptr<vortisim::UnsteadySolver> unsteady_{};
+    QTimer                                    step_timer_{};
+    GLsizei                                   wake_count_{};
+
+    // GPU times of the passes, and the overlay of them and the CPU timers,
+    // toggled by T and repainted by profile_timer_
+    GpuTimer field_timer_{"field pass"};
+    GpuTimer editor_timer_{"editor pass"};
+    bool     show_profile_{false};
+    QTimer   profile_timer_{};
+
     float const threshold_{10.0F};
     float const mouse_threshold_{2.0F};
 
     GLint vinf_location_{};
     GLint edit_mvp_location_{};
+    GLint edit_color_location_{};
     GLint field_inverse_mvp_location_{};
-    GLint field_mvp_location_{};
+    GLint arrow_viewport_location_{};
+    GLint field_cache_location_{};
+    GLint composite_viewport_location_{};
     GLint lines_location_{};
     GLint strengths_location_{};
     GLint n_lines_location_{};
+    GLint quadrature_location_{};
+    GLint formulation_location_{};
     GLint viewport_location_{};
 
     int width_{};
@@ -0,0 +1,86 @@
+#ifndef FIELDCLUSTERS_H
+#define FIELDCLUSTERS_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+// Matches CLUSTER_SIZE of field.f.glsl
+constexpr std::size_t FIELD_CLUSTER_SIZE = 16;
+
+// Far-field expansion of runs of FIELD_CLUSTER_SIZE consecutive panels for
+// field.f.glsl, from their endpoints (x1, y1, x2, y2) and the strengths at
+// their two ends. Two RGBA texels per run: center, radius and total
+// circulation, then the dipole moment, the first moment of the vorticity
+// about the center.
+inline std::vector<float>
+field_clusters(std::vector<float> const & lines,
+               std::vector<float> const & strengths)
+{
+    std::size_t const n_lines = strengths.size() / 2;
+    std::size_t const n_clusters =
+        (n_lines + FIELD_CLUSTER_SIZE - 1) / FIELD_CLUSTER_SIZE;
+
+    std::vector<float> texels;
+    texels.reserve(8 * n_clusters);
+
+    for (std::size_t begin = 0; begin < n_lines; begin += FIELD_CLUSTER_SIZE) {
+        std::size_t const end = std::min(n_lines, begin + FIELD_CLUSTER_SIZE);
+
+        // Length-weighted centroid of the midpoints
+        double cx = 0.0;
+        double cy = 0.0;
+        double total_length = 0.0;
+        for (std::size_t i = begin; i < end; ++i) {
+            float const * l = &lines[4 * i];
+            double const  len = std::hypot(l[2] - l[0], l[3] - l[1]);
+
+            cx += 0.5 * len * (l[0] + l[2]);
+            cy += 0.5 * len * (l[1] + l[3]);
+            total_length += len;
+        }
+        if (total_length > 0.0) {
+            cx /= total_length;
+            cy /= total_length;
+        } else {
+            cx = lines[4 * begin];
+            cy = lines[4 * begin + 1];
+        }
+
+        double radius = 0.0;
+        double circulation = 0.0;
+        double dx = 0.0;
+        double dy = 0.0;
+        for (std::size_t i = begin; i < end; ++i) {
+            float const * l = &lines[4 * i];
+            float const * g = &strengths[2 * i];
+            double const  len = std::hypot(l[2] - l[0], l[3] - l[1]);
+            double const  gamma = 0.5 * (g[0] + g[1]) * len;
+
+            // A linear strength shifts the moment towards its stronger end
+            double const slope = (g[1] - g[0]) * len / 12.0;
+
+            radius = std::max({radius,
+                               std::hypot(l[0] - cx, l[1] - cy),
+                               std::hypot(l[2] - cx, l[3] - cy)});
+            circulation += gamma;
+            dx += gamma * (0.5 * (l[0] + l[2]) - cx) + slope * (l[2] - l[0]);
+            dy += gamma * (0.5 * (l[1] + l[3]) - cy) + slope * (l[3] - l[1]);
+        }
+
+        texels.insert(texels.end(),
+                      {static_cast<float>(cx),
+                       static_cast<float>(cy),
+                       static_cast<float>(radius),
+                       static_cast<float>(circulation),
+                       static_cast<float>(dx),
+                       static_cast<float>(dy),
+                       0.0F,
+                       0.0F});
+    }
+
+    return texels;
+}
+
+#endif // FIELDCLUSTERS_H
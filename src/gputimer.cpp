@@ -0,0 +1,77 @@
+#include "gputimer.h"
+
+#include <chrono>
+
+GpuTimer::GpuTimer(char const * name) : name_{name} {}
+
+bool
+GpuTimer::create()
+{
+    for (Slot & slot : slots_) {
+        slot.query = std::make_unique<QOpenGLTimerQuery>();
+        if (!slot.query->create()) {
+            destroy();
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void
+GpuTimer::destroy()
+{
+    for (Slot & slot : slots_) {
+        slot = Slot{};
+    }
+    running_ = nullptr;
+}
+
+void
+GpuTimer::begin()
+{
+    Slot & slot = slots_[next_];
+    if (!slot.query || slot.pending ||
+        !vortisim::Profiler::instance().enabled()) {
+        return;
+    }
+
+    slot.start = vortisim::Profiler::Clock::now();
+    slot.query->begin();
+    running_ = &slot;
+}
+
+void
+GpuTimer::end()
+{
+    if (running_ == nullptr) {
+        return;
+    }
+
+    running_->query->end();
+    running_->pending = true;
+    running_ = nullptr;
+    next_ = (next_ + 1) % slots_.size();
+}
+
+void
+GpuTimer::collect()
+{
+    for (Slot & slot : slots_) {
+        if (!slot.pending || !slot.query->isResultAvailable()) {
+            continue;
+        }
+
+        std::chrono::nanoseconds const elapsed{
+            static_cast<std::chrono::nanoseconds::rep>(
+                slot.query->waitForResult())};
+        vortisim::Profiler::instance().record(
+            {name_,
+             "gpu",
+             slot.start,
+             std::chrono::duration_cast<vortisim::Profiler::Clock::duration>(
+                 elapsed),
+             vortisim::Profiler::GPU_TRACK});
+        slot.pending = false;
+    }
+}
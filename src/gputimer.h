@@ -0,0 +1,62 @@
+#ifndef GPUTIMER_H
+#define GPUTIMER_H
+
+#include "core/profiler.h"
+
+#include <QOpenGLTimerQuery>
+#include <array>
+#include <cstddef>
+#include <memory>
+
+// GL_TIME_ELAPSED queries around one render pass, handed to the profiler on
+// the GPU track. Results are only read once available, a few frames later,
+// so timing never stalls the pipeline.
+class GpuTimer final {
+public:
+    explicit GpuTimer(char const * name);
+
+    GpuTimer() = delete;
+    GpuTimer(GpuTimer const &) = delete;
+    GpuTimer(GpuTimer &&) noexcept = delete;
+
+    ~GpuTimer() = default;
+
+    GpuTimer &
+    operator=(GpuTimer const &) = delete;
+    GpuTimer &
+    operator=(GpuTimer &&) noexcept = delete;
+
+    // False without timer queries (OpenGL 3.3 or ARB_timer_query); needs the
+    // current context
+    bool
+    create();
+
+    void
+    destroy();
+
+    // Skipped while the profiler is disabled or all queries are in flight
+    void
+    begin();
+
+    void
+    end();
+
+    // Records every finished query
+    void
+    collect();
+
+private:
+    struct Slot {
+        std::unique_ptr<QOpenGLTimerQuery> query{};
+        // CPU time of begin(), where the region is placed in the trace
+        vortisim::Profiler::Clock::time_point start{};
+        bool                                  pending{false};
+    };
+
+    char const *        name_;
+    std::array<Slot, 4> slots_{};
+    std::size_t         next_{};
+    Slot *              running_{};
+};
+
+#endif // GPUTIMER_H
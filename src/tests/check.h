@@ -0,0 +1,54 @@
+#ifndef TESTS_CHECK_H
+#define TESTS_CHECK_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+namespace vortisim {
+
+// Failed conditions of a test executable, reported on stderr and to ctest
+// through the exit code
+class Check {
+public:
+    void
+    expect(bool condition, std::string const & what)
+    {
+        if (!condition) {
+            std::cerr << "FAILED: " << what << '\n';
+            ++failures_;
+        }
+    }
+
+    // |value - expected| <= tolerance * max(1, |expected|)
+    void
+    expectNear(double              value,
+               double              expected,
+               double              tolerance,
+               std::string const & what)
+    {
+        double const scale = std::max(1.0, std::abs(expected));
+        bool const   near = std::abs(value - expected) <= tolerance * scale;
+        if (!near) {
+            std::cerr << std::setprecision(17) << "FAILED: " << what << ": "
+                      << value << ", expected " << expected << '\n';
+            ++failures_;
+        }
+    }
+
+    int
+    exitCode() const
+    {
+        return failures_ == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+private:
+    int failures_{};
+};
+
+} // namespace vortisim
+
+#endif // TESTS_CHECK_H
@@ -0,0 +1,92 @@
+#include "core/airfoil.h"
+#include "core/loads.h"
+#include "core/scene.h"
+#include "core/solver.h"
+#include "tests/check.h"
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+
+namespace {
+
+constexpr double G_PI = 3.14159265358979;
+
+// Agreement of GMRES with the dense solve documented at solve_iterative:
+// loads to 1e-8, strengths to 1e-5 of their largest magnitude, where the
+// near-null mode sets the limit
+constexpr double G_LOAD_TOLERANCE = 1e-8;
+constexpr double G_STRENGTH_TOLERANCE = 1e-5;
+
+struct Case {
+    double      camber;
+    std::size_t panels;
+    double      alpha_deg;
+};
+
+constexpr Case G_CASES[] = {
+    {0.0, 400, 4.0},
+    {0.02, 400, 4.0},
+    {0.0, 800, 8.0},
+    {0.02, 800, 8.0},
+};
+
+} // namespace
+
+int
+main()
+{
+    vortisim::Check check{};
+
+    for (Case const & c : G_CASES) {
+        double const         alpha = c.alpha_deg * G_PI / 180.0;
+        vortisim::Vec2 const vinf{std::cos(alpha), std::sin(alpha)};
+
+        vortisim::Scene const scene{
+            {vortisim::naca4(c.camber, 0.4, 0.12, c.panels)}};
+
+        vortisim::SolverOptions dense{};
+        dense.mode = vortisim::SolverMode::DENSE;
+
+        vortisim::SolverOptions iterative{};
+        iterative.mode = vortisim::SolverMode::ITERATIVE;
+        iterative.iterative.gmres.tolerance = 1e-10;
+
+        vortisim::Solution const reference =
+            vortisim::solve(scene, vinf, dense);
+        vortisim::Solution const solution =
+            vortisim::solve(scene, vinf, iterative);
+
+        std::string const label = "camber " + std::to_string(c.camber) +
+                                  ", " + std::to_string(c.panels) + " panels";
+
+        check.expect(solution.mode == vortisim::SolverMode::ITERATIVE &&
+                         solution.residual <= 1e-10,
+                     label + ": GMRES converged");
+
+        vortisim::Loads const expected =
+            vortisim::compute_loads(scene, reference, vinf);
+        vortisim::Loads const loads =
+            vortisim::compute_loads(scene, solution, vinf);
+
+        check.expectNear(
+            loads.cl, expected.cl, G_LOAD_TOLERANCE, label + " cl");
+        check.expectNear(
+            loads.cm, expected.cm, G_LOAD_TOLERANCE, label + " cm");
+
+        double largest = 0.0;
+        double error = 0.0;
+        for (std::size_t i = 0; i < c.panels; ++i) {
+            largest = std::max(largest, std::abs(reference.strengths[i]));
+            error = std::max(
+                error,
+                std::abs(solution.strengths[i] - reference.strengths[i]));
+        }
+        check.expectNear(error / largest,
+                         0.0,
+                         G_STRENGTH_TOLERANCE,
+                         label + " strength error");
+    }
+
+    return check.exitCode();
+}
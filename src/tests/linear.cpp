@@ -0,0 +1,61 @@
+#include "core/airfoil.h"
+#include "core/loads.h"
+#include "core/scene.h"
+#include "core/solver.h"
+#include "tests/check.h"
+
+#include <cmath>
+#include <string>
+
+namespace {
+
+constexpr double G_PI = 3.14159265358979;
+
+// Linear panels on the default naca4 outline, node 0 at the trailing edge
+// and no repaneling. Mixed precision agrees with the dense solve to about
+// 1e-12 and keeps the finest level fast.
+double
+linear_cl(double camber, std::size_t panels, double alpha_deg)
+{
+    double const         alpha = alpha_deg * G_PI / 180.0;
+    vortisim::Vec2 const vinf{std::cos(alpha), std::sin(alpha)};
+
+    vortisim::Scene const scene{{vortisim::naca4(camber, 0.4, 0.12, panels)}};
+
+    vortisim::SolverOptions options{};
+    options.mode = vortisim::SolverMode::MIXED;
+    options.formulation = vortisim::Formulation::LINEAR;
+
+    vortisim::Solution const solution = vortisim::solve(scene, vinf, options);
+
+    return vortisim::compute_loads(scene, solution, vinf).cl;
+}
+
+} // namespace
+
+int
+main()
+{
+    vortisim::Check check{};
+
+    // A symmetric section carries no lift at zero incidence
+    for (std::size_t const panels : {40, 160, 640}) {
+        check.expectNear(linear_cl(0.0, panels, 0.0),
+                         0.0,
+                         1e-5,
+                         "NACA 0012, " + std::to_string(panels) + " panels");
+    }
+
+    // Observed order of NACA 2412 at 5 degrees on panel counts quadrupling,
+    // from the ratio of successive differences
+    double const coarse = linear_cl(0.02, 80, 5.0);
+    double const medium = linear_cl(0.02, 320, 5.0);
+    double const fine = linear_cl(0.02, 1280, 5.0);
+
+    double const order =
+        std::log(std::abs((medium - coarse) / (fine - medium))) / std::log(4.0);
+    check.expectNear(order, 2.0, 0.3, "NACA 2412 convergence order");
+    check.expectNear(fine, 0.86162, 1e-4, "NACA 2412 cl");
+
+    return check.exitCode();
+}
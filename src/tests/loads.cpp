@@ -0,0 +1,76 @@
+#include "core/airfoil.h"
+#include "core/assembly.h"
+#include "core/loads.h"
+#include "core/scene.h"
+#include "core/solver.h"
+#include "tests/check.h"
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+
+namespace {
+
+constexpr double G_PI = 3.14159265358979;
+
+// Moment of NACA 2412 about its quarter chord, converged on linear panels
+constexpr double G_CM = -0.05548;
+
+struct Result {
+    double cl;
+    double pressure_cl;
+    double cm;
+    double max_speed;
+};
+
+// Constant panels on NACA 2412 at zero incidence, whose unit freestream
+// makes the pressure lift the normal force along y
+Result
+solve_naca2412(std::size_t panels)
+{
+    vortisim::Vec2 const  vinf{1.0, 0.0};
+    vortisim::Scene const scene{{vortisim::naca4(0.02, 0.4, 0.12, panels)}};
+
+    vortisim::SolverOptions options{};
+    options.mode = vortisim::SolverMode::MIXED;
+
+    vortisim::Solution const solution = vortisim::solve(scene, vinf, options);
+    vortisim::Surface const  surface =
+        vortisim::compute_surface(scene, solution, vinf);
+    vortisim::Loads const loads =
+        vortisim::compute_loads(scene, solution, surface, vinf);
+
+    vortisim::PanelArrays const arrays = vortisim::make_panel_arrays(scene);
+
+    Result result{loads.cl, 0.0, loads.cm, 0.0};
+    for (std::size_t i = 0; i < arrays.size(); ++i) {
+        result.pressure_cl -= surface.cp[i] * arrays.len[i] * arrays.ny[i];
+        result.max_speed =
+            std::max(result.max_speed, std::abs(surface.velocity[i]));
+    }
+
+    return result;
+}
+
+} // namespace
+
+int
+main()
+{
+    vortisim::Check check{};
+
+    for (std::size_t const panels : {320, 640, 1280}) {
+        Result const      result = solve_naca2412(panels);
+        std::string const label = std::to_string(panels) + " panels";
+
+        // No trailing edge spikes, the suction peak is below 1.3
+        check.expect(result.max_speed < 1.5, label + " surface speed");
+        check.expectNear(result.pressure_cl,
+                         result.cl,
+                         0.015 * result.cl,
+                         label + " pressure lift");
+        check.expectNear(result.cm, G_CM, 5e-4, label + " cm");
+    }
+
+    return check.exitCode();
+}
@@ -0,0 +1,181 @@
+#include "core/quadtree.h"
+#include "core/vec2.h"
+#include "tests/check.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <optional>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+// Items of the tree as the brute force sees them, absent ones removed
+struct Reference {
+    std::vector<vortisim::Vec2> a{};
+    std::vector<vortisim::Vec2> b{};
+    std::vector<bool>           present{};
+};
+
+double
+segment_distance(vortisim::Vec2 const & p,
+                 vortisim::Vec2 const & a,
+                 vortisim::Vec2 const & b)
+{
+    vortisim::Vec2 const ab = b - a;
+    vortisim::Vec2 const ap = p - a;
+    double const         l2 = vortisim::dot(ab, ab);
+
+    double const t =
+        (l2 > 0.0) ? std::clamp(vortisim::dot(ap, ab) / l2, 0.0, 1.0) : 0.0;
+    vortisim::Vec2 const d = ap - t * ab;
+
+    return std::sqrt(vortisim::dot(d, d));
+}
+
+// Queries of random boxes and points against a scan of all items
+void
+compare(vortisim::Quadtree const & tree,
+        Reference const &          reference,
+        std::mt19937 &             random,
+        std::string const &        phase,
+        vortisim::Check &          check)
+{
+    std::uniform_real_distribution<double> coordinate{-4.0, 4.0};
+    std::uniform_real_distribution<double> extent{0.0, 1.5};
+
+    std::size_t const n = reference.present.size();
+    auto const        n_present = static_cast<std::size_t>(std::count(
+        reference.present.begin(), reference.present.end(), true));
+
+    check.expect(tree.size() == n_present, phase + ": size");
+    for (std::size_t id = 0; id < n; ++id) {
+        check.expect(tree.contains(id) == reference.present[id],
+                     phase + ": contains " + std::to_string(id));
+    }
+
+    for (int q = 0; q < 200; ++q) {
+        vortisim::Vec2 const lo{coordinate(random), coordinate(random)};
+        vortisim::Vec2 const hi{lo.x + extent(random), lo.y + extent(random)};
+
+        std::vector<std::size_t> found;
+        tree.query(lo, hi, found);
+        std::sort(found.begin(), found.end());
+
+        std::vector<std::size_t> expected;
+        for (std::size_t id = 0; id < n; ++id) {
+            vortisim::Vec2 const & a = reference.a[id];
+            vortisim::Vec2 const & b = reference.b[id];
+            if (reference.present[id] && std::min(a.x, b.x) <= hi.x &&
+                std::min(a.y, b.y) <= hi.y && std::max(a.x, b.x) >= lo.x &&
+                std::max(a.y, b.y) >= lo.y) {
+                expected.push_back(id);
+            }
+        }
+        check.expect(found == expected, phase + ": query");
+
+        vortisim::Vec2 const p{coordinate(random), coordinate(random)};
+        double best = std::numeric_limits<double>::infinity();
+        for (std::size_t id = 0; id < n; ++id) {
+            if (reference.present[id]) {
+                double const d =
+                    segment_distance(p, reference.a[id], reference.b[id]);
+                best = std::min(best, d);
+            }
+        }
+
+        std::optional<std::size_t> const nearest = tree.nearest(p);
+        check.expect(nearest.has_value() == std::isfinite(best),
+                     phase + ": nearest found");
+        if (nearest) {
+            double const d = segment_distance(
+                p, reference.a[*nearest], reference.b[*nearest]);
+            check.expect(reference.present[*nearest] &&
+                             std::abs(d - best) <= 1e-12,
+                         phase + ": nearest distance");
+        }
+
+        // Nothing is closer than the nearest item
+        check.expect(!tree.nearest(p, 0.5 * best).has_value(),
+                     phase + ": nearest beyond max_distance");
+    }
+}
+
+} // namespace
+
+int
+main()
+{
+    vortisim::Check check{};
+
+    // Items spill out of the initial box, the root has to grow
+    std::mt19937                           random{2024};
+    std::uniform_real_distribution<double> coordinate{-3.0, 3.0};
+    std::uniform_real_distribution<double> offset{-0.2, 0.2};
+    std::uniform_real_distribution<double> unit{0.0, 1.0};
+
+    constexpr std::size_t N_ITEMS = 600;
+
+    vortisim::Quadtree tree{{-1.0, -1.0}, {1.0, 1.0}, 4};
+    Reference          reference{};
+    reference.a.resize(N_ITEMS);
+    reference.b.resize(N_ITEMS);
+    reference.present.assign(N_ITEMS, false);
+
+    // Points and short segments
+    auto random_item = [&](std::size_t id) {
+        vortisim::Vec2 const a{coordinate(random), coordinate(random)};
+        vortisim::Vec2 const b =
+            (id % 3 == 0) ? a : vortisim::Vec2{a.x + offset(random),
+                                               a.y + offset(random)};
+        reference.a[id] = a;
+        reference.b[id] = b;
+    };
+
+    for (std::size_t id = 0; id < N_ITEMS; ++id) {
+        random_item(id);
+        tree.insert(id, reference.a[id], reference.b[id]);
+        reference.present[id] = true;
+    }
+    compare(tree, reference, random, "insert", check);
+
+    // Small moves mostly stay in their node, large ones cross the tree
+    for (std::size_t id = 0; id < N_ITEMS; ++id) {
+        if (unit(random) < 0.5) {
+            vortisim::Vec2 const d{0.01 * offset(random),
+                                   0.01 * offset(random)};
+            reference.a[id] = reference.a[id] + d;
+            reference.b[id] = reference.b[id] + d;
+        } else {
+            random_item(id);
+        }
+        tree.move(id, reference.a[id], reference.b[id]);
+    }
+    compare(tree, reference, random, "move", check);
+
+    // Removing most items merges children back
+    for (std::size_t id = 0; id < N_ITEMS; ++id) {
+        if (unit(random) < 0.8) {
+            tree.remove(id);
+            reference.present[id] = false;
+        }
+    }
+    compare(tree, reference, random, "remove", check);
+
+    for (std::size_t id = 0; id < N_ITEMS; id += 2) {
+        if (!reference.present[id]) {
+            random_item(id);
+            tree.insert(id, reference.a[id], reference.b[id]);
+            reference.present[id] = true;
+        }
+    }
+    compare(tree, reference, random, "reinsert", check);
+
+    tree.clear();
+    reference.present.assign(N_ITEMS, false);
+    compare(tree, reference, random, "clear", check);
+
+    return check.exitCode();
+}
@@ -0,0 +1,171 @@
+#include "core/airfoil.h"
+#include "core/body.h"
+#include "core/loads.h"
+#include "core/scene.h"
+#include "core/solver.h"
+#include "tests/check.h"
+
+#include <cmath>
+#include <numeric>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr double G_PI = 3.14159265358979;
+
+// Results of single-body solves from before scenes and the Kutta row
+// setting, NACA 2412 at 4 degrees. The moments are those of compute_surface
+// with the trailing edge panels evaluated off the surface.
+struct Reference {
+    std::size_t          panels;
+    vortisim::SolverMode mode;
+    double               cl;
+    double               cm;
+    // Strengths of the first, middle and last panel and their sum
+    double first;
+    double middle;
+    double last;
+    double sum;
+};
+
+constexpr Reference G_REFERENCES[] = {
+    {100,
+     vortisim::SolverMode::DENSE,
+     0.74408129456689731,
+     -0.059605200963844321,
+     -0.52323868530929374,
+     4.4788467294206047,
+     0.52323868530929374,
+     -19.953423812114902},
+    {400,
+     vortisim::SolverMode::ITERATIVE,
+     0.74218566401358299,
+     -0.061032667049028648,
+     1.8745734903520768,
+     16.373569748260728,
+     -1.8745734903524334,
+     -79.229638480649172},
+};
+
+vortisim::Vec2
+freestream(double alpha_deg)
+{
+    double const alpha = alpha_deg * G_PI / 180.0;
+    return {std::cos(alpha), std::sin(alpha)};
+}
+
+void
+check_references(vortisim::Check & check)
+{
+    vortisim::Vec2 const vinf = freestream(4.0);
+
+    for (Reference const & reference : G_REFERENCES) {
+        vortisim::Scene const scene{
+            {vortisim::naca4(0.02, 0.4, 0.12, reference.panels)}};
+
+        vortisim::SolverOptions options{};
+        options.mode = reference.mode;
+        // Multipole terms the references were recorded with
+        options.iterative.tree.order = 20;
+
+        vortisim::Solution const solution =
+            vortisim::solve(scene, vinf, options);
+        vortisim::Loads const loads =
+            vortisim::compute_loads(scene, solution, vinf);
+
+        std::vector<double> const & strengths = solution.strengths;
+        std::string const label = std::to_string(reference.panels) + " panels";
+
+        check.expect(strengths.size() == reference.panels, label + " count");
+        if (strengths.size() != reference.panels) {
+            continue;
+        }
+
+        // GMRES stops at its tolerance, the strengths agree less closely
+        double const tolerance =
+            reference.mode == vortisim::SolverMode::DENSE ? 1e-10 : 1e-8;
+
+        check.expectNear(loads.cl, reference.cl, tolerance, label + " cl");
+        check.expectNear(loads.cm, reference.cm, tolerance, label + " cm");
+        check.expectNear(
+            strengths.front(), reference.first, tolerance, label + " first");
+        check.expectNear(strengths[strengths.size() / 2],
+                         reference.middle,
+                         tolerance,
+                         label + " middle");
+        check.expectNear(
+            strengths.back(), reference.last, tolerance, label + " last");
+        check.expectNear(
+            std::accumulate(strengths.begin(), strengths.end(), 0.0),
+            reference.sum,
+            tolerance * static_cast<double>(reference.panels),
+            label + " sum");
+    }
+}
+
+// A body solved on its own and as the only body of a scene share every bit
+void
+check_body_matches_scene(vortisim::Check & check)
+{
+    vortisim::Body const body = vortisim::naca4(0.0, 0.0, 0.12, 80);
+    vortisim::Vec2 const vinf = freestream(6.0);
+
+    check.expect(body.kutta_row == vortisim::KuttaRow::LAST,
+                 "default Kutta row");
+
+    for (vortisim::Formulation const formulation :
+         {vortisim::Formulation::CONSTANT, vortisim::Formulation::LINEAR}) {
+        for (vortisim::SolverMode const mode :
+             {vortisim::SolverMode::DENSE, vortisim::SolverMode::MIXED}) {
+            vortisim::SolverOptions options{};
+            options.formulation = formulation;
+            options.mode = mode;
+
+            vortisim::Solution const alone =
+                vortisim::solve(body, vinf, options);
+            vortisim::Solution const in_scene =
+                vortisim::solve(vortisim::Scene{{body}}, vinf, options);
+
+            check.expect(alone.strengths == in_scene.strengths,
+                         "body and scene strengths");
+        }
+    }
+}
+
+// A zero freestream leaves the body at rest, with a zero residual rather
+// than one relative to a zero right-hand side
+void
+check_zero_freestream(vortisim::Check & check)
+{
+    vortisim::Scene const scene{{vortisim::naca4(0.02, 0.4, 0.12, 60)}};
+
+    for (vortisim::SolverMode const mode :
+         {vortisim::SolverMode::DENSE, vortisim::SolverMode::MIXED}) {
+        vortisim::SolverOptions options{};
+        options.mode = mode;
+
+        vortisim::Solution const solution =
+            vortisim::solve(scene, {0.0, 0.0}, options);
+        std::vector<vortisim::Solution> const sweep =
+            vortisim::solve_sweep(scene, {{0.0, 0.0}}, options);
+
+        check.expect(solution.residual == 0.0, "zero freestream residual");
+        check.expect(sweep.front().residual == 0.0,
+                     "zero freestream sweep residual");
+    }
+}
+
+} // namespace
+
+int
+main()
+{
+    vortisim::Check check{};
+
+    check_references(check);
+    check_body_matches_scene(check);
+    check_zero_freestream(check);
+
+    return check.exitCode();
+}
@@ -0,0 +1,168 @@
+#include "core/airfoil.h"
+#include "core/body.h"
+#include "core/scene.h"
+#include "core/validate.h"
+#include "core/vec2.h"
+#include "tests/check.h"
+
+#include <cstddef>
+#include <optional>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+
+struct CrossCase {
+    char const *      name;
+    vortisim::Segment s;
+    vortisim::Segment t;
+    bool              cross;
+};
+
+CrossCase const G_CROSS_CASES[] = {
+    {"proper crossing", {{0, 0}, {2, 2}}, {{0, 2}, {2, 0}}, true},
+    {"disjoint", {{0, 0}, {1, 0}}, {{0, 1}, {1, 1}}, false},
+    {"consecutive panels", {{0, 0}, {1, 0}}, {{1, 0}, {2, 1}}, false},
+    {"shared endpoint, opposite", {{0, 0}, {1, 0}}, {{1, 0}, {2, 0}}, false},
+    {"shared endpoint, folded back", {{0, 0}, {2, 0}}, {{2, 0}, {1, 0}}, true},
+    {"endpoint on interior", {{0, 0}, {2, 0}}, {{1, 0}, {1, 1}}, true},
+    {"collinear overlap", {{0, 0}, {2, 0}}, {{1, 0}, {3, 0}}, true},
+    {"collinear apart", {{0, 0}, {1, 0}}, {{2, 0}, {3, 0}}, false},
+    {"same segment reversed", {{0, 0}, {1, 1}}, {{1, 1}, {0, 0}}, true},
+    {"vertical crossing", {{1, -1}, {1, 1}}, {{0, 0}, {2, 0}}, true},
+};
+
+void
+check_segments_cross(vortisim::Check & check)
+{
+    for (CrossCase const & c : G_CROSS_CASES) {
+        check.expect(vortisim::segments_cross(c.s, c.t) == c.cross,
+                     std::string{c.name});
+        check.expect(vortisim::segments_cross(c.t, c.s) == c.cross,
+                     std::string{c.name} + ", swapped");
+    }
+}
+
+std::optional<std::pair<std::size_t, std::size_t>>
+brute_force_crossing(std::vector<vortisim::Segment> const & segments)
+{
+    for (std::size_t i = 0; i < segments.size(); ++i) {
+        for (std::size_t j = i + 1; j < segments.size(); ++j) {
+            vortisim::Segment const & s = segments[i];
+            vortisim::Segment const & t = segments[j];
+            if (!(s.a == s.b) && !(t.a == t.b) &&
+                vortisim::segments_cross(s, t)) {
+                return std::pair{i, j};
+            }
+        }
+    }
+
+    return std::nullopt;
+}
+
+// Segments on a small integer grid, rich in shared endpoints, collinear and
+// vertical segments and ties of the sweep
+void
+check_find_crossing(vortisim::Check & check)
+{
+    std::mt19937                       random{7};
+    std::uniform_int_distribution<int> coordinate{0, 6};
+    std::uniform_int_distribution<int> count{1, 12};
+
+    auto random_segment = [&]() {
+        return vortisim::Segment{
+            {static_cast<double>(coordinate(random)),
+             static_cast<double>(coordinate(random))},
+            {static_cast<double>(coordinate(random)),
+             static_cast<double>(coordinate(random))}};
+    };
+
+    for (int trial = 0; trial < 2000; ++trial) {
+        std::vector<vortisim::Segment> segments;
+
+        // Every other trial only keeps segments that cross nothing yet
+        bool const clean = trial % 2 == 0;
+        for (int k = count(random); k > 0; --k) {
+            segments.push_back(random_segment());
+            if (clean && brute_force_crossing(segments)) {
+                segments.pop_back();
+            }
+        }
+
+        auto const expected = brute_force_crossing(segments);
+        auto const found = vortisim::find_crossing(segments);
+
+        std::string const label = "trial " + std::to_string(trial);
+        check.expect(found.has_value() == expected.has_value(),
+                     label + ": crossing found");
+        if (found) {
+            check.expect(found->first < found->second &&
+                             found->second < segments.size() &&
+                             vortisim::segments_cross(segments[found->first],
+                                                      segments[found->second]),
+                         label + ": reported pair crosses");
+        }
+    }
+}
+
+void
+check_validate_scene(vortisim::Check & check)
+{
+    using vortisim::GeometryIssue;
+
+    vortisim::Body const airfoil = vortisim::naca4(0.02, 0.4, 0.12, 120);
+    check.expect(!vortisim::validate_scene(vortisim::Scene{{airfoil}}),
+                 "airfoil accepted");
+
+    // Two elements touching at a node are fine
+    vortisim::Body const square{{{0, 0}, {1, 0}, {1, 1}, {0, 1}}};
+    vortisim::Body const neighbour{{{1, 1}, {2, 1}, {2, 2}, {1, 2}}};
+    vortisim::Scene const touching{{square, neighbour}};
+    check.expect(!vortisim::validate_scene(touching),
+                 "bodies touching at a node accepted");
+
+    vortisim::Body const line{{{0, 0}, {1, 0}}};
+    auto error = vortisim::validate_scene(vortisim::Scene{{square, line}});
+    check.expect(error && error->issue == GeometryIssue::TOO_FEW_NODES &&
+                     error->body == 1,
+                 "two nodes rejected");
+
+    vortisim::Body const repeated{{{0, 0}, {1, 0}, {1, 0}, {0, 1}}};
+    error = vortisim::validate_scene(vortisim::Scene{{repeated}});
+    check.expect(error && error->issue == GeometryIssue::DEGENERATE_PANEL &&
+                     error->body == 0 && error->panel == 1,
+                 "repeated node rejected");
+
+    vortisim::Body const bow_tie{{{0, 0}, {1, 1}, {1, 0}, {0, 1}}};
+    error = vortisim::validate_scene(vortisim::Scene{{bow_tie}});
+    check.expect(error && error->issue == GeometryIssue::CROSSING &&
+                     error->body == 0 && error->other_body == 0,
+                 "self-crossing body rejected");
+
+    vortisim::Body overlapping = square;
+    for (vortisim::Vec2 & node : overlapping.nodes) {
+        node.x += 0.5;
+        node.y += 0.5;
+    }
+    vortisim::Scene const overlap{{airfoil, square, overlapping}};
+    error = vortisim::validate_scene(overlap);
+    check.expect(error && error->issue == GeometryIssue::CROSSING &&
+                     error->body == 1 && error->other_body == 2,
+                 "overlapping bodies rejected");
+}
+
+} // namespace
+
+int
+main()
+{
+    vortisim::Check check{};
+
+    check_segments_cross(check);
+    check_find_crossing(check);
+    check_validate_scene(check);
+
+    return check.exitCode();
+}